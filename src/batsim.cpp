@@ -35,6 +35,7 @@
 #include "external_event_submitter.hpp"
 #include "external_events.hpp"
 #include "export.hpp"
+#include "internal_tracing.hpp"
 #include "ipp.hpp"
 #include "job_submitter.hpp"
 #include "jobs.hpp"
@@ -43,6 +44,7 @@
 #include "profiles.hpp"
 #include "protocol.hpp"
 #include "server.hpp"
+#include "swf.hpp"
 #include "task_execution.hpp"
 #include "workload.hpp"
 
@@ -73,10 +75,12 @@ void configure_batsim_logging_output(const MainArguments & main_args)
 {
     vector<string> log_categories_to_set = {
         "batsim",
+        "dax",
         "edc",
         "external_events",
         "external_event_submitter",
         "export",
+        "internal_tracing",
         "ipp",
         "jobs",
         "jobs_execution",
@@ -85,9 +89,12 @@ void configure_batsim_logging_output(const MainArguments & main_args)
         "profiles",
         "protocol",
         "pstate",
+        "ptask_matrix_cache",
         "server",
+        "swf",
         "task_execution",
-        "workload"
+        "workload",
+        "workload_generator"
     };
     string log_threshold_to_set = "critical";
 
@@ -132,7 +139,31 @@ void load_workloads(const MainArguments & main_args, BatsimContext * context, in
         Workload * workload = Workload::new_static_workload(desc.name, desc.filename);
 
         int nb_machines_in_workload = -1;
-        workload->load_from_json(desc.filename, nb_machines_in_workload);
+        switch (desc.source)
+        {
+        case WorkloadSource::JSON:
+            workload->load_from_json(desc.filename, nb_machines_in_workload, main_args.time_window);
+            break;
+        case WorkloadSource::SWF:
+            // SWF jobs are streamed by their submitter, only the header is read now
+            workload->jobs->set_forget_deleted_jobs(true);
+            nb_machines_in_workload = desc.swf_options.nb_res;
+            if (nb_machines_in_workload == -1)
+            {
+                SwfReader reader(desc.filename);
+                nb_machines_in_workload = reader.max_nb_procs();
+            }
+            break;
+        case WorkloadSource::GENERATOR:
+            // Generated jobs are created by their submitter, which uses all compute machines if nb_res is not set
+            workload->jobs->set_forget_deleted_jobs(true);
+            nb_machines_in_workload = desc.swf_options.nb_res;
+            break;
+        case WorkloadSource::DAX:
+            workload->load_from_dax(desc.filename, desc.swf_options, main_args.time_window);
+            nb_machines_in_workload = desc.swf_options.nb_res;
+            break;
+        }
         max_nb_machines_in_workloads = std::max(max_nb_machines_in_workloads, nb_machines_in_workload);
 
         context->workloads.insert_workload(desc.name, workload);
@@ -168,7 +199,8 @@ void load_external_event_lists(const MainArguments & main_args, BatsimContext *
     {
         XBT_INFO("External event list '%s' corresponds to external_events file '%s'.", desc.name.c_str(), desc.filename.c_str());
         auto events = new ExternalEventList(desc.name, true);
-        events->load_from_json(desc.filename);
+        // Events are read by the submitter of the list while the simulation runs
+        events->filename = desc.filename;
         context->external_event_lists[desc.name] = events;
     }
 }
@@ -180,16 +212,45 @@ void start_initial_simulation_processes(const MainArguments & main_args,
 
     context->job_submitter_actors.reserve(main_args.workload_descriptions.size());
 
-    // Let's run a static_job_submitter process for each workload
+    // Let's run a job submitter process for each workload (SWF and generated workloads are streamed, workflows wait for dependencies)
     for (const MainArguments::WorkloadDescription & desc : main_args.workload_descriptions)
     {
         string submitter_instance_name = "workload_submitter_" + desc.name;
 
         XBT_DEBUG("Creating a workload_submitter process...");
-        simgrid::s4u::ActorPtr submitter_actor = simgrid::s4u::Engine::get_instance()->add_actor(submitter_instance_name.c_str(),
+        simgrid::s4u::ActorPtr submitter_actor;
+        switch (desc.source)
+        {
+        case WorkloadSource::JSON:
+        case WorkloadSource::DAX:
+            if (context->workloads.at(desc.name)->jobs->has_dependencies())
+            {
+                submitter_actor = simgrid::s4u::Engine::get_instance()->add_actor(submitter_instance_name.c_str(),
+                                        master_machine->host,
+                                        workflow_job_submitter_process,
+                                        context, desc.name);
+            }
+            else
+            {
+                submitter_actor = simgrid::s4u::Engine::get_instance()->add_actor(submitter_instance_name.c_str(),
+                                        master_machine->host,
+                                        static_job_submitter_process,
+                                        context, desc.name);
+            }
+            break;
+        case WorkloadSource::SWF:
+            submitter_actor = simgrid::s4u::Engine::get_instance()->add_actor(submitter_instance_name.c_str(),
                                     master_machine->host,
-                                    static_job_submitter_process,
-                                    context, desc.name);
+                                    swf_job_submitter_process,
+                                    context, desc.name, desc.swf_options);
+            break;
+        case WorkloadSource::GENERATOR:
+            submitter_actor = simgrid::s4u::Engine::get_instance()->add_actor(submitter_instance_name.c_str(),
+                                    master_machine->host,
+                                    generated_job_submitter_process,
+                                    context, desc.name, desc.swf_options, desc.generator_options);
+            break;
+        }
         context->job_submitter_actors.emplace(submitter_instance_name, submitter_actor);
         XBT_INFO("The process '%s' has been created.", submitter_instance_name.c_str());
     }
@@ -214,6 +275,17 @@ void start_initial_simulation_processes(const MainArguments & main_args,
     simgrid::s4u::Engine::get_instance()->add_actor("server", master_machine->host,
                                 server_process, context);
     XBT_INFO("The process 'server' has been created.");
+
+    if (context->time_window.enabled)
+    {
+        // Daemonized so that it does not outlive a simulation that finishes before the end of the window
+        XBT_DEBUG("Creating the 'time_window' process...");
+        simgrid::s4u::ActorPtr time_window_actor = simgrid::s4u::Engine::get_instance()->add_actor("time_window", master_machine->host,
+                                time_window_process, context);
+        time_window_actor->daemonize();
+        XBT_INFO("The process 'time_window' has been created (window: [%g, %g], warm-up: %g).",
+                 context->time_window.start, context->time_window.end, context->time_window.warm_up);
+    }
 }
 
 /**
@@ -295,38 +367,62 @@ int main(int argc, char * argv[])
     BatsimContext context;
     set_configuration(&context, main_args);
 
+    // Only the server modifies Batsim's shared state, other actors may therefore run on several threads
+    context.parallel_contexts = simgrid::s4u::Engine::get_config<int>("contexts/nthreads") > 1;
+    if (context.parallel_contexts)
+    {
+        XBT_INFO("SimGrid runs actors on %d threads", simgrid::s4u::Engine::get_config<int>("contexts/nthreads"));
+    }
+
     context.batsim_version = STR(BATSIM_VERSION);
     XBT_INFO("Batsim version: %s", context.batsim_version.c_str());
 
+    if (!main_args.internal_trace_filename.empty())
+    {
+        internal_tracing::start(main_args.internal_trace_filename, context.output_buffer_options);
+    }
+
     // Let's load the workloads
     int max_nb_machines_to_use = -1;
-    load_workloads(main_args, &context, max_nb_machines_to_use);
+    {
+        BATSIM_TRACE_SPAN("loading", "load_workloads");
+        PhaseTimer timer(&context, "loading");
+        load_workloads(main_args, &context, max_nb_machines_to_use);
+    }
 
     // Let's load the eventLists
-    load_external_event_lists(main_args, &context);
+    {
+        BATSIM_TRACE_SPAN("loading", "load_external_event_lists");
+        PhaseTimer timer(&context, "loading");
+        load_external_event_lists(main_args, &context);
+    }
 
     // initialyse Ptask L07 model
     engine.set_config("host/model:ptask_L07");
 
     // Let's choose which SimGrid computing model should be used
     XBT_INFO("Checking whether SMPI is used or not...");
-    context.smpi_used = context.workloads.contains_smpi_job(); // todo: SMPI workflows
+    context.smpi_used = context.workloads.contains_smpi_profile();
 
     if (context.smpi_used)
     {
+        // SMPI application instances are registered when their jobs are executed
         XBT_INFO("SMPI will be used.");
-        context.workloads.register_smpi_applications(); // todo: SMPI workflows
         SMPI_init();
     }
 
-    // Register Batsim replay functions
-    xbt_replay_action_register("m_usage", usage_trace_replayer);
-
     // Let's create the machines
-    create_machines(main_args, &context, max_nb_machines_to_use);
+    {
+        BATSIM_TRACE_SPAN("loading", "create_machines");
+        PhaseTimer timer(&context, "platform_creation");
+        create_machines(main_args, &context, max_nb_machines_to_use);
+    }
 
     // Prepare Batsim's outputs
-    prepare_batsim_outputs(&context);
+    {
+        PhaseTimer timer(&context, "output");
+        prepare_batsim_outputs(&context);
+    }
 
     if (!main_args.edc_socket_endpoint.empty())
     {
@@ -357,7 +453,11 @@ int main(int argc, char * argv[])
     engine.on_deadlock_cb(cb);
 
     // Simulation main loop, handled by s4u
-    engine.run();
+    {
+        BATSIM_TRACE_SPAN("simulation", "engine_run");
+        PhaseTimer timer(&context, "simulation_loop");
+        engine.run();
+    }
 
     delete context.edc;
     context.edc = nullptr;
@@ -383,6 +483,7 @@ int main(int argc, char * argv[])
 
     // Let's finalize Batsim's outputs
     finalize_batsim_outputs(&context);
+    internal_tracing::stop();
 
     return 0;
 }
@@ -400,5 +501,15 @@ void set_configuration(BatsimContext *context,
     context->energy_used = main_args.host_energy_used;
     context->trace_machine_states = main_args.enable_machine_state_tracing;
     context->trace_pstate_changes = main_args.enable_pstate_change_tracing;
+    context->probe_tracing_strategy = main_args.probe_tracing_strategy;
+    context->metrics_only = main_args.metrics_only;
+    context->machine_state_tracing_mode = main_args.machine_state_tracing_mode;
+    context->machine_state_sampling_period = main_args.machine_state_sampling_period;
+    context->output_buffer_options.buffer_size = main_args.output_buffer_size;
+    context->output_buffer_options.nb_buffers = main_args.output_buffer_count;
+    context->output_buffer_options.compression = main_args.output_compression;
+    context->ptask_matrix_cache.set_max_size(static_cast<size_t>(main_args.ptask_matrix_cache_size) * 1024 * 1024);
+    context->fast_forward_sequences = main_args.fast_forward_sequences;
+    context->time_window = main_args.time_window;
     context->simulation_start_time = chrono::high_resolution_clock::now();
 }
@@ -28,6 +28,7 @@ void load_workloads(const MainArguments & main_args, BatsimContext * context, in
 
 /**
  * @brief Loads the externalEventLists defined in Batsim arguments
+ * @details Only the lists are created, their events are read by their submitters while the simulation runs.
  * @param[in] main_args Batsim arguments
  * @param[in,out] context The BatsimContext
  */
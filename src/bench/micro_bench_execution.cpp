@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <intervalset.hpp>
+
+#include "../context.hpp"
+#include "../profiles.hpp"
+#include "../task_execution.hpp"
+
+/**
+ * @brief Returns an allocation of a given number of machines
+ * @param[in] nb_machines The number of machines
+ * @param[in] contiguous Whether the machines are contiguous, or every other machine
+ * @return The allocation
+ */
+static IntervalSet allocation(int nb_machines, bool contiguous)
+{
+    if (contiguous)
+    {
+        return IntervalSet(IntervalSet::ClosedInterval(0, nb_machines - 1));
+    }
+
+    IntervalSet machines;
+    for (int i = 0; i < nb_machines; ++i)
+    {
+        machines.insert(2 * i);
+    }
+    return machines;
+}
+
+// Same iteration as Machines::update_machines_on_job_run and update_machines_on_job_end
+static void intervalset_element_iteration(benchmark::State & state)
+{
+    const IntervalSet used_machines = allocation(static_cast<int>(state.range(0)), state.range(1) != 0);
+    std::vector<int> machine_states(static_cast<size_t>(2 * state.range(0)), 0);
+
+    for (auto _ : state)
+    {
+        for (auto it = used_machines.elements_begin(); it != used_machines.elements_end(); ++it)
+        {
+            ++machine_states[static_cast<size_t>(*it)];
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(intervalset_element_iteration)->ArgsProduct({{16, 1024, 65536}, {0, 1}});
+
+static void generate_parallel_task_homogeneous_uncached(benchmark::State & state)
+{
+    ParallelHomogeneousProfileData data;
+    data.cpu = 1e9;
+    data.com = 1e6;
+    const unsigned int nb_res = static_cast<unsigned int>(state.range(0));
+
+    std::vector<double> computation_amount;
+    std::vector<double> communication_amount;
+    for (auto _ : state)
+    {
+        generate_parallel_task_homogeneous_matrices(computation_amount, communication_amount, nb_res, &data);
+        benchmark::DoNotOptimize(communication_amount.data());
+    }
+}
+BENCHMARK(generate_parallel_task_homogeneous_uncached)->Arg(16)->Arg(256)->Arg(1024);
+
+static void generate_parallel_task_homogeneous_cached(benchmark::State & state)
+{
+    BatsimContext context;
+    ParallelHomogeneousProfileData data;
+    data.cpu = 1e9;
+    data.com = 1e6;
+    const unsigned int nb_res = static_cast<unsigned int>(state.range(0));
+
+    PtaskMatricesPtr matrices;
+    for (auto _ : state)
+    {
+        generate_parallel_task_homogeneous(matrices, nb_res, &data, &context);
+        benchmark::DoNotOptimize(matrices.get());
+    }
+}
+BENCHMARK(generate_parallel_task_homogeneous_cached)->Arg(16)->Arg(256)->Arg(1024);
@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../context.hpp"
+#include "../export.hpp"
+#include "../ipp.hpp"
+#include "../jobs.hpp"
+#include "../profiles.hpp"
+#include "../workload.hpp"
+
+/**
+ * @brief Returns a dynamic workload that contains a single delay profile named 'delay'
+ * @return The workload
+ */
+static Workload * workload_with_delay_profile()
+{
+    Workload * workload = Workload::new_dynamic_workload("w");
+    ProfilePtr profile = Profile::from_json("w!delay", R"({"type": "DelayProfile", "delay": 10})", workload);
+    workload->profiles->add_profile(profile->name, profile);
+    return workload;
+}
+
+static void job_identifier_from_parts(benchmark::State & state)
+{
+    const std::string workload_name = "some_workload";
+    int i = 0;
+    for (auto _ : state)
+    {
+        JobIdentifier id(workload_name, std::to_string(i++));
+        benchmark::DoNotOptimize(id);
+    }
+}
+BENCHMARK(job_identifier_from_parts);
+
+static void job_identifier_from_string(benchmark::State & state)
+{
+    int i = 0;
+    for (auto _ : state)
+    {
+        JobIdentifier id("some_workload!" + std::to_string(i++));
+        benchmark::DoNotOptimize(id);
+    }
+}
+BENCHMARK(job_identifier_from_string);
+
+static void job_identifier_hash(benchmark::State & state)
+{
+    const JobIdentifier id("some_workload", "123456");
+    JobIdentifierHasher hasher;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(hasher(id));
+    }
+}
+BENCHMARK(job_identifier_hash);
+
+static void job_from_json(benchmark::State & state)
+{
+    Workload * workload = workload_with_delay_profile();
+    int i = 0;
+    for (auto _ : state)
+    {
+        const std::string json = R"({"id": ")" + std::to_string(i++) + R"(", "subtime": 42.5, "walltime": 3600, "res": 16, "profile": "delay"})";
+        JobPtr job = Job::from_json(json, workload);
+        benchmark::DoNotOptimize(job);
+    }
+    delete workload;
+}
+BENCHMARK(job_from_json);
+
+static void jobs_tracer_write_job(benchmark::State & state)
+{
+    BatsimContext context;
+    Workload * workload = workload_with_delay_profile();
+
+    const std::string directory = std::filesystem::temp_directory_path().string();
+    JobsTracer tracer;
+    tracer.initialize(&context, directory + "/batsim_micro_bench_jobs.csv", directory + "/batsim_micro_bench_schedule.csv");
+
+    auto job = std::make_shared<Job>();
+    job->id = JobIdentifier("w", "1");
+    job->workload = workload;
+    job->profile = workload->profiles->at("w!delay");
+    job->requested_nb_res = static_cast<unsigned int>(state.range(0));
+    job->walltime = 3600;
+    job->submission_time = 10;
+    job->starting_time = 20;
+    job->runtime = 100;
+    job->state = JobState::JOB_STATE_COMPLETED_SUCCESSFULLY;
+    job->execution_request = std::make_shared<ExecuteJobMessage>();
+    job->execution_request->job_allocation = std::make_shared<AllocationPlacement>();
+    job->execution_request->job_allocation->hosts = IntervalSet(IntervalSet::ClosedInterval(0, static_cast<int>(state.range(0)) - 1));
+
+    for (auto _ : state)
+    {
+        tracer.write_job(job);
+    }
+    tracer.close_buffer();
+
+    // Profiles must not outlive their workload
+    job = nullptr;
+    delete workload;
+}
+BENCHMARK(jobs_tracer_write_job)->Arg(1)->Arg(1024);
@@ -0,0 +1,18 @@
+#include <benchmark/benchmark.h>
+
+#include <xbt/log.h>
+
+int main(int argc, char ** argv)
+{
+    // Batsim functions log at the info level, which would dominate the measurements
+    xbt_log_control_set("root.thresh:critical");
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
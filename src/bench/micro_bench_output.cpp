@@ -0,0 +1,22 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+
+#include "../export.hpp"
+
+static void write_buffer_append_text(benchmark::State & state)
+{
+    const std::string filename = std::filesystem::temp_directory_path().string() + "/batsim_micro_bench_wbuf";
+    WriteBufferOptions options;
+    options.nb_buffers = static_cast<unsigned int>(state.range(0));
+    WriteBuffer buffer(filename, options);
+
+    const std::string line = "42,w0,w0!delay,10.000000,16,3600.000000,1,COMPLETED_SUCCESSFULLY,20.000000,100.000000\n";
+    for (auto _ : state)
+    {
+        buffer.append_text(line.c_str(), line.size());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * line.size()));
+}
+BENCHMARK(write_buffer_append_text)->Arg(1)->Arg(4);
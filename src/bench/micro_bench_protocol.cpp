@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <batprotocol.hpp>
+
+#include "../context.hpp"
+#include "../ipp.hpp"
+#include "../jobs.hpp"
+#include "../profiles.hpp"
+#include "../protocol.hpp"
+#include "../workload.hpp"
+
+/**
+ * @brief Records a decision message of the EDC that executes a given number of jobs
+ * @param[in] nb_jobs The number of jobs executed in the message
+ * @param[in] json Whether the message should be encoded in JSON instead of flatbuffers
+ * @return The serialized message
+ */
+static std::vector<uint8_t> record_execute_jobs_message(int nb_jobs, bool json)
+{
+    batprotocol::MessageBuilder builder(json);
+    builder.clear(100);
+    for (int i = 0; i < nb_jobs; ++i)
+    {
+        builder.add_execute_job("w0!" + std::to_string(i), std::to_string(i % 1024));
+    }
+    builder.finish_message(100);
+
+    const uint8_t * buffer = nullptr;
+    uint32_t buffer_size = 0;
+    batprotocol::serialize_message(builder, json, &buffer, &buffer_size);
+
+    // Parsing expects a NULL-terminated buffer, as the EDC buffers copied by Batsim
+    std::vector<uint8_t> recorded(buffer, buffer + buffer_size);
+    recorded.push_back('\0');
+    return recorded;
+}
+
+static void parse_batprotocol_message(benchmark::State & state)
+{
+    const bool json = state.range(1) != 0;
+    const std::vector<uint8_t> recorded = record_execute_jobs_message(static_cast<int>(state.range(0)), json);
+
+    BatsimContext context;
+    context.edc_json_format = json;
+    context.proto_msg_builder = new batprotocol::MessageBuilder(json);
+
+    for (auto _ : state)
+    {
+        double now = -1;
+        auto messages = std::make_shared<std::vector<IPMessageWithTimestamp> >();
+        protocol::parse_batprotocol_message(recorded.data(), static_cast<uint32_t>(recorded.size() - 1), now, messages, &context);
+
+        state.PauseTiming();
+        for (auto & message : *messages)
+        {
+            delete message.message;
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+
+    delete context.proto_msg_builder;
+    context.proto_msg_builder = nullptr;
+}
+BENCHMARK(parse_batprotocol_message)->ArgsProduct({{1, 1000, 100000}, {0, 1}});
+
+static void serialize_job_submitted_batch(benchmark::State & state)
+{
+    const bool json = state.range(1) != 0;
+
+    Workload * workload = Workload::new_dynamic_workload("w0");
+    ProfilePtr profile = Profile::from_json("w0!delay", R"({"type": "DelayProfile", "delay": 10})", workload);
+    workload->profiles->add_profile(profile->name, profile);
+
+    Job job;
+    job.id = JobIdentifier("w0", "0");
+    job.profile = profile;
+    job.requested_nb_res = 16;
+    job.walltime = 3600;
+    auto proto_job = protocol::to_job(job);
+
+    batprotocol::MessageBuilder builder(json);
+    for (auto _ : state)
+    {
+        builder.clear(100);
+        for (int i = 0; i < state.range(0); ++i)
+        {
+            builder.add_job_submitted("w0!" + std::to_string(i), proto_job, 100);
+        }
+        builder.finish_message(100);
+
+        const uint8_t * buffer = nullptr;
+        uint32_t buffer_size = 0;
+        batprotocol::serialize_message(builder, json, &buffer, &buffer_size);
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+
+    // Profiles must not outlive their workload
+    job.profile = nullptr;
+    profile = nullptr;
+    delete workload;
+}
+BENCHMARK(serialize_job_submitted_batch)->ArgsProduct({{1, 1000, 100000}, {0, 1}});
@@ -12,6 +12,7 @@
 
 #include <CLI/CLI.hpp>
 
+#include <cmath>
 #include <filesystem>
 #include <fstream>
 
@@ -136,6 +137,16 @@ std::string absolute_filename(const std::string & filename)
     return string(getcwd_ret) + '/' + filename;
 }
 
+bool TimeWindow::skips(long double submission_time) const
+{
+    return enabled && (submission_time < start - warm_up || submission_time > end);
+}
+
+bool TimeWindow::is_warm_up(long double submission_time) const
+{
+    return enabled && submission_time < start;
+}
+
 /**
  * @brief Converts a string to a VerbosityLevel
  * @param[in] str The string
@@ -161,6 +172,260 @@ VerbosityLevel verbosity_level_from_string(const std::string & str)
     }
 }
 
+/**
+ * @brief Parses a parameter of a generated workload
+ * @param[in] key The parameter name
+ * @param[in] value The parameter value
+ * @param[in,out] options The generator options to update
+ * @param[out] known Whether key is a generator parameter
+ * @return An empty string on success, the reason of the failure otherwise
+ * @throw std::logic_error if a number cannot be parsed
+ */
+static std::string parse_generator_parameter(const std::string & key, const std::string & value, GeneratorWorkloadOptions & options, bool & known)
+{
+    known = true;
+    if (key == "seed")
+    {
+        options.seed = std::stoull(value);
+    }
+    else if (key == "jobs")
+    {
+        // Scientific notation (jobs=5e6) is accepted
+        double nb_jobs = std::stod(value);
+        if (nb_jobs < 1 || nb_jobs != std::floor(nb_jobs))
+        {
+            return "generated workload jobs must be a strictly positive integer.";
+        }
+        options.nb_jobs = static_cast<uint64_t>(nb_jobs);
+    }
+    else if (key == "load")
+    {
+        options.load = std::stod(value);
+        if (options.load <= 0)
+        {
+            return "generated workload load must be strictly positive.";
+        }
+    }
+    else if (key == "arrival")
+    {
+        std::map<std::string, GeneratorArrivalDistribution> arrivals{{"poisson", GeneratorArrivalDistribution::POISSON}, {"fixed", GeneratorArrivalDistribution::FIXED}};
+        if (arrivals.count(value) == 0)
+        {
+            return "invalid arrival distribution '" + value + "'. Accepted values: {poisson, fixed}.";
+        }
+        options.arrival = arrivals.at(value);
+    }
+    else if (key == "size")
+    {
+        std::map<std::string, GeneratorSizeDistribution> sizes{{"lublin", GeneratorSizeDistribution::LUBLIN}, {"uniform", GeneratorSizeDistribution::UNIFORM}};
+        if (sizes.count(value) == 0)
+        {
+            return "invalid size distribution '" + value + "'. Accepted values: {lublin, uniform}.";
+        }
+        options.size = sizes.at(value);
+    }
+    else if (key == "runtime")
+    {
+        std::map<std::string, GeneratorRuntimeDistribution> runtimes{{"lublin", GeneratorRuntimeDistribution::LUBLIN}, {"exponential", GeneratorRuntimeDistribution::EXPONENTIAL}};
+        if (runtimes.count(value) == 0)
+        {
+            return "invalid runtime distribution '" + value + "'. Accepted values: {lublin, exponential}.";
+        }
+        options.runtime = runtimes.at(value);
+    }
+    else if (key == "mean_runtime")
+    {
+        options.mean_runtime = std::stod(value);
+        if (options.mean_runtime <= 0)
+        {
+            return "generated workload mean_runtime must be strictly positive.";
+        }
+    }
+    else if (key == "max_runtime")
+    {
+        options.max_runtime = std::stod(value);
+        if (options.max_runtime <= 0)
+        {
+            return "generated workload max_runtime must be strictly positive.";
+        }
+    }
+    else
+    {
+        known = false;
+    }
+
+    return "";
+}
+
+/**
+ * @brief Parses a parameter that sets how SWF, generated or DAX jobs are mapped to profiles
+ * @param[in] key The parameter name
+ * @param[in] value The parameter value
+ * @param[in,out] options The options to update
+ * @param[out] known Whether key is a job mapping parameter
+ * @return An empty string on success, the reason of the failure otherwise
+ * @throw std::logic_error if a number cannot be parsed
+ */
+static std::string parse_job_mapping_parameter(const std::string & key, const std::string & value, SwfWorkloadOptions & options, bool & known)
+{
+    known = true;
+    if (key == "profile")
+    {
+        if (value == "delay")
+        {
+            options.profile_mapping = SwfProfileMapping::DELAY;
+        }
+        else if (value == "ptask")
+        {
+            options.profile_mapping = SwfProfileMapping::PTASK;
+        }
+        else
+        {
+            return "invalid profile mapping '" + value + "'. Accepted values: {delay, ptask}.";
+        }
+    }
+    else if (key == "speed")
+    {
+        options.computation_speed = std::stod(value);
+        if (options.computation_speed <= 0)
+        {
+            return "workload speed must be strictly positive.";
+        }
+    }
+    else if (key == "walltime_factor")
+    {
+        options.walltime_factor = std::stod(value);
+        if (options.walltime_factor <= 0)
+        {
+            return "workload walltime_factor must be strictly positive.";
+        }
+    }
+    else if (key == "nb_res")
+    {
+        options.nb_res = std::stoi(value);
+        if (options.nb_res <= 0)
+        {
+            return "workload nb_res must be strictly positive.";
+        }
+    }
+    else
+    {
+        known = false;
+    }
+
+    return "";
+}
+
+/**
+ * @brief Parses a workload command-line argument, whose syntax is <file>[?<key>=<value>[&<key>=<value>...]] or gen:<model>[?<key>=<value>...]
+ * @details Parameters are only accepted by SWF workloads (.swf or .swf.gz files), DAX workflows (.dax files) and generated workloads.
+ * @param[in] argument The workload command-line argument
+ * @param[out] desc The workload description to fill (its filename, source and streaming options)
+ * @return An empty string on success, the reason of the failure otherwise
+ */
+std::string parse_workload_argument(const std::string & argument, MainArguments::WorkloadDescription & desc)
+{
+    auto question_mark_pos = argument.find('?');
+    std::string filename = argument.substr(0, question_mark_pos);
+    std::string source_name;
+
+    if (boost::algorithm::starts_with(filename, "gen:"))
+    {
+        desc.source = WorkloadSource::GENERATOR;
+        desc.filename = argument;
+        source_name = "generated";
+
+        // The model sets the default distributions, which parameters can override
+        GeneratorWorkloadOptions & options = desc.generator_options;
+        options.model = filename.substr(4);
+        if (options.model == "lublin")
+        {
+            options.size = GeneratorSizeDistribution::LUBLIN;
+            options.runtime = GeneratorRuntimeDistribution::LUBLIN;
+        }
+        else if (options.model == "uniform")
+        {
+            options.size = GeneratorSizeDistribution::UNIFORM;
+            options.runtime = GeneratorRuntimeDistribution::EXPONENTIAL;
+        }
+        else
+        {
+            return "unknown workload generation model '" + options.model + "'. Accepted values: {lublin, uniform}.";
+        }
+    }
+    else
+    {
+        if (filename.empty() || !file_exists(filename))
+        {
+            return "workload file '" + filename + "' does not exist.";
+        }
+
+        desc.filename = absolute_filename(filename);
+        if (boost::algorithm::ends_with(filename, ".swf") || boost::algorithm::ends_with(filename, ".swf.gz"))
+        {
+            desc.source = WorkloadSource::SWF;
+            source_name = "SWF";
+        }
+        else if (boost::algorithm::ends_with(filename, ".dax"))
+        {
+            desc.source = WorkloadSource::DAX;
+            source_name = "DAX";
+        }
+        else if (question_mark_pos != std::string::npos)
+        {
+            return "workload '" + argument + "' has parameters but is neither a SWF file (.swf or .swf.gz), a DAX file (.dax) nor generated (gen:<model>).";
+        }
+    }
+
+    std::vector<std::string> parameters;
+    if (question_mark_pos != std::string::npos)
+    {
+        const std::string parameters_str = argument.substr(question_mark_pos + 1);
+        boost::split(parameters, parameters_str, boost::is_any_of("&"), boost::token_compress_on);
+    }
+
+    for (const std::string & parameter : parameters)
+    {
+        auto equal_pos = parameter.find('=');
+        if (equal_pos == std::string::npos)
+        {
+            return "invalid workload parameter '" + parameter + "' (expected <key>=<value>).";
+        }
+
+        const std::string key = parameter.substr(0, equal_pos);
+        const std::string value = parameter.substr(equal_pos + 1);
+        try
+        {
+            bool known = false;
+            std::string parameter_error = parse_job_mapping_parameter(key, value, desc.swf_options, known);
+            if (!known && desc.source == WorkloadSource::GENERATOR)
+            {
+                parameter_error = parse_generator_parameter(key, value, desc.generator_options, known);
+            }
+
+            if (!known)
+            {
+                return "unknown parameter '" + key + "' for " + source_name + " workload '" + argument + "'.";
+            }
+            if (!parameter_error.empty())
+            {
+                return parameter_error;
+            }
+        }
+        catch (const std::logic_error &)
+        {
+            return "invalid value '" + value + "' for workload parameter '" + key + "'.";
+        }
+    }
+
+    if (desc.swf_options.profile_mapping == SwfProfileMapping::PTASK && desc.swf_options.computation_speed <= 0)
+    {
+        return "profile mapping 'ptask' requires the speed parameter (in flop/s).";
+    }
+
+    return "";
+}
+
 void parse_main_args(int argc, char * argv[], MainArguments & main_args, int & return_code, bool & run_simulation, bool & only_print_information)
 {
     bool error = false;
@@ -181,10 +446,19 @@ void parse_main_args(int argc, char * argv[], MainArguments & main_args, int & r
         ->check(CLI::ExistingFile);
 
     std::vector<std::string> workload_files;
-    app.add_option("-w,--workload", workload_files, "A workload JSON file to simulate — cf. https://batsim.rtfd.io/en/latest/input-workload.html")
+    app.add_option("-w,--workload", workload_files, "A workload to simulate: a JSON file, a SWF file (.swf or .swf.gz) or a DAX workflow (.dax) with optional parameters such as file.swf?profile=ptask&speed=1e9, or a generator such as gen:lublin?seed=3&jobs=5e6&load=0.8 — cf. https://batsim.rtfd.io/en/latest/input-workload.html")
         ->group(input_group_name)
-        ->option_text("<file>...")
-        ->check(CLI::ExistingFile);
+        ->option_text("<file>...");
+
+    std::string time_window_str;
+    app.add_option("--time-window", time_window_str, "Only simulate the jobs submitted in this window (in simulated seconds), and stop the simulation at its end")
+        ->group(input_group_name)
+        ->option_text("<start>:<end>");
+
+    app.add_option("--warm-up", main_args.time_window.warm_up, "Also execute the jobs submitted during this period before the time window, but exclude them from outputs. Requires --time-window. Default: 0")
+        ->group(input_group_name)
+        ->option_text("<seconds>")
+        ->check(CLI::NonNegativeNumber);
 
     std::vector<std::string> external_events_files;
     app.add_option("--ee,--external-events", external_events_files, "A file containing external events to inject in the simulation")
@@ -201,15 +475,45 @@ void parse_main_args(int argc, char * argv[], MainArguments & main_args, int & r
     app.add_flag("--trace-machine-state", main_args.enable_machine_state_tracing, "Enable the generation of output file that traces machine states over time")
         ->group(output_group_name);
 
+    std::map<std::string, MachineStateTracingMode> mstm_map{{"every-change", MachineStateTracingMode::EVERY_CHANGE}, {"coalesce", MachineStateTracingMode::COALESCE}, {"sampled", MachineStateTracingMode::SAMPLED}};
+    app.add_option("--machine-state-tracing-mode", main_args.machine_state_tracing_mode, "")
+        ->group(output_group_name)
+        ->option_text("<mode>")
+        ->description("How machine states are traced. Accepted values: {every-change, coalesce, sampled}. Default: every-change\ncoalesce only keeps the last line of each timestamp\nsampled outputs the time-weighted average of each state over fixed periods")
+        ->transform(CLI::CheckedTransformer(mstm_map, CLI::ignore_case));
+
+    app.add_option("--machine-state-sampling-period", main_args.machine_state_sampling_period, "The simulated time period (in seconds) of each sample in sampled machine state tracing mode. Default: 60")
+        ->group(output_group_name)
+        ->option_text("<seconds>")
+        ->check(CLI::PositiveNumber);
+
     app.add_flag("--trace-pstate-changes", main_args.enable_pstate_change_tracing, "Enable the generation of output file that traces machine pstate changes over time")
         ->group(output_group_name);
 
-    ProbeTracingStrategy probe_tracing_strategy = ProbeTracingStrategy::AS_PROBE_REQUESTED;
+    app.add_flag("--metrics-only", main_args.metrics_only, "Do not generate the jobs output file, only output aggregated metrics and their distributions")
+        ->group(output_group_name);
+
+    app.add_option("--output-buffer-size", main_args.output_buffer_size, "The size (in bytes) of each buffer used to write output files. Default: 65536")
+        ->group(output_group_name)
+        ->option_text("<bytes>")
+        ->check(CLI::PositiveNumber);
+
+    app.add_option("--output-buffers", main_args.output_buffer_count, "The number of buffers used to write each output file. Default: 2\n1 writes output files synchronously, 2 or more writes them from a background thread")
+        ->group(output_group_name)
+        ->option_text("<nb>")
+        ->check(CLI::PositiveNumber);
+
+    std::map<std::string, OutputCompression> oc_map{{"none", OutputCompression::NONE}, {"gzip", OutputCompression::GZIP}};
+    app.add_option("--output-compression", main_args.output_compression, "How output time series (CSV files) should be compressed. Accepted values: {none, gzip}. Default: none")
+        ->group(output_group_name)
+        ->option_text("<method>")
+        ->transform(CLI::CheckedTransformer(oc_map, CLI::ignore_case));
+
     std::map<std::string, ProbeTracingStrategy> pts_map{{"always", ProbeTracingStrategy::ALWAYS}, {"never", ProbeTracingStrategy::NEVER}, {"auto", ProbeTracingStrategy::AS_PROBE_REQUESTED}};
-    app.add_option("--trace-probe-data", probe_tracing_strategy, "")
+    app.add_option("--trace-probe-data", main_args.probe_tracing_strategy, "")
         ->group(output_group_name)
         ->option_text("<when>")
-        ->description("Force tracing of data generated by probes. Accepted values: {always, never, auto}\nDefault (auto) will trace probes that request to be traced")
+        ->description("Force tracing of data generated by probes into binary time series (one file per probe). Accepted values: {always, never, auto}\nDefault (auto) will trace probes that request to be traced")
         ->transform(CLI::CheckedTransformer(pts_map, CLI::ignore_case));
 
     // External decision components
@@ -281,6 +585,14 @@ void parse_main_args(int argc, char * argv[], MainArguments & main_args, int & r
         ->group(simulation_model_group_name)
         ->option_text("<name:value>...");
 
+    app.add_option("--ptask-matrix-cache-size", main_args.ptask_matrix_cache_size, "The maximum amount of memory (in MiB) used to cache the matrices of homogeneous parallel tasks. 0 disables the cache. Default: 256")
+        ->group(simulation_model_group_name)
+        ->option_text("<MiB>")
+        ->check(CLI::NonNegativeNumber);
+
+    app.add_flag("--fast-forward-sequences", main_args.fast_forward_sequences, "If set, once a repetition of a sequence profile has been simulated while the platform sharing did not change, the next repetitions are not simulated but skipped analytically until the platform sharing changes")
+        ->group(simulation_model_group_name);
+
     // Verbosity
     const std::string verbosity_group_name = "Verbosity and debuggability options";
     std::map<std::string, VerbosityLevel> vl_map{{"quiet", VerbosityLevel::QUIET}, {"info", VerbosityLevel::INFORMATION}, {"debug", VerbosityLevel::DEBUG}};
@@ -298,6 +610,10 @@ void parse_main_args(int argc, char * argv[], MainArguments & main_args, int & r
         ->group(verbosity_group_name)
         ->option_text("<cat.key:value>");
 
+    app.add_option("--trace-internals", main_args.internal_trace_filename, "Trace where Batsim spends its real time into <file> (Chrome trace-event format, viewable with https://ui.perfetto.dev)\nRequires Batsim to be built with the trace_internals meson option")
+        ->group(verbosity_group_name)
+        ->option_text("<file>");
+
     // Configuration file
     const std::string config_group_name = "Configuration file options";
     app.set_config("-c,--config", "", "Read Batsim CLI options from configuration <file> as TOML/INI format")
@@ -388,12 +704,54 @@ void parse_main_args(int argc, char * argv[], MainArguments & main_args, int & r
         const string & workload_file = workload_files[i];
 
         MainArguments::WorkloadDescription desc;
-        desc.filename = absolute_filename(workload_file);
         desc.name = string("w") + to_string(i);
 
+        string workload_error = parse_workload_argument(workload_file, desc);
+        if (!workload_error.empty())
+        {
+            fprintf(stderr, "%s%s\n", error_prefix, workload_error.c_str());
+            error = true;
+            continue;
+        }
+
         main_args.workload_descriptions.push_back(desc);
     }
 
+    // Time window
+    if (!time_window_str.empty())
+    {
+        std::vector<std::string> bounds;
+        boost::split(bounds, time_window_str, boost::is_any_of(":"));
+        if (bounds.size() == 2)
+        {
+            try
+            {
+                main_args.time_window.start = std::stod(bounds[0]);
+                main_args.time_window.end = std::stod(bounds[1]);
+                main_args.time_window.enabled = true;
+            }
+            catch (const std::logic_error &)
+            {
+            }
+        }
+
+        if (!main_args.time_window.enabled)
+        {
+            fprintf(stderr, "%sInvalid time window '%s' (expected <start>:<end>).\n", error_prefix, time_window_str.c_str());
+            error = true;
+        }
+        else if (main_args.time_window.start < 0 || main_args.time_window.end <= main_args.time_window.start)
+        {
+            fprintf(stderr, "%sInvalid time window '%s': 0 <= start < end must hold.\n", error_prefix, time_window_str.c_str());
+            error = true;
+        }
+    }
+    else if (main_args.time_window.warm_up > 0)
+    {
+        fprintf(stderr, "%s--warm-up requires --time-window.\n", error_prefix);
+        error = true;
+    }
+
     // External events
     for (size_t i = 0; i < external_events_files.size(); i++)
     {
@@ -468,6 +826,15 @@ void parse_main_args(int argc, char * argv[], MainArguments & main_args, int & r
         }
     }
 
+    // Internal tracing
+#ifndef BATSIM_TRACE_INTERNALS
+    if (!main_args.internal_trace_filename.empty())
+    {
+        fprintf(stderr, "%s--trace-internals is not available: Batsim has been built without the trace_internals meson option.\n", error_prefix);
+        error = true;
+    }
+#endif
+
     // Verbosity
     if (quiet)
         main_args.verbosity = VerbosityLevel::QUIET;
@@ -10,6 +10,9 @@
 #include <string>
 #include <vector>
 
+#include "swf.hpp"
+#include "workload_generator.hpp"
+
 /** @def STR_HELPER(x)
  *  @brief Helper macro to retrieve the string view of a macro.
  */
@@ -49,6 +52,61 @@ enum class ProbeTracingStrategy
     ,NEVER //!< Never trace any probe
 };
 
+/**
+ * @brief Where the jobs of a workload come from
+ */
+enum class WorkloadSource
+{
+    JSON            //!< A Batsim JSON workload file, fully loaded before the simulation
+    ,SWF            //!< A SWF trace, whose jobs are read while the simulation runs
+    ,GENERATOR      //!< A statistical model, whose jobs are generated while the simulation runs
+    ,DAX            //!< A Pegasus workflow, whose jobs are submitted once the jobs they depend on have completed
+};
+
+/**
+ * @brief How output files should be compressed
+ */
+enum class OutputCompression
+{
+    NONE //!< Output files are not compressed
+    ,GZIP //!< Output files are compressed with gzip (requires Batsim to be built with zlib)
+};
+
+/**
+ * @brief How machine states should be traced over time
+ */
+enum class MachineStateTracingMode
+{
+    EVERY_CHANGE //!< A line is written each time machine states are updated
+    ,COALESCE //!< Only the last line is written for each timestamp
+    ,SAMPLED //!< Time-weighted average number of machines in each state are written for fixed-size simulated time periods
+};
+
+/**
+ * @brief The part of the workloads that is simulated, to study a period of a long trace without simulating all of it
+ */
+struct TimeWindow
+{
+    bool enabled = false;   //!< Whether the simulation is restricted to a time window. If false, all jobs are simulated.
+    double start = 0;       //!< The start of the window (in simulated seconds). Jobs submitted before it are warm-up jobs.
+    double end = 0;         //!< The end of the window (in simulated seconds), at which the simulation is stopped
+    double warm_up = 0;     //!< How long (in simulated seconds) before the start of the window jobs are submitted to fill the platform
+
+    /**
+     * @brief Returns whether a job should be skipped (not loaded at all) because of its submission time
+     * @param[in] submission_time The submission time of the job
+     * @return true if and only if the job is submitted before the warm-up period or after the window
+     */
+    bool skips(long double submission_time) const;
+
+    /**
+     * @brief Returns whether a job is a warm-up job, which is executed but excluded from outputs and metrics
+     * @param[in] submission_time The submission time of the job
+     * @return true if and only if the job is submitted before the start of the window
+     */
+    bool is_warm_up(long double submission_time) const;
+};
+
 /**
  * @brief Stores Batsim arguments, a.k.a. the main function arguments
  */
@@ -59,8 +117,11 @@ struct MainArguments
      */
     struct WorkloadDescription
     {
-        std::string filename;   //!< The name of the workload file
+        std::string filename;   //!< The name of the workload file (or the generator specification of generated workloads)
         std::string name;       //!< The name of the workload
+        WorkloadSource source = WorkloadSource::JSON; //!< Where the jobs of the workload come from
+        SwfWorkloadOptions swf_options; //!< How SWF, generated or DAX jobs are mapped to profiles and walltimes
+        GeneratorWorkloadOptions generator_options; //!< How jobs are generated, for generated workloads
     };
 
    /**
@@ -76,6 +137,7 @@ struct MainArguments
     std::string platform_filename;                          //!< The SimGrid platform filename
     std::list<WorkloadDescription> workload_descriptions;   //!< The workloads descriptions
     std::list<ExternalEventListDescription> externalEventList_descriptions; //!< The descriptions of the externalEventLists
+    TimeWindow time_window;                                 //!< The part of the workloads that is simulated
 
     // Common
     std::string master_host_name = "master_host";           //!< The name of the SimGrid host which runs scheduler processes and not user tasks
@@ -91,6 +153,13 @@ struct MainArguments
     std::string export_prefix = "out/";                     //!< The filename prefix used to export simulation information
     bool enable_machine_state_tracing = false;              //!< If set to true, this option enables the tracing of the machine states into a CSV time series.
     bool enable_pstate_change_tracing = false;              //!< If set to true, this option enables the tracing of SimGrid hosts power state changes into a CSV time series.
+    MachineStateTracingMode machine_state_tracing_mode = MachineStateTracingMode::EVERY_CHANGE; //!< How machine states are traced (if enabled).
+    double machine_state_sampling_period = 60;              //!< The simulated time period (in seconds) of machine state samples, if they are traced in sampled mode.
+    bool metrics_only = false;                              //!< If set to true, jobs are not traced individually and only aggregated metrics are outputted.
+    unsigned int output_buffer_size = 64*1024;              //!< The size (in bytes) of each buffer used to write output files.
+    unsigned int output_buffer_count = 2;                   //!< The number of buffers used to write each output file. 1 means output files are written synchronously, more means they are written by a background thread.
+    OutputCompression output_compression = OutputCompression::NONE; //!< How output files should be compressed.
+    ProbeTracingStrategy probe_tracing_strategy = ProbeTracingStrategy::AS_PROBE_REQUESTED; //!< Which probes should have their data traced into binary time series.
 
     // Platform size limit
     unsigned int limit_machines_count = 0;                  //!< The number of machines to use to compute jobs. 0 : no limit. > 0 : the number of computation machines
@@ -99,6 +168,9 @@ struct MainArguments
     // Verbosity
     VerbosityLevel verbosity = VerbosityLevel::INFORMATION; //!< Sets the Batsim verbosity
 
+    // Internal tracing
+    std::string internal_trace_filename;                    //!< The file into which Batsim's internal phases are traced (Chrome trace-event format). Empty if unset.
+
     // Raw argv
     std::vector<std::string> raw_argv;                      //!< The strings the Batsim process received as argv.
 
@@ -112,6 +184,8 @@ struct MainArguments
     // Other
     std::vector<std::string> simgrid_config;                //!< The list of configuration options to pass to SimGrid.
     std::vector<std::string> simgrid_logging;               //!< The list of simulation logging options to pass to SimGrid.
+    unsigned int ptask_matrix_cache_size = 256;             //!< The maximum amount of memory (in MiB) used to cache the matrices of homogeneous parallel tasks. 0 disables the cache.
+    bool fast_forward_sequences = false;                    //!< If set, the identical repetitions of sequence profiles are fast-forwarded instead of being simulated one by one.
     EdcLibraryLoadMethod edc_library_load_method = EdcLibraryLoadMethod::DLOPEN; //!< How external decision components should be loaded in memory.
 
 public:
@@ -1,5 +1,7 @@
 #include "context.hpp"
 
+#include <mutex>
+
 BatsimContext::~BatsimContext()
 {
     for (auto it : external_event_lists)
@@ -7,3 +9,34 @@ BatsimContext::~BatsimContext()
         delete it.second;
     }
 }
+
+void BatsimContext::notify_platform_change()
+{
+    if (platform_change_cv == nullptr)
+    {
+        ++platform_change_count;
+        return;
+    }
+
+    // Actors are only preempted with parallel contexts: a waiter could otherwise miss a change between its count check and its wait
+    std::unique_lock<simgrid::s4u::Mutex> lock;
+    if (parallel_contexts)
+    {
+        lock = std::unique_lock<simgrid::s4u::Mutex>(*platform_change_mutex);
+    }
+    ++platform_change_count;
+    platform_change_cv->notify_all();
+}
+
+PhaseTimer::PhaseTimer(BatsimContext * context, const std::string & phase) :
+    _context(context),
+    _phase(phase),
+    _start(std::chrono::high_resolution_clock::now())
+{
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    std::chrono::duration<long double> elapsed = std::chrono::high_resolution_clock::now() - _start;
+    _context->seconds_used_by_phase[_phase] += elapsed.count();
+}
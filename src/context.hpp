@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <vector>
@@ -23,6 +24,7 @@
 #include "profiles.hpp"
 #include "protocol.hpp"
 #include "pstate.hpp"
+#include "ptask_matrix_cache.hpp"
 #include "workload.hpp"
 
 class ExternalDecisionComponent;
@@ -53,6 +55,7 @@ struct BatsimContext
     PStateChangeTracer pstate_tracer;               //!< The PStateChangeTracer
     EnergyConsumptionTracer energy_tracer;          //!< The EnergyConsumptionTracer
     MachineStateTracer machine_state_tracer;        //!< The MachineStateTracer
+    ProbeDataTracer probe_data_tracer;              //!< The ProbeDataTracer
     std::ofstream real_execution_info_file;         //!< The file into which information related to the real execution (real time measurements, real memory usage...) are written
     JobsTracer jobs_tracer;                         //!< The JobsTracer
     CurrentSwitches current_switches;               //!< The current switches
@@ -64,11 +67,21 @@ struct BatsimContext
     bool registration_sched_finished = false;       //!< Stores whether the scheduler has finished submitting jobs.
     bool registration_sched_ack;                    //!< Stores whether Batsim will acknowledge dynamic job submission (emit JOB_SUBMITTED events)
     bool garbage_collect_profiles = true;           //!< Stores whether Batsim will garbage collect the Profiles.
+    TimeWindow time_window;                         //!< The part of the workloads that is simulated
 
     long double energy_first_job_submission = -1;   //!< The amount of consumed energy (J) when the first job is submitted
     long double energy_last_job_completion = -1;    //!< The amount of consumed energy (J) when the last job is completed
 
     long double microseconds_used_by_scheduler = 0; //!< The number of microseconds used by the scheduler
+    long double microseconds_used_by_serialization = 0; //!< The number of microseconds spent serializing messages sent to the EDC
+    long double microseconds_used_by_deserialization = 0; //!< The number of microseconds spent parsing messages received from the EDC
+    std::map<std::string, long double> seconds_used_by_phase; //!< The number of seconds spent in each phase of Batsim's execution (loading, simulation loop...)
+    unsigned long long nb_edc_calls = 0;            //!< The number of times the EDC has been called
+    QuantileSketch edc_call_latency_us;             //!< The distribution of the duration of EDC calls (in microseconds)
+    unsigned long long nb_bytes_sent_to_edc = 0;    //!< The number of bytes of the messages sent to the EDC
+    unsigned long long nb_bytes_received_from_edc = 0; //!< The number of bytes of the messages received from the EDC
+    unsigned long long nb_events_received_from_edc = 0; //!< The number of events received from the EDC
+    unsigned long long nb_server_messages_handled = 0; //!< The number of inter-actor messages handled by the server
     my_timestamp simulation_start_time;             //!< The moment in time at which the simulation has started
     my_timestamp simulation_end_time;               //!< The moment in time at which the simulation has ended
 
@@ -80,10 +93,60 @@ struct BatsimContext
     bool trace_schedule;                            //!< Stores whether the resulting schedule should be outputted
     bool trace_machine_states;                      //!< Stores whether the machines states should be outputted
     bool trace_pstate_changes;                      //!< Stores whether the machine pstate changes should be outputted
+    ProbeTracingStrategy probe_tracing_strategy = ProbeTracingStrategy::AS_PROBE_REQUESTED; //!< Which probes should have their data outputted
+    MachineStateTracingMode machine_state_tracing_mode = MachineStateTracingMode::EVERY_CHANGE; //!< How the machine states should be outputted
+    double machine_state_sampling_period = 60;      //!< The simulated time period of each machine state sample (in sampled tracing mode)
+    bool metrics_only = false;                      //!< Stores whether only aggregated job metrics should be outputted (no per-job output)
     std::string platform_filename;                  //!< The name of the platform file
     std::string export_prefix;                      //!< The output export prefix
+    WriteBufferOptions output_buffer_options;       //!< How output files should be written
+    PtaskMatrixCache ptask_matrix_cache;            //!< The matrices of recently executed homogeneous parallel tasks
+    bool fast_forward_sequences = false;            //!< Stores whether the identical repetitions of sequence profiles can be fast-forwarded
+
+    bool parallel_contexts = false;                 //!< Stores whether SimGrid runs actors on several threads (contexts/nthreads > 1)
+    std::atomic<unsigned long long> platform_change_count{0}; //!< Incremented whenever the resource sharing of the platform may change (activities, jobs, power states)
+    std::atomic<unsigned int> nb_running_trace_replays{0}; //!< The number of trace replays being executed, whose resource sharing is not tracked
+    std::atomic<unsigned int> nb_running_activities{0}; //!< The number of parallel tasks being executed
+    simgrid::s4u::ConditionVariablePtr platform_change_cv = nullptr; //!< Notified whenever platform_change_count is incremented. Created by the server if sequences can be fast-forwarded.
+    simgrid::s4u::MutexPtr platform_change_mutex = nullptr; //!< Protects platform_change_count for platform_change_cv waiters. Created with platform_change_cv.
+    std::atomic<unsigned long long> nb_fast_forwarded_repetitions{0}; //!< The number of sequence repetitions that have been fast-forwarded instead of being simulated
 
     std::string batsim_version;                     //!< The Batsim version (got from the BATSIM_VERSION variable that is usually set by the build system)
 
     ~BatsimContext();
+
+    /**
+     * @brief Tells that the resource sharing of the platform may have changed, which interrupts sequence fast-forwards
+     */
+    void notify_platform_change();
+};
+
+/**
+ * @brief Measures the real time spent in a scope, and adds it to a phase of BatsimContext::seconds_used_by_phase
+ */
+class PhaseTimer
+{
+public:
+    /**
+     * @brief Starts measuring time
+     * @param[in,out] context The BatsimContext
+     * @param[in] phase The name of the phase the time should be added to
+     */
+    PhaseTimer(BatsimContext * context, const std::string & phase);
+
+    /**
+     * @brief PhaseTimers cannot be copied.
+     * @param[in] other Another instance
+     */
+    PhaseTimer(const PhaseTimer & other) = delete;
+
+    /**
+     * @brief Stops measuring time and adds the elapsed time to the phase
+     */
+    ~PhaseTimer();
+
+private:
+    BatsimContext * _context;   //!< The BatsimContext
+    std::string _phase;         //!< The name of the phase
+    my_timestamp _start;        //!< The moment in time at which the measure started
 };
@@ -0,0 +1,79 @@
+/**
+ * @file dax.cpp
+ * @brief Reading of workflows in the DAX format of the Pegasus workflow management system
+ */
+
+#include "dax.hpp"
+
+#include <unordered_map>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+#include <xbt.h>
+
+using namespace std;
+namespace pt = boost::property_tree;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(dax, "dax"); //!< Logging
+
+std::vector<DaxTask> read_dax(const std::string & filename)
+{
+    pt::ptree tree;
+    try
+    {
+        pt::read_xml(filename, tree, pt::xml_parser::trim_whitespace);
+    }
+    catch (const pt::xml_parser_error & error)
+    {
+        xbt_die("Invalid DAX file '%s': %s", filename.c_str(), error.what());
+    }
+
+    auto adag = tree.get_child_optional("adag");
+    xbt_assert(adag, "Invalid DAX file '%s': the 'adag' root element is missing", filename.c_str());
+
+    vector<DaxTask> tasks;
+    unordered_map<string, size_t> task_index;
+
+    // Jobs are described before the dependencies, as the DAX schema requires
+    for (const auto & element : *adag)
+    {
+        if (element.first == "job")
+        {
+            DaxTask task;
+            task.id = element.second.get<string>("<xmlattr>.id", "");
+            xbt_assert(!task.id.empty(), "Invalid DAX file '%s': one job has no 'id' attribute", filename.c_str());
+            xbt_assert(task_index.count(task.id) == 0, "Invalid DAX file '%s': duplication of job id '%s'",
+                       filename.c_str(), task.id.c_str());
+
+            task.runtime = element.second.get<double>("<xmlattr>.runtime", -1);
+            xbt_assert(task.runtime >= 0, "Invalid DAX file '%s': job '%s' has no valid 'runtime' attribute",
+                       filename.c_str(), task.id.c_str());
+
+            task_index[task.id] = tasks.size();
+            tasks.push_back(std::move(task));
+        }
+        else if (element.first == "child")
+        {
+            const string child_id = element.second.get<string>("<xmlattr>.ref", "");
+            auto child_it = task_index.find(child_id);
+            xbt_assert(child_it != task_index.end(), "Invalid DAX file '%s': dependencies are given for unknown job '%s'",
+                       filename.c_str(), child_id.c_str());
+
+            DaxTask & child = tasks[child_it->second];
+            for (const auto & parent : element.second)
+            {
+                if (parent.first == "parent")
+                {
+                    const string parent_id = parent.second.get<string>("<xmlattr>.ref", "");
+                    xbt_assert(task_index.count(parent_id) == 1, "Invalid DAX file '%s': job '%s' depends on unknown job '%s'",
+                               filename.c_str(), child_id.c_str(), parent_id.c_str());
+                    child.parents.push_back(parent_id);
+                }
+            }
+        }
+    }
+
+    XBT_INFO("Read %zu jobs from DAX file '%s'.", tasks.size(), filename.c_str());
+    return tasks;
+}
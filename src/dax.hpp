@@ -0,0 +1,27 @@
+/**
+ * @file dax.hpp
+ * @brief Reading of workflows in the DAX format of the Pegasus workflow management system
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief A task read from a DAX file
+ */
+struct DaxTask
+{
+    std::string id;                     //!< The identifier of the task in the DAX file
+    double runtime;                     //!< How long the task runs, in seconds
+    std::vector<std::string> parents;   //!< The identifiers of the tasks that must complete before this task can start
+};
+
+/**
+ * @brief Reads the tasks of a DAX file and the dependencies between them
+ * @details The file fragments that describe files and transfers are ignored.
+ * @param[in] filename The name of the DAX file
+ * @return The tasks of the workflow, in the order of the file
+ */
+std::vector<DaxTask> read_dax(const std::string & filename);
@@ -7,24 +7,37 @@
 #include "export.hpp"
 
 #include <algorithm>
+#include <cctype>
 #include <filesystem>
 #include <fstream>
 #include <random>
 
 #include <boost/algorithm/string/join.hpp>
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <xbt.h>
 #include <math.h>
 #include <float.h>
 
+#ifdef BATSIM_WITH_ZLIB
+#include <zlib.h>
+#endif
+
 #include "context.hpp"
+#include "internal_tracing.hpp"
+#include "ipp.hpp"
 #include "jobs.hpp"
 
 using namespace std;
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(export, "export"); //!< Logging
 
+static string quantile_sketch_to_json(const QuantileSketch & sketch);
+
 /**
  * @brief Get the peak memory usage of the current process from /proc/self/status
  * @return (VmPeak, VmHWM). First value is about the peak number of pages in the process address space, second value on the peak number of pages really used in memory.
@@ -78,6 +91,58 @@ static void write_real_execution_info(BatsimContext * context)
     long double seconds_spent_in_the_whole_simulation = diff.count();
     output_map["time_in_simu_seconds"] = to_string(static_cast<double>(seconds_spent_in_the_whole_simulation));
 
+    // execution time breakdown
+    for (const auto & mit : context->seconds_used_by_phase)
+    {
+        output_map["time_phase_"s + mit.first + "_seconds"s] = to_string(static_cast<double>(mit.second));
+    }
+
+    long double seconds_spent_in_serialization = context->microseconds_used_by_serialization / 1e6l;
+    long double seconds_spent_in_deserialization = context->microseconds_used_by_deserialization / 1e6l;
+    output_map["time_in_serialization_seconds"] = to_string(static_cast<double>(seconds_spent_in_serialization));
+    output_map["time_in_deserialization_seconds"] = to_string(static_cast<double>(seconds_spent_in_deserialization));
+
+    // the time measured around EDC calls includes the parsing of their replies
+    long double seconds_spent_in_edc_only = std::max(0.0l, seconds_spent_in_edc - seconds_spent_in_deserialization);
+    output_map["time_in_edc_only_seconds"] = to_string(static_cast<double>(seconds_spent_in_edc_only));
+
+    // EDC interactions
+    output_map["nb_edc_calls"] = to_string(context->nb_edc_calls);
+    output_map["edc_call_latency_us"] = quantile_sketch_to_json(context->edc_call_latency_us);
+    output_map["nb_bytes_sent_to_edc"] = to_string(context->nb_bytes_sent_to_edc);
+    output_map["nb_bytes_received_from_edc"] = to_string(context->nb_bytes_received_from_edc);
+    output_map["nb_events_received_from_edc"] = to_string(context->nb_events_received_from_edc);
+
+    // simulation throughput
+    output_map["nb_server_messages_handled"] = to_string(context->nb_server_messages_handled);
+    long double seconds_spent_in_simulation_loop = context->seconds_used_by_phase["simulation_loop"];
+    double events_per_second = 0;
+    if (seconds_spent_in_simulation_loop > 0)
+    {
+        events_per_second = static_cast<double>(context->nb_server_messages_handled / seconds_spent_in_simulation_loop);
+    }
+    output_map["events_per_second"] = to_string(events_per_second);
+
+    // parallel task matrix cache
+    output_map["nb_ptask_matrix_cache_hits"] = to_string(context->ptask_matrix_cache.nb_hits());
+    output_map["nb_ptask_matrix_cache_misses"] = to_string(context->ptask_matrix_cache.nb_misses());
+    output_map["nb_ptask_matrix_cache_evictions"] = to_string(context->ptask_matrix_cache.nb_evictions());
+
+    // sequence fast-forward
+    output_map["nb_fast_forwarded_repetitions"] = to_string(context->nb_fast_forwarded_repetitions.load());
+
+    // object counts
+    output_map["nb_jobs_created"] = to_string(InstanceCounter<Job>::nb_created.load());
+    output_map["nb_jobs_alive"] = to_string(InstanceCounter<Job>::nb_alive.load());
+    output_map["max_nb_jobs_alive"] = to_string(InstanceCounter<Job>::max_nb_alive.load());
+    output_map["nb_profiles_created"] = to_string(InstanceCounter<Profile>::nb_created.load());
+    output_map["nb_profiles_alive"] = to_string(InstanceCounter<Profile>::nb_alive.load());
+    output_map["max_nb_profiles_alive"] = to_string(InstanceCounter<Profile>::max_nb_alive.load());
+    output_map["nb_deduplicated_profiles"] = to_string(deduplicated_profiles_count());
+    output_map["nb_ip_messages_created"] = to_string(InstanceCounter<IPMessage>::nb_created.load());
+    output_map["nb_ip_messages_alive"] = to_string(InstanceCounter<IPMessage>::nb_alive.load());
+    output_map["max_nb_ip_messages_alive"] = to_string(InstanceCounter<IPMessage>::max_nb_alive.load());
+
     // prepare writing to the file
     vector<string> values;
     for (const auto & mit : output_map) {
@@ -129,13 +194,14 @@ void prepare_batsim_outputs(BatsimContext * context)
     if (context->trace_machine_states)
     {
         context->machine_state_tracer.set_context(context);
-        context->machine_state_tracer.set_filename(export_prefix_path.string() + "machine_states.csv");
+        context->machine_state_tracer.set_tracing_mode(context->machine_state_tracing_mode, context->machine_state_sampling_period);
+        context->machine_state_tracer.set_filename(export_prefix_path.string() + "machine_states.csv", context->output_buffer_options);
     }
 
     if (context->trace_pstate_changes)
     {
         // Power state tracing
-        context->pstate_tracer.set_filename(export_prefix_path.string() + "pstate_changes.csv");
+        context->pstate_tracer.set_filename(export_prefix_path.string() + "pstate_changes.csv", context->output_buffer_options);
 
         // Trace the initial Pstate values
         std::map<int, IntervalSet> pstate_to_machine_set;
@@ -164,11 +230,17 @@ void prepare_batsim_outputs(BatsimContext * context)
         }
     }
 
+    if (context->probe_tracing_strategy == ProbeTracingStrategy::ALWAYS)
+    {
+        // Probe data files are created when probes first emit data
+        context->probe_data_tracer.set_prefix(export_prefix_path.string(), context->output_buffer_options);
+    }
+
     if (context->energy_used)
     {
         // Energy consumption tracing
         context->energy_tracer.set_context(context);
-        context->energy_tracer.set_filename(export_prefix_path.string() + "consumed_energy.csv");
+        context->energy_tracer.set_filename(export_prefix_path.string() + "consumed_energy.csv", context->output_buffer_options);
     }
 
     context->jobs_tracer.initialize(context,
@@ -178,99 +250,326 @@ void prepare_batsim_outputs(BatsimContext * context)
 
 void finalize_batsim_outputs(BatsimContext * context)
 {
+    BATSIM_TRACE_SPAN("output", "finalize_batsim_outputs");
+
     // Let's say the simulation is ended now
     context->simulation_end_time = chrono::high_resolution_clock::now();
 
     if (context->trace_machine_states)
     {
+        BATSIM_TRACE_SPAN("output", "flush_machine_states");
         context->machine_state_tracer.flush();
         context->machine_state_tracer.close_buffer();
     }
 
     if (context->trace_pstate_changes)
     {
+        BATSIM_TRACE_SPAN("output", "flush_pstate_changes");
         context->pstate_tracer.flush();
         context->pstate_tracer.close_buffer();
     }
 
+    if (context->probe_tracing_strategy == ProbeTracingStrategy::ALWAYS)
+    {
+        BATSIM_TRACE_SPAN("output", "flush_probe_data");
+        context->probe_data_tracer.close_buffers();
+    }
+
     // Energy-related output
     if (context->energy_used)
     {
+        BATSIM_TRACE_SPAN("output", "flush_consumed_energy");
         context->energy_tracer.flush();
         context->energy_tracer.close_buffer();
     }
 
     // Finalize the jobs output file
-    context->jobs_tracer.finalize();
+    {
+        BATSIM_TRACE_SPAN("output", "flush_jobs");
+        context->jobs_tracer.finalize();
+    }
 
-    // Write information on the real execution
+    // Write information on the real execution, including the time spent writing the other outputs
+    chrono::duration<long double> output_time = chrono::high_resolution_clock::now() - context->simulation_end_time;
+    context->seconds_used_by_phase["output"] += output_time.count();
     write_real_execution_info(context);
 }
 
+string json_escape(const string & str)
+{
+    string escaped;
+    escaped.reserve(str.size());
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped.push_back('\\');
+            escaped.push_back(c);
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            escaped.push_back(' ');
+        }
+        else
+        {
+            escaped.push_back(c);
+        }
+    }
+    return escaped;
+}
+
 
 WriteBuffer::WriteBuffer(const std::string & filename, size_t buffer_size)
-    : buffer_size(buffer_size)
+    : WriteBuffer(filename, WriteBufferOptions{buffer_size, 1, OutputCompression::NONE})
 {
-    xbt_assert(buffer_size > 0, "Invalid buffer size (%zu)", buffer_size);
-    buffer = new char[buffer_size];
-
-    f.open(filename, ios_base::trunc);
-    xbt_assert(f.is_open(), "Cannot write file '%s'", filename.c_str());
 }
 
-WriteBuffer::~WriteBuffer()
+WriteBuffer::WriteBuffer(const std::string & filename, const WriteBufferOptions & options)
+    : _filename(filename), _options(options)
 {
-    if (buffer_pos > 0)
+    xbt_assert(_options.buffer_size > 0, "Invalid buffer size (%zu)", _options.buffer_size);
+    xbt_assert(_options.nb_buffers > 0, "Invalid number of buffers (%u)", _options.nb_buffers);
+
+    if (_options.compression == OutputCompression::GZIP)
+    {
+#ifdef BATSIM_WITH_ZLIB
+        _filename += ".gz";
+        z_stream * zs = new z_stream;
+        memset(zs, 0, sizeof(z_stream));
+        // 15+16 window bits: maximum window with a gzip header and trailer
+        int ret = deflateInit2(zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        xbt_assert(ret == Z_OK, "Cannot initialize gzip compression of file '%s' (zlib error %d)", _filename.c_str(), ret);
+        _zstream = zs;
+        _zbuffer.resize(_options.buffer_size + 1024);
+#else
+        xbt_die("Cannot compress file '%s' with gzip: Batsim has been built without zlib", filename.c_str());
+#endif
+    }
+
+    _fd = ::open(_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    xbt_assert(_fd != -1, "Cannot write file '%s': %s", _filename.c_str(), strerror(errno));
+
+    _buffers.resize(_options.nb_buffers);
+    for (unsigned int i = 0; i < _options.nb_buffers; ++i)
+    {
+        _buffers[i] = new char[_options.buffer_size];
+    }
+
+    buffer = _buffers[0];
+    for (unsigned int i = 1; i < _options.nb_buffers; ++i)
     {
-        flush_buffer();
+        _free_buffers.push_back(_buffers[i]);
     }
 
-    if (buffer != nullptr)
+    if (_options.nb_buffers > 1)
     {
-        delete[] buffer;
-        buffer = nullptr;
+        _writer_thread = std::thread(&WriteBuffer::writer_thread_main, this);
+    }
+}
+
+WriteBuffer::~WriteBuffer()
+{
+    close();
 
-        f.close();
+    for (char * buf : _buffers)
+    {
+        delete[] buf;
     }
+    _buffers.clear();
+    buffer = nullptr;
 }
 
 void WriteBuffer::append_text(const char * text)
 {
-    const size_t text_length = strlen(text);
+    append_text(text, strlen(text));
+}
 
-    // Is the buffer big enough?
-    if (buffer_pos + text_length < buffer_size)
+void WriteBuffer::append_text(const char * text, size_t text_length)
+{
+    xbt_assert(!_closed, "Cannot append text into file '%s': it has already been closed", _filename.c_str());
+
+    // Fast path: the text fits in the current buffer
+    if (buffer_pos + text_length <= _options.buffer_size)
     {
-        // Append the text into the buffer
         memcpy(buffer + buffer_pos, text, text_length * sizeof(char));
         buffer_pos += text_length;
+        return;
     }
-    else
-    {
-        // Write the current buffer content in the file
-        flush_buffer();
 
-        // Does the text fit in the (now empty) buffer?
-        if (text_length < buffer_size)
+    // Otherwise, fill buffers one after the other
+    while (text_length > 0)
+    {
+        if (buffer_pos == _options.buffer_size)
         {
-            // Copy the text into the buffer
-            memcpy(buffer, text, text_length * sizeof(char));
-            buffer_pos = text_length;
+            submit_current_buffer();
         }
-        else
+
+        const size_t nb_to_copy = std::min(text_length, _options.buffer_size - buffer_pos);
+        memcpy(buffer + buffer_pos, text, nb_to_copy * sizeof(char));
+        buffer_pos += nb_to_copy;
+        text += nb_to_copy;
+        text_length -= nb_to_copy;
+    }
+}
+
+void WriteBuffer::flush_buffer()
+{
+    if (buffer_pos > 0)
+    {
+        submit_current_buffer();
+    }
+}
+
+void WriteBuffer::close()
+{
+    if (_closed)
+    {
+        return;
+    }
+
+    flush_buffer();
+
+    if (_writer_thread.joinable())
+    {
         {
-            // Directly write the text into the file
-            f.write(text, static_cast<std::streamsize>(text_length));
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop_writer = true;
         }
+        _cv.notify_all();
+        _writer_thread.join();
     }
+
+    finish_file();
+    _closed = true;
 }
 
-void WriteBuffer::flush_buffer()
+const std::string & WriteBuffer::filename() const
 {
-    f.write(buffer, static_cast<std::streamsize>(buffer_pos));
+    return _filename;
+}
+
+void WriteBuffer::submit_current_buffer()
+{
+    if (!_writer_thread.joinable())
+    {
+        // Synchronous mode: the caller thread writes the buffer itself
+        write_chunk(buffer, buffer_pos);
+        buffer_pos = 0;
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _pending_buffers.push_back({buffer, buffer_pos});
+    _cv.notify_all();
+
+    // Only blocks if all buffers are waiting to be written
+    _cv.wait(lock, [this]{ return !_free_buffers.empty(); });
+    buffer = _free_buffers.front();
+    _free_buffers.pop_front();
     buffer_pos = 0;
 }
 
+void WriteBuffer::writer_thread_main()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;)
+    {
+        _cv.wait(lock, [this]{ return _stop_writer || !_pending_buffers.empty(); });
+        if (_pending_buffers.empty())
+        {
+            // _stop_writer is set and everything has been written
+            return;
+        }
+
+        PendingBuffer pending = _pending_buffers.front();
+        _pending_buffers.pop_front();
+
+        lock.unlock();
+        write_chunk(pending.data, pending.size);
+        lock.lock();
+
+        _free_buffers.push_back(pending.data);
+        _cv.notify_all();
+    }
+}
+
+void WriteBuffer::write_chunk(const char * data, size_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+#ifdef BATSIM_WITH_ZLIB
+    if (_zstream != nullptr)
+    {
+        z_stream * zs = static_cast<z_stream*>(_zstream);
+        zs->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        zs->avail_in = static_cast<uInt>(size);
+        do
+        {
+            zs->next_out = reinterpret_cast<Bytef*>(_zbuffer.data());
+            zs->avail_out = static_cast<uInt>(_zbuffer.size());
+            int ret = deflate(zs, Z_NO_FLUSH);
+            xbt_assert(ret != Z_STREAM_ERROR, "Compression error while writing file '%s'", _filename.c_str());
+            write_raw(_zbuffer.data(), _zbuffer.size() - zs->avail_out);
+        } while (zs->avail_out == 0);
+        return;
+    }
+#endif
+
+    write_raw(data, size);
+}
+
+void WriteBuffer::write_raw(const char * data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t nb_written = ::write(_fd, data, size);
+        if (nb_written == -1)
+        {
+            xbt_assert(errno == EINTR, "Cannot write file '%s': %s", _filename.c_str(), strerror(errno));
+            continue;
+        }
+
+        data += nb_written;
+        size -= static_cast<size_t>(nb_written);
+    }
+}
+
+void WriteBuffer::finish_file()
+{
+#ifdef BATSIM_WITH_ZLIB
+    if (_zstream != nullptr)
+    {
+        z_stream * zs = static_cast<z_stream*>(_zstream);
+        zs->next_in = nullptr;
+        zs->avail_in = 0;
+        int ret;
+        do
+        {
+            zs->next_out = reinterpret_cast<Bytef*>(_zbuffer.data());
+            zs->avail_out = static_cast<uInt>(_zbuffer.size());
+            ret = deflate(zs, Z_FINISH);
+            xbt_assert(ret != Z_STREAM_ERROR, "Compression error while finishing file '%s'", _filename.c_str());
+            write_raw(_zbuffer.data(), _zbuffer.size() - zs->avail_out);
+        } while (ret != Z_STREAM_END);
+
+        deflateEnd(zs);
+        delete zs;
+        _zstream = nullptr;
+    }
+#endif
+
+    // Make sure the data reached the disk, as this may be the last thing Batsim does before aborting
+    if (fsync(_fd) != 0)
+    {
+        XBT_WARN("Cannot synchronize file '%s' on disk: %s", _filename.c_str(), strerror(errno));
+    }
+    ::close(_fd);
+    _fd = -1;
+}
+
 
 /* Part related to PStateChangeTracer */
 
@@ -281,10 +580,10 @@ PStateChangeTracer::PStateChangeTracer()
     xbt_assert(_temporary_buffer != NULL, "Couldn't allocate memory");
 }
 
-void PStateChangeTracer::set_filename(const string &filename)
+void PStateChangeTracer::set_filename(const string &filename, const WriteBufferOptions & options)
 {
     xbt_assert(_wbuf == nullptr, "Double call of PStateChangeTracer::set_filename");
-    _wbuf = new WriteBuffer(filename);
+    _wbuf = new WriteBuffer(filename, options);
 
     _wbuf->append_text("time,machine_id,new_pstate\n");
 }
@@ -358,10 +657,10 @@ void EnergyConsumptionTracer::set_context(BatsimContext *context)
     _context = context;
 }
 
-void EnergyConsumptionTracer::set_filename(const string &filename)
+void EnergyConsumptionTracer::set_filename(const string &filename, const WriteBufferOptions & options)
 {
     xbt_assert(_wbuf == nullptr, "Double call of EnergyConsumptionTracer::set_filename");
-    _wbuf = new WriteBuffer(filename);
+    _wbuf = new WriteBuffer(filename, options);
 
     _wbuf->append_text("time,energy,event_type,wattmin,epower\n");
 }
@@ -464,10 +763,18 @@ void MachineStateTracer::set_context(BatsimContext *context)
     _context = context;
 }
 
-void MachineStateTracer::set_filename(const string &filename)
+void MachineStateTracer::set_tracing_mode(MachineStateTracingMode mode, double sampling_period)
+{
+    xbt_assert(_wbuf == nullptr, "MachineStateTracer::set_tracing_mode must be called before MachineStateTracer::set_filename");
+    xbt_assert(sampling_period > 0, "Invalid machine state sampling period (%g): must be strictly positive", sampling_period);
+    _mode = mode;
+    _sampling_period = sampling_period;
+}
+
+void MachineStateTracer::set_filename(const string &filename, const WriteBufferOptions & options)
 {
     xbt_assert(_wbuf == nullptr, "Double call of MachineStateTracer::set_filename");
-    _wbuf = new WriteBuffer(filename);
+    _wbuf = new WriteBuffer(filename, options);
 
     vector<string> header_substrings;
     const vector<MachineState> machine_states = {MachineState::SLEEPING,
@@ -484,35 +791,147 @@ void MachineStateTracer::set_filename(const string &filename)
 
     _wbuf->append_text(header.c_str());
     _wbuf->flush_buffer();
+
+    if (_mode == MachineStateTracingMode::SAMPLED)
+    {
+        // Samples start with the initial machine states
+        xbt_assert(_context != nullptr, "wrong call: _context is null");
+        _last_date = simgrid::s4u::Engine::get_clock();
+        _sampling_origin = _last_date;
+        _sample_index = 0;
+        read_machine_states(_last_counts);
+    }
 }
 
-void MachineStateTracer::write_machine_states(double date)
+void MachineStateTracer::read_machine_states(int counts[NB_STATES]) const
 {
-    xbt_assert(_context != nullptr, "wrong call: _context is null");
-    xbt_assert(_wbuf != nullptr, "wrong call: _wbuf is null");
-
     const std::map<MachineState, int> & numbers = _context->machines.nb_machines_in_each_state();
+    counts[0] = numbers.at(MachineState::SLEEPING);
+    counts[1] = numbers.at(MachineState::TRANSITING_FROM_SLEEPING_TO_COMPUTING);
+    counts[2] = numbers.at(MachineState::TRANSITING_FROM_COMPUTING_TO_SLEEPING);
+    counts[3] = numbers.at(MachineState::IDLE);
+    counts[4] = numbers.at(MachineState::COMPUTING);
+}
 
+void MachineStateTracer::write_line(double date, const int counts[NB_STATES])
+{
     const int buf_size = 256;
-    int nb_printed;
-    (void) nb_printed; // Avoids a warning if assertions are ignored
-    char * buf = static_cast<char*>(malloc(sizeof(char) * buf_size));
-    xbt_assert(buf != NULL, "Couldn't allocate memory");
+    char buf[buf_size];
+    int nb_printed = snprintf(buf, buf_size, "%g,%d,%d,%d,%d,%d\n",
+                              date, counts[0], counts[1], counts[2], counts[3], counts[4]);
+    xbt_assert(nb_printed > 0 && nb_printed < buf_size - 1,
+               "Writing error: buffer has been completely filled, some information might "
+               "have been lost. Please increase Batsim's output temporary buffers' size");
+    _wbuf->append_text(buf, static_cast<size_t>(nb_printed));
+}
 
-    nb_printed = snprintf(buf, buf_size, "%g,%d,%d,%d,%d,%d\n",
-                          date,
-                          numbers.at(MachineState::SLEEPING),
-                          numbers.at(MachineState::TRANSITING_FROM_SLEEPING_TO_COMPUTING),
-                          numbers.at(MachineState::TRANSITING_FROM_COMPUTING_TO_SLEEPING),
-                          numbers.at(MachineState::IDLE),
-                          numbers.at(MachineState::COMPUTING));
-    xbt_assert(nb_printed < buf_size - 1,
+void MachineStateTracer::write_line(double date, const double values[NB_STATES])
+{
+    const int buf_size = 256;
+    char buf[buf_size];
+    int nb_printed = snprintf(buf, buf_size, "%g,%g,%g,%g,%g,%g\n",
+                              date, values[0], values[1], values[2], values[3], values[4]);
+    xbt_assert(nb_printed > 0 && nb_printed < buf_size - 1,
                "Writing error: buffer has been completely filled, some information might "
                "have been lost. Please increase Batsim's output temporary buffers' size");
+    _wbuf->append_text(buf, static_cast<size_t>(nb_printed));
+}
+
+void MachineStateTracer::write_machine_states(double date)
+{
+    xbt_assert(_context != nullptr, "wrong call: _context is null");
     xbt_assert(_wbuf != nullptr, "wrong call: _wbuf is null");
-    _wbuf->append_text(buf);
 
-    free(buf);
+    switch (_mode)
+    {
+    case MachineStateTracingMode::EVERY_CHANGE:
+    {
+        int counts[NB_STATES];
+        read_machine_states(counts);
+        write_line(date, counts);
+    } break;
+    case MachineStateTracingMode::COALESCE:
+    {
+        // Only the last states of a given timestamp are written, once the simulation moved forward
+        if (_has_pending_line && date != _last_date)
+        {
+            write_line(_last_date, _last_counts);
+        }
+        _has_pending_line = true;
+        _last_date = date;
+        read_machine_states(_last_counts);
+    } break;
+    case MachineStateTracingMode::SAMPLED:
+    {
+        accumulate_samples_until(date);
+        read_machine_states(_last_counts);
+    } break;
+    }
+}
+
+void MachineStateTracer::accumulate_samples_until(double date)
+{
+    // Sample boundaries are computed from the origin rather than accumulated, so that they do not drift
+    double sample_end = _sampling_origin + (_sample_index + 1) * _sampling_period;
+    while (date >= sample_end)
+    {
+        // The current sample is complete: write its time-weighted average
+        double averages[NB_STATES];
+        for (int i = 0; i < NB_STATES; ++i)
+        {
+            _sample_accumulator[i] += _last_counts[i] * (sample_end - _last_date);
+            averages[i] = _sample_accumulator[i] / _sampling_period;
+            _sample_accumulator[i] = 0;
+        }
+        write_line(_sampling_origin + _sample_index * _sampling_period, averages);
+
+        _last_date = sample_end;
+        ++_sample_index;
+        sample_end = _sampling_origin + (_sample_index + 1) * _sampling_period;
+    }
+
+    for (int i = 0; i < NB_STATES; ++i)
+    {
+        _sample_accumulator[i] += _last_counts[i] * (date - _last_date);
+    }
+    _last_date = date;
+}
+
+void MachineStateTracer::write_pending_states(double date)
+{
+    switch (_mode)
+    {
+    case MachineStateTracingMode::EVERY_CHANGE:
+        break;
+    case MachineStateTracingMode::COALESCE:
+    {
+        if (_has_pending_line)
+        {
+            write_line(_last_date, _last_counts);
+            _has_pending_line = false;
+        }
+    } break;
+    case MachineStateTracingMode::SAMPLED:
+    {
+        accumulate_samples_until(date);
+
+        // The last sample is incomplete: average it over its real duration
+        const double sample_start = _sampling_origin + _sample_index * _sampling_period;
+        const double duration = date - sample_start;
+        if (duration > 0)
+        {
+            double averages[NB_STATES];
+            for (int i = 0; i < NB_STATES; ++i)
+            {
+                averages[i] = _sample_accumulator[i] / duration;
+                _sample_accumulator[i] = 0;
+            }
+            write_line(sample_start, averages);
+        }
+        _sampling_origin = date;
+        _sample_index = 0;
+    } break;
+    }
 }
 
 void MachineStateTracer::flush()
@@ -526,10 +945,174 @@ void MachineStateTracer::close_buffer()
 {
     xbt_assert(_wbuf != nullptr, "wrong call: _wbuf is null");
 
+    write_pending_states(simgrid::s4u::Engine::get_clock());
+
     delete _wbuf;
     _wbuf = nullptr;
 }
 
+/* Part related to ProbeDataTracer */
+
+//! The first bytes of probe data files
+static const char PROBE_DATA_MAGIC[8] = {'B', 'A', 'T', 'P', 'R', 'O', 'B', 'E'};
+//! The version of the format of probe data files
+static const uint8_t PROBE_DATA_FORMAT_VERSION = 1;
+//! The type of the values of probe data files (1: float64)
+static const uint8_t PROBE_DATA_VALUE_TYPE_FLOAT64 = 1;
+
+/**
+ * @brief Appends an unsigned integer in little-endian order
+ * @param[in,out] out The buffer
+ * @param[in] value The integer
+ * @param[in] nb_bytes The number of bytes of the integer
+ */
+static void append_little_endian(vector<char> & out, uint64_t value, int nb_bytes)
+{
+    for (int i = 0; i < nb_bytes; ++i)
+    {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+/**
+ * @brief Appends an unsigned integer as a LEB128 varint (7 bits per byte, least significant group first)
+ * @param[in,out] out The buffer
+ * @param[in] value The integer
+ */
+static void append_varint(vector<char> & out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+/**
+ * @brief Appends a string preceded by its length (uint32)
+ * @param[in,out] out The buffer
+ * @param[in] str The string
+ */
+static void append_sized_string(vector<char> & out, const string & str)
+{
+    append_little_endian(out, str.size(), 4);
+    out.insert(out.end(), str.begin(), str.end());
+}
+
+ProbeDataTracer::~ProbeDataTracer()
+{
+    close_buffers();
+}
+
+void ProbeDataTracer::set_prefix(const string & prefix, const WriteBufferOptions & options)
+{
+    _prefix = prefix;
+    _options = options;
+}
+
+void ProbeDataTracer::add_probe_data(double date, const ProbeData & probe_data)
+{
+    const bool is_vectorial = probe_data.data_type == batprotocol::fb::ProbeData_VectorialProbeData;
+    const uint32_t nb_values = is_vectorial ? static_cast<uint32_t>(probe_data.vectorial_data.size()) : 1;
+
+    auto it = _series.find(probe_data.metadata->probe_id);
+    ProbeSeries & series = (it != _series.end()) ? it->second : create_series(probe_data, nb_values);
+    xbt_assert(series.nb_values == nb_values,
+               "Cannot trace data of probe '%s': it emitted %u values while its previous emissions had %u values",
+               probe_data.metadata->probe_id.c_str(), nb_values, series.nb_values);
+
+    const int64_t date_us = llround(date * 1e6);
+    xbt_assert(date_us >= series.last_date_us, "Cannot trace data of probe '%s': time went backwards", probe_data.metadata->probe_id.c_str());
+
+    _record.clear();
+    append_varint(_record, static_cast<uint64_t>(date_us - series.last_date_us));
+    series.last_date_us = date_us;
+
+    const double * values = is_vectorial ? probe_data.vectorial_data.data() : &probe_data.aggregated_data;
+    for (uint32_t i = 0; i < nb_values; ++i)
+    {
+        uint64_t bits;
+        memcpy(&bits, &values[i], sizeof(bits));
+        append_little_endian(_record, bits, 8);
+    }
+
+    series.wbuf->append_text(_record.data(), _record.size());
+}
+
+ProbeDataTracer::ProbeSeries & ProbeDataTracer::create_series(const ProbeData & probe_data, uint32_t nb_values)
+{
+    xbt_assert(!_prefix.empty(), "wrong call: ProbeDataTracer::set_prefix has not been called");
+    const ProbeMetadata & metadata = *probe_data.metadata;
+
+    // Probe identifiers are chosen by EDCs: only keep the characters that are safe in filenames
+    string safe_id = metadata.probe_id;
+    for (char & c : safe_id)
+    {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.')
+        {
+            c = '_';
+        }
+    }
+
+    // Different identifiers can have the same safe characters, and identifiers can be reused once their probe stopped
+    string filename = _prefix + "probe_" + safe_id + ".bin";
+    for (unsigned int n = 1; _used_filenames.count(filename) == 1; ++n)
+    {
+        filename = _prefix + "probe_" + safe_id + "_" + std::to_string(n) + ".bin";
+    }
+    _used_filenames.insert(filename);
+
+    ProbeSeries & series = _series[metadata.probe_id];
+    series.wbuf = new WriteBuffer(filename, _options);
+    series.nb_values = nb_values;
+
+    string resources;
+    if (metadata.resource_type == batprotocol::fb::Resources_HostResources)
+    {
+        resources = metadata.hosts_str;
+    }
+    else if (metadata.links != nullptr)
+    {
+        resources = boost::algorithm::join(*metadata.links, " ");
+    }
+
+    _record.clear();
+    _record.insert(_record.end(), PROBE_DATA_MAGIC, PROBE_DATA_MAGIC + sizeof(PROBE_DATA_MAGIC));
+    _record.push_back(static_cast<char>(PROBE_DATA_FORMAT_VERSION));
+    _record.push_back(static_cast<char>(PROBE_DATA_VALUE_TYPE_FLOAT64));
+    _record.push_back(static_cast<char>(probe_data.data_type == batprotocol::fb::ProbeData_VectorialProbeData));
+    _record.push_back(static_cast<char>(metadata.metrics));
+    _record.push_back(static_cast<char>(metadata.resource_type));
+    append_little_endian(_record, nb_values, 4);
+    append_sized_string(_record, metadata.probe_id);
+    append_sized_string(_record, resources);
+    series.wbuf->append_text(_record.data(), _record.size());
+
+    XBT_INFO("Tracing data of probe '%s' into '%s'", metadata.probe_id.c_str(), series.wbuf->filename().c_str());
+    return series;
+}
+
+void ProbeDataTracer::close_series(const string & probe_id)
+{
+    auto it = _series.find(probe_id);
+    if (it != _series.end())
+    {
+        delete it->second.wbuf;
+        _series.erase(it);
+    }
+}
+
+void ProbeDataTracer::close_buffers()
+{
+    for (auto & [_, series] : _series)
+    {
+        delete series.wbuf;
+        series.wbuf = nullptr;
+    }
+    _series.clear();
+}
+
 /* Part related to JobsTracer */
 
 JobsTracer::~JobsTracer()
@@ -541,14 +1124,93 @@ JobsTracer::~JobsTracer()
     }
 }
 
+/**
+ * @brief Computes the size class of a job, so that jobs of similar sizes can be aggregated
+ * @param[in] requested_nb_res The number of resources requested by the job
+ * @return k so that the job requested a number of resources in ]2^(k-1), 2^k] (0 for jobs that requested at most one resource)
+ */
+static int job_size_class(int requested_nb_res)
+{
+    int size_class = 0;
+    while (size_class < 31 && (1 << size_class) < requested_nb_res)
+    {
+        ++size_class;
+    }
+    return size_class;
+}
+
+/**
+ * @brief Generates the name of a job size class
+ * @param[in] size_class The job size class (see job_size_class)
+ * @return The range of number of resources of the size class (e.g., "1", "2", "3-4", "5-8"...)
+ */
+static string job_size_class_name(int size_class)
+{
+    if (size_class <= 1)
+    {
+        return to_string(1 << size_class);
+    }
+    return to_string((1 << (size_class - 1)) + 1) + "-" + to_string(1 << size_class);
+}
+
+/**
+ * @brief Generates a JSON object that summarizes a distribution
+ * @param[in] sketch The distribution
+ * @return The JSON object, as a string
+ */
+static string quantile_sketch_to_json(const QuantileSketch & sketch)
+{
+    vector<string> bins;
+    for (const auto & bin : sketch.log2_histogram())
+    {
+        bins.push_back("["s + to_string(bin.first) + ", "s + to_string(bin.second) + "]"s);
+    }
+
+    return "{\"min\": "s + to_string(sketch.min()) +
+        ", \"p50\": "s + to_string(sketch.quantile(0.5)) +
+        ", \"p95\": "s + to_string(sketch.quantile(0.95)) +
+        ", \"p99\": "s + to_string(sketch.quantile(0.99)) +
+        ", \"max\": "s + to_string(sketch.max()) +
+        ", \"log2_histogram\": ["s + boost::algorithm::join(bins, ", ") + "]}"s;
+}
+
+/**
+ * @brief Generates a JSON object that summarizes the metrics distributions of a set of jobs
+ * @param[in] distributions The distributions
+ * @param[in] indent The indentation of the generated object's fields
+ * @return The JSON object, as a string
+ */
+static string job_metrics_distributions_to_json(const JobMetricsDistributions & distributions, const string & indent)
+{
+    return "{\n"s +
+        indent + "\"nb_jobs\": "s + to_string(distributions.waiting_time.count()) + ",\n"s +
+        indent + "\"slowdown\": "s + quantile_sketch_to_json(distributions.slowdown) + ",\n"s +
+        indent + "\"turnaround_time\": "s + quantile_sketch_to_json(distributions.turnaround_time) + ",\n"s +
+        indent + "\"waiting_time\": "s + quantile_sketch_to_json(distributions.waiting_time) + "\n"s +
+        indent.substr(2) + "}"s;
+}
+
 void JobsTracer::initialize(BatsimContext *context,
                        const string & jobs_filename,
                        const string & schedule_filename)
 {
     xbt_assert(_wbuf == nullptr, "Double call of JobsTracer::initialize");
-    _wbuf = new WriteBuffer(jobs_filename);
     _context = context;
     _schedule_filename = schedule_filename;
+    _metrics_only = context->metrics_only;
+
+    // Prepare for schedule output file
+    for (int i = 0; i < static_cast<int>(context->machines.nb_machines()); ++i)
+    {
+        _machines_utilization[i] = 0;
+    }
+
+    if (_metrics_only)
+    {
+        return;
+    }
+
+    _wbuf = new WriteBuffer(jobs_filename, context->output_buffer_options);
 
     // Prepare for jobs output file
     _job_keys = {
@@ -574,19 +1236,16 @@ void JobsTracer::initialize(BatsimContext *context,
     _row_content.reserve(_job_keys.size());
     _wbuf->append_text(header.c_str());
     _wbuf->flush_buffer();
-
-    // Prepare for schedule output file
-    for (int i = 0; i < static_cast<int>(context->machines.nb_machines()); ++i)
-    {
-        _machines_utilization[i] = 0;
-    }
 }
 
 void JobsTracer::finalize()
 {
     // Finalize jobs output file
-    flush();
-    close_buffer();
+    if (!_metrics_only)
+    {
+        flush();
+        close_buffer();
+    }
 
     // Write the schedule output file
     ofstream f(_schedule_filename, ios_base::trunc);
@@ -611,13 +1270,18 @@ void JobsTracer::finalize()
     double mean_turnaround_time = static_cast<double>(_sum_turnaround_time)/_nb_jobs;
     double mean_slowdown = static_cast<double>(_sum_slowdown)/_nb_jobs;
     double makespan = static_cast<double>(_max_completion_time - _min_submission_time);
+    if (_context->time_window.enabled)
+    {
+        makespan = static_cast<double>(_max_completion_time) - _context->time_window.start;
+    }
 
-    output_map["batsim_version"] = "\""s + _context->batsim_version + "\""s;
+    output_map["batsim_version"] = "\""s + json_escape(_context->batsim_version) + "\""s;
     output_map["nb_jobs"] = to_string(_nb_jobs);
     output_map["nb_jobs_finished"] = to_string(_nb_jobs_finished);
     output_map["nb_jobs_success"] = to_string(_nb_jobs_success);
     output_map["nb_jobs_killed"] = to_string(_nb_jobs_killed);
     output_map["nb_jobs_rejected"] = to_string(_nb_jobs_rejected);
+    output_map["nb_warm_up_jobs"] = to_string(_nb_warm_up_jobs);
     output_map["success_rate"] = to_string(success_rate);
 
     output_map["makespan"] = to_string(makespan);
@@ -630,6 +1294,23 @@ void JobsTracer::finalize()
 
     output_map["nb_computing_machines"] = to_string(_context->machines.nb_machines());
 
+    // Metrics distributions
+    vector<string> workload_distributions;
+    for (const auto & mit : _distributions_per_workload)
+    {
+        workload_distributions.push_back("      \""s + json_escape(mit.first) + "\": "s + job_metrics_distributions_to_json(mit.second, "        "));
+    }
+    vector<string> size_class_distributions;
+    for (const auto & mit : _distributions_per_size_class)
+    {
+        size_class_distributions.push_back("      \""s + job_size_class_name(mit.first) + "\": "s + job_metrics_distributions_to_json(mit.second, "        "));
+    }
+    output_map["distributions"] = "{\n"s +
+        "    \"all\": "s + job_metrics_distributions_to_json(_distributions, "      ") + ",\n"s +
+        "    \"per_size_class\": {\n"s + boost::algorithm::join(size_class_distributions, ",\n") + "\n    },\n"s +
+        "    \"per_workload\": {\n"s + boost::algorithm::join(workload_distributions, ",\n") + "\n    }\n"s +
+        "  }"s;
+
     XBT_INFO("jobs=%d, finished=%d, success=%d, killed=%d, success_rate=%lf",
              _nb_jobs, _nb_jobs_finished, _nb_jobs_success, _nb_jobs_killed, success_rate);
     XBT_INFO("makespan=%lf, mean_waiting_time=%lf, mean_turnaround_time=%lf, "
@@ -683,6 +1364,13 @@ void JobsTracer::finalize()
 
 void JobsTracer::write_job(const JobPtr job)
 {
+    // Jobs submitted during the warm-up only fill the platform, they are neither written nor measured
+    if (_context->time_window.is_warm_up(job->submission_time))
+    {
+        _nb_warm_up_jobs++;
+        return;
+    }
+
     int success = (job->state == JobState::JOB_STATE_COMPLETED_SUCCESSFULLY);
     bool rejected = (job->state == JobState::JOB_STATE_REJECTED);
 
@@ -743,6 +1431,18 @@ void JobsTracer::write_job(const JobPtr job)
                 _max_slowdown = slowdown;
             }
 
+            JobMetricsDistributions * distributions[3] = {
+                &_distributions,
+                &_distributions_per_workload[job->workload->name],
+                &_distributions_per_size_class[job_size_class(job->requested_nb_res)]
+            };
+            for (JobMetricsDistributions * d : distributions)
+            {
+                d->waiting_time.add(static_cast<double>(waiting_time));
+                d->turnaround_time.add(static_cast<double>(turnaround_time));
+                d->slowdown.add(static_cast<double>(slowdown));
+            }
+
             const IntervalSet & allocation = job->execution_request->job_allocation->hosts;
             for (size_t i = 0; i < allocation.size(); ++i)
             {
@@ -755,6 +1455,11 @@ void JobsTracer::write_job(const JobPtr job)
         xbt_die("Job %s did not complete", job->id.job_name().c_str());
     }
 
+    if (_metrics_only)
+    {
+        return;
+    }
+
     // Set all values to be written
     _job_map["job_id"] = job->id.job_name();
     _job_map["workload_name"] = job->workload->name;
@@ -12,14 +12,23 @@
 #include <string>
 #include <fstream>
 #include <map>
+#include <set>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <cstdint>
 
+#include "cli.hpp"
 #include "pointers.hpp"
 #include "machines.hpp"
 #include "jobs.hpp"
+#include "quantile_sketch.hpp"
 
 struct BatsimContext;
 struct Job;
+struct ProbeData;
 
 /**
  * @brief Prepares Batsim's outputting
@@ -33,20 +42,48 @@ void prepare_batsim_outputs(BatsimContext * context);
  */
 void finalize_batsim_outputs(BatsimContext * context);
 
+/**
+ * @brief Escapes a string so that it can be put in a JSON string
+ * @details Quotes and backslashes are escaped, control characters are replaced by spaces.
+ * @param[in] str The string to escape
+ * @return The escaped string
+ */
+std::string json_escape(const std::string & str);
+
+/**
+ * @brief Stores how a WriteBuffer should write its output file
+ */
+struct WriteBufferOptions
+{
+    size_t buffer_size = 64*1024;   //!< The size of each buffer (in bytes)
+    unsigned int nb_buffers = 1;    //!< The number of buffers. 1 means that the file is written synchronously by the caller thread, more enables a background writer thread.
+    OutputCompression compression = OutputCompression::NONE; //!< How the output file should be compressed
+};
+
 /**
  * @brief Buffered-write output file
+ * @details When several buffers are used, filled buffers are handed over to a dedicated writer thread,
+ *          so that the simulation thread only waits on I/O if all buffers are waiting to be written.
  */
 class WriteBuffer
 {
 public:
     /**
-     * @brief Builds a WriteBuffer
+     * @brief Builds a WriteBuffer that writes its file synchronously
      * @param[in] filename The file that will be written
      * @param[in] buffer_size The size of the buffer (in bytes).
      */
     explicit WriteBuffer(const std::string & filename,
                          size_t buffer_size = 64*1024);
 
+    /**
+     * @brief Builds a WriteBuffer
+     * @param[in] filename The file that will be written. The compression suffix (e.g., ".gz") is appended to it if compression is enabled.
+     * @param[in] options How the file should be written
+     */
+    WriteBuffer(const std::string & filename,
+                const WriteBufferOptions & options);
+
     /**
      * @brief WriteBuffers cannot be copied.
      * @param[in] other Another instance
@@ -55,7 +92,7 @@ public:
 
     /**
      * @brief Destructor
-     * @details This method flushes the buffer if it is not empty, destroys the buffer and closes the file.
+     * @details This method closes the WriteBuffer if this has not been done already.
      */
     ~WriteBuffer();
 
@@ -65,16 +102,87 @@ public:
      */
     void append_text(const char * text);
 
+    /**
+     * @brief Appends a text at the end of the buffer. If the buffer is full, it is automatically flushed into the disk.
+     * @param[in] text The text to append
+     * @param[in] text_length The length of the text to append (in bytes)
+     */
+    void append_text(const char * text, size_t text_length);
+
     /**
      * @brief Write the current content of the buffer into the file
+     * @details If a writer thread is used, the content is handed over to it and may not be on the disk yet when this method returns.
      */
     void flush_buffer();
 
+    /**
+     * @brief Writes all pending data, makes sure it reached the disk then closes the file
+     * @details Calling this method several times is harmless.
+     */
+    void close();
+
+    /**
+     * @brief Returns the name of the file really written (compression suffix included)
+     * @return The name of the file really written
+     */
+    const std::string & filename() const;
+
 private:
-    std::ofstream f;            //!< The file stream on which the buffer is outputted
-    const size_t buffer_size;   //!< The buffer maximum size
-    char * buffer = nullptr;    //!< The buffer
-    size_t buffer_pos = 0;         //!< The current position of the buffer (previous positions are already written)
+    /**
+     * @brief Hands the current buffer over to be written, then makes another buffer current
+     */
+    void submit_current_buffer();
+
+    /**
+     * @brief Writes a chunk of data into the file, compressing it if needed
+     * @param[in] data The data to write
+     * @param[in] size The size of the data (in bytes)
+     */
+    void write_chunk(const char * data, size_t size);
+
+    /**
+     * @brief Writes raw bytes into the file descriptor
+     * @param[in] data The data to write
+     * @param[in] size The size of the data (in bytes)
+     */
+    void write_raw(const char * data, size_t size);
+
+    /**
+     * @brief Finishes the compression stream (if any), synchronizes the file on the disk and closes it
+     */
+    void finish_file();
+
+    /**
+     * @brief The writer thread main loop
+     */
+    void writer_thread_main();
+
+    /**
+     * @brief Stores a filled buffer waiting to be written
+     */
+    struct PendingBuffer
+    {
+        char * data;    //!< The buffer
+        size_t size;    //!< The number of bytes to write
+    };
+
+    std::string _filename;          //!< The name of the file being written
+    int _fd = -1;                   //!< The file descriptor on which the buffer is outputted
+    const WriteBufferOptions _options; //!< How the file is written
+    std::vector<char*> _buffers;    //!< All the buffers owned by this WriteBuffer
+    char * buffer = nullptr;        //!< The current buffer
+    size_t buffer_pos = 0;          //!< The current position of the buffer (previous positions are already written)
+    bool _closed = false;           //!< Whether close has been called
+
+    void * _zstream = nullptr;      //!< The compression stream (if compression is enabled)
+    std::vector<char> _zbuffer;     //!< The buffer in which compressed data is generated
+
+    std::thread _writer_thread;     //!< The writer thread (only used if there are several buffers)
+    std::mutex _mutex;              //!< Protects the queues below
+    std::condition_variable _cv;    //!< Notified whenever the queues below change
+    std::deque<PendingBuffer> _pending_buffers; //!< The buffers waiting to be written by the writer thread
+    std::deque<char*> _free_buffers; //!< The buffers that can be filled by the caller thread
+    bool _stop_writer = false;      //!< Whether the writer thread should stop once the pending buffers are written
 };
 
 
@@ -104,8 +212,9 @@ public:
     /**
      * @brief Sets the output filename of the tracer
      * @param filename The name of the output file of the tracer
+     * @param options How the output file should be written
      */
-    void set_filename(const std::string & filename);
+    void set_filename(const std::string & filename, const WriteBufferOptions & options = WriteBufferOptions());
 
     /**
      * @brief Adds a power state change in the tracer
@@ -162,8 +271,9 @@ public:
     /**
      * @brief Sets the output filename of the tracer
      * @param[in] filename The name of the output file of the tracer
+     * @param[in] options How the output file should be written
      */
-    void set_filename(const std::string & filename);
+    void set_filename(const std::string & filename, const WriteBufferOptions & options = WriteBufferOptions());
 
     /**
      * @brief Adds a job start in the tracer
@@ -245,11 +355,20 @@ public:
     /**
      * @brief Sets the output filename of the tracer
      * @param[in] filename  The name of the output file of the tracer
+     * @param[in] options How the output file should be written
      */
-    void set_filename(const std::string & filename);
+    void set_filename(const std::string & filename, const WriteBufferOptions & options = WriteBufferOptions());
 
     /**
-     * @brief Writes a line in the output file, corresponding to the current state, at the given date
+     * @brief Sets how machine states should be traced. Must be called before set_filename.
+     * @param[in] mode The tracing mode
+     * @param[in] sampling_period The simulated time period of each sample (only used in sampled mode)
+     */
+    void set_tracing_mode(MachineStateTracingMode mode, double sampling_period);
+
+    /**
+     * @brief Traces the current machine states at the given date
+     * @details Depending on the tracing mode, a line is written right away or the states are aggregated with the following ones.
      * @param[in] date The current date
      */
     void write_machine_states(double date);
@@ -261,16 +380,157 @@ public:
 
     /**
      * @brief Closes the output buffer
+     * @details Lines still pending in coalesce or sampled mode are written beforehand, up to the current simulation date.
      */
     void close_buffer();
 
+private:
+    /**
+     * @brief Number of tracked machine states (columns of the output file after time)
+     */
+    static const int NB_STATES = 5;
+
+    /**
+     * @brief Reads how many machines are in each tracked state
+     * @param[out] counts The number of machines in each tracked state, in the output file column order
+     */
+    void read_machine_states(int counts[NB_STATES]) const;
+
+    /**
+     * @brief Writes a line whose values are integers
+     * @param[in] date The date of the line
+     * @param[in] counts The values of the line
+     */
+    void write_line(double date, const int counts[NB_STATES]);
+
+    /**
+     * @brief Writes a line whose values are real numbers
+     * @param[in] date The date of the line
+     * @param[in] values The values of the line
+     */
+    void write_line(double date, const double values[NB_STATES]);
+
+    /**
+     * @brief Accumulates the current machine states into the current sample until a given date, writing all samples completed before it
+     * @param[in] date The date until which the current machine states should be accumulated
+     */
+    void accumulate_samples_until(double date);
+
+    /**
+     * @brief Writes the lines still pending in coalesce or sampled mode
+     * @param[in] date The current date
+     */
+    void write_pending_states(double date);
+
 private:
     BatsimContext * _context = nullptr; //!< The Batsim context
     WriteBuffer * _wbuf = nullptr; //!< The buffer used to handle the output file
+    MachineStateTracingMode _mode = MachineStateTracingMode::EVERY_CHANGE; //!< How machine states are traced
+    double _sampling_period = 60; //!< The simulated time period of each sample (in sampled mode)
+
+    bool _has_pending_line = false; //!< Whether a line has not been written yet (in coalesce mode)
+    double _last_date = 0; //!< The date of the pending line (in coalesce mode) or of the last accumulation (in sampled mode)
+    int _last_counts[NB_STATES] = {0}; //!< The machine states of the pending line (in coalesce mode) or in effect since _last_date (in sampled mode)
+    double _sampling_origin = 0; //!< The start date of the first sample (in sampled mode)
+    uint64_t _sample_index = 0; //!< The index of the current sample, which starts at _sampling_origin + _sample_index * _sampling_period (in sampled mode)
+    double _sample_accumulator[NB_STATES] = {0}; //!< The time-weighted sum of machine states since the start of the current sample (in sampled mode)
+};
+
+/**
+ * @brief Traces the data emitted by probes, as one binary time series file per probe
+ * @details Each file starts with a header that describes the probe and the type of its values,
+ *          then contains one record per emission: the time elapsed since the previous record (in microseconds, as a LEB128 varint)
+ *          followed by the values of the emission (little-endian float64, one per probed resource or one if they are aggregated).
+ *          The tools/read_probe_data.py script reads these files.
+ */
+class ProbeDataTracer
+{
+public:
+    /**
+     * @brief Constructs a ProbeDataTracer
+     */
+    ProbeDataTracer() = default;
+
+    /**
+     * @brief ProbeDataTracer cannot be copied.
+     * @param[in] other Another instance
+     */
+    ProbeDataTracer(const ProbeDataTracer & other) = delete;
+
+    /**
+     * @brief Destroys a ProbeDataTracer
+     * @details The output files are flushed and written
+     */
+    ~ProbeDataTracer();
+
+    /**
+     * @brief Sets where the output files of the tracer are written
+     * @param[in] prefix The prefix of the output files, to which "probe_<probe_id>.bin" is appended.
+     *                   A "_<n>" suffix is added to the probe identifier if the file has already been used,
+     *                   e.g. by a previous probe with the same identifier or whose identifier has the same safe characters.
+     * @param[in] options How the output files should be written
+     */
+    void set_prefix(const std::string & prefix, const WriteBufferOptions & options = WriteBufferOptions());
+
+    /**
+     * @brief Adds the data emitted by a probe in the tracer
+     * @details The output file of the probe is created at its first emission.
+     * @param[in] date The date at which the data has been emitted
+     * @param[in] probe_data The emitted data
+     */
+    void add_probe_data(double date, const ProbeData & probe_data);
+
+    /**
+     * @brief Closes the output file of a probe that has stopped
+     * @details A later probe with the same identifier is traced into a new output file.
+     * @param[in] probe_id The identifier of the probe. Nothing is done if the probe has not been traced.
+     */
+    void close_series(const std::string & probe_id);
+
+    /**
+     * @brief Closes the buffers and their associated output files
+     */
+    void close_buffers();
+
+private:
+    /**
+     * @brief The output file of a probe
+     */
+    struct ProbeSeries
+    {
+        WriteBuffer * wbuf = nullptr;   //!< The buffer used to handle the output file
+        int64_t last_date_us = 0;       //!< The date of the last record (in microseconds)
+        uint32_t nb_values = 0;         //!< The number of values of each record
+    };
+
+    /**
+     * @brief Creates the output file of a probe and writes its header
+     * @param[in] probe_data The first data emitted by the probe
+     * @param[in] nb_values The number of values of each record
+     * @return The output file of the probe
+     */
+    ProbeSeries & create_series(const ProbeData & probe_data, uint32_t nb_values);
+
+    std::string _prefix; //!< The prefix of the output files
+    WriteBufferOptions _options; //!< How the output files are written
+    std::map<std::string, ProbeSeries> _series; //!< The output file of each traced probe, by probe identifier
+    std::set<std::string> _used_filenames; //!< The output files that have already been written
+    std::vector<char> _record; //!< The buffer in which records are encoded
+};
+
+/**
+ * @brief Distributions of the scheduling metrics of a set of jobs
+ */
+struct JobMetricsDistributions
+{
+    QuantileSketch waiting_time;    //!< The distribution of the waiting time of jobs
+    QuantileSketch turnaround_time; //!< The distribution of the turnaround time of jobs
+    QuantileSketch slowdown;        //!< The distribution of the slowdown (AKA stretch) of jobs
 };
 
 /**
  * @brief Traces the jobs execution over time to export to a CSV file. Also exports schedule metrics to a second CSV file
+ * @details In metrics-only mode, the jobs CSV file is not written at all.
  */
 class JobsTracer
 {
@@ -339,6 +599,7 @@ private:
     int _nb_jobs_success = 0; //!< The number of successful jobs.
     int _nb_jobs_killed = 0; //!< The number of killed jobs.
     int _nb_jobs_rejected = 0; //!< The number of rejected jobs.
+    int _nb_warm_up_jobs = 0; //!< The number of jobs submitted during the warm-up, which are excluded from the outputs.
     long double _max_completion_time = 0; //!< The maximum completion time observed.
     long double _min_submission_time = 0; //!< The minimum submission time observed.
     long double _sum_waiting_time = 0; //!< The sum of the waiting time of jobs.
@@ -348,4 +609,10 @@ private:
     long double _max_turnaround_time = 0; //!< The maximum turnaround time observed.
     long double _max_slowdown = 0; //!< The maximum slowdown observed.
     std::map<int, long double> _machines_utilization; //!< Counts the utilization time of each machine.
+
+    // Distribution-related
+    bool _metrics_only = false; //!< Whether only aggregated metrics are written (no jobs output file)
+    JobMetricsDistributions _distributions; //!< The metrics distributions of all finished jobs
+    std::map<std::string, JobMetricsDistributions> _distributions_per_workload; //!< The metrics distributions of finished jobs, per workload name
+    std::map<int, JobMetricsDistributions> _distributions_per_size_class; //!< The metrics distributions of finished jobs, per size class (see job_size_class)
 };
@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <memory>
 
 #include <simgrid/s4u.hpp>
 
@@ -17,14 +18,20 @@ XBT_LOG_NEW_DEFAULT_CATEGORY(external_event_submitter, "external_event_submitter
 
 using namespace std;
 
-static void send_events_to_server(const vector<const ExternalEvent *> & events_to_send,
+static void send_events_to_server(vector<unique_ptr<const ExternalEvent>> & events_to_send,
                                   const string & submitter_name)
 {
     if (!events_to_send.empty())
     {
+        // The message takes the ownership of the events
         ExternalEventsOccurredMessage * msg = new ExternalEventsOccurredMessage;
         msg->submitter_name = submitter_name;
-        msg->occurred_events = events_to_send;
+        msg->occurred_events.reserve(events_to_send.size());
+        for (auto & event : events_to_send)
+        {
+            msg->occurred_events.push_back(event.release());
+        }
+        events_to_send.clear();
         send_message("server", IPMessageType::EXTERNAL_EVENTS_OCCURRED, static_cast<void*>(msg));
     }
 }
@@ -52,33 +59,30 @@ void static_external_event_submitter_process(BatsimContext * context,
 
     long double current_occurring_date = static_cast<long double>(simgrid::s4u::Engine::get_clock());
 
-    const vector<ExternalEvent *> & eventVector = context->external_event_lists[eventList_name]->events();
+    // Events are read right before they occur, only those of the current date are in memory
+    ExternalEventReader reader(context->external_event_lists[eventList_name]->filename, eventList_name);
+    // The pending events are freed if the submitter is killed
+    vector<unique_ptr<const ExternalEvent>> events_to_send;
 
-    if(eventVector.size() > 0)
+    for (unique_ptr<ExternalEvent> e = reader.next_event(); e != nullptr; e = reader.next_event())
     {
-        vector<const ExternalEvent *> events_to_send;
-
-        for(const ExternalEvent * e : eventVector)
+        if (e->timestamp > current_occurring_date)
         {
-            if (e->timestamp > current_occurring_date)
-            {
-                // Next event occurs after current time, send the message to the server for previous occured events
-                send_events_to_server(events_to_send, submitter_name);
-                events_to_send.clear();
-
-                // Now let's sleep until it's time for the next event to occur
-                simgrid::s4u::this_actor::sleep_for(static_cast<double>(e->timestamp - current_occurring_date));
-                current_occurring_date = static_cast<long double>(simgrid::s4u::Engine::get_clock());
-            }
-
-            // Populate the vector of events to send to the server
-            events_to_send.push_back(e);
+            // Next event occurs after current time, send the message to the server for previous occured events
+            send_events_to_server(events_to_send, submitter_name);
+
+            // Now let's sleep until it's time for the next event to occur
+            simgrid::s4u::this_actor::sleep_for(static_cast<double>(e->timestamp - current_occurring_date));
+            current_occurring_date = static_cast<long double>(simgrid::s4u::Engine::get_clock());
         }
 
-        // Send last vector of events to occur
-        send_events_to_server(events_to_send, submitter_name);
+        // Populate the vector of events to send to the server, which frees them once they have been forwarded
+        events_to_send.push_back(std::move(e));
     }
 
+    // Send last vector of events to occur
+    send_events_to_server(events_to_send, submitter_name);
+
     SubmitterByeMessage * bye_msg = new SubmitterByeMessage;
     bye_msg->submitter_type = SubmitterType::EXTERNAL_EVENT_SUBMITTER;
     bye_msg->submitter_name = submitter_name;
@@ -11,6 +11,7 @@ struct BatsimContext;
 
 /**
  * @brief The process in charge if submitting static events
+ * @details Events are read from the file of the list right before they occur (see ExternalEventReader).
  * @param context The BatsimContext
  * @param eventList_name The name of the external event list attached to the submitter
  */
@@ -5,6 +5,7 @@
 
 #include "external_events.hpp"
 
+#include <algorithm>
 #include <fstream>
 
 #include <simgrid/s4u.hpp>
@@ -81,6 +82,8 @@ ExternalEvent * ExternalEvent::from_json(rapidjson::Value & json_desc,
     if (event->type == ExternalEventType::GENERIC)
     {
         //TODO: Handle unknown external event as Generic by default
+        xbt_assert(json_desc.HasMember("data") && json_desc["data"].IsString(),
+                   "%s: one generic external event has no valid 'data' field, it should be a string.", error_prefix.c_str());
         GenericEventData * data = new GenericEventData;
         data->json_desc_str = json_desc["data"].GetString();
         event->data = static_cast<void*>(data);
@@ -135,52 +138,135 @@ ExternalEventList::~ExternalEventList()
     }
 }
 
-void ExternalEventList::load_from_json(const std::string & json_filename)
+std::vector<ExternalEvent*> &ExternalEventList::events()
+{
+    return _events;
+}
+
+const std::vector<ExternalEvent*> &ExternalEventList::events() const
+{
+    return _events;
+}
+
+void ExternalEventList::add_event(ExternalEvent * event)
+{
+    _events.push_back(event);
+}
+
+bool ExternalEventList::is_static() const
 {
-    XBT_INFO("Loading JSON external events from '%s' ...", json_filename.c_str());
-    filename = json_filename;
+    return _is_static;
+}
 
-    int next_id = 0;
+ExternalEventReader::ExternalEventReader(const std::string & filename, const std::string & list_name) :
+    _filename(filename),
+    _list_name(list_name),
+    _file(filename)
+{
+    xbt_assert(_file.is_open(), "Cannot read file '%s'", filename.c_str());
 
-    std::ifstream ifile(json_filename.c_str());
-    xbt_assert(ifile.is_open(), "Cannot read file '%s'", json_filename.c_str());
+    // A first pass validates the events and checks whether they are sorted, which is the case of most event logs
     string line;
-    while(getline(ifile, line))
+    double previous_timestamp = 0;
+    while (read_line(line))
+    {
+        double timestamp = validate_event(line);
+        _sorted = _sorted && (_nb_events == 0 || timestamp >= previous_timestamp);
+        previous_timestamp = timestamp;
+        ++_nb_events;
+    }
+
+    // Otherwise, a second pass indexes where each event is in the file
+    if (!_sorted)
     {
-        if(line.size() > 0)
+        _file.clear();
+        _file.seekg(0);
+        _index.reserve(_nb_events);
+
+        uint64_t event_number = 0;
+        std::streamoff offset = _file.tellg();
+        while (read_line(line))
         {
-            Document doc;
-            doc.Parse(line.c_str());
-            xbt_assert(!doc.HasParseError() and doc.IsObject(), "Invalid JSON external events file %s, an external event could not be parsed.", json_filename.c_str());
-
-            ExternalEvent * event = ExternalEvent::from_json(doc);
-            event->set_id(name+"!"+std::to_string(next_id));
-            add_event(event);
-            next_id++;
+            _index.push_back({parse_timestamp(line), offset, event_number});
+            ++event_number;
+            offset = _file.tellg();
         }
+
+        std::stable_sort(_index.begin(), _index.end(),
+                         [](const IndexEntry & a, const IndexEntry & b) { return a.timestamp < b.timestamp; });
     }
-    sort(_events.begin(), _events.end(), event_comparator_timestamp_number);
 
-    XBT_INFO("JSON external events sucessfully parsed. Read %lu external events.", _events.size());
-    ifile.close();
+    _file.clear();
+    _file.seekg(0);
+
+    XBT_INFO("External events file '%s' contains %lu events, which are %s.", filename.c_str(),
+             static_cast<unsigned long>(_nb_events), _sorted ? "sorted by timestamp and streamed" : "not sorted by timestamp and have been indexed");
 }
 
-std::vector<ExternalEvent*> &ExternalEventList::events()
+std::unique_ptr<ExternalEvent> ExternalEventReader::next_event()
 {
-    return _events;
+    if (_nb_read_events == _nb_events)
+    {
+        return nullptr;
+    }
+
+    string line;
+    uint64_t event_number = _nb_read_events;
+    if (!_sorted)
+    {
+        const IndexEntry & entry = _index[_nb_read_events];
+        _file.seekg(entry.offset);
+        event_number = entry.event_number;
+    }
+
+    bool line_read = read_line(line);
+    xbt_assert(line_read, "External events file '%s' has been modified while being read", _filename.c_str());
+    ++_nb_read_events;
+
+    return parse_event(line, event_number);
 }
 
-const std::vector<ExternalEvent*> &ExternalEventList::events() const
+uint64_t ExternalEventReader::nb_events() const
 {
-    return _events;
+    return _nb_events;
 }
 
-void ExternalEventList::add_event(ExternalEvent * event)
+bool ExternalEventReader::read_line(string & line)
 {
-    _events.push_back(event);
+    while (getline(_file, line))
+    {
+        if (line.size() > 0)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
-bool ExternalEventList::is_static() const
+double ExternalEventReader::parse_timestamp(const string & line) const
 {
-    return _is_static;
+    Document doc;
+    doc.Parse(line.c_str());
+    xbt_assert(!doc.HasParseError() and doc.IsObject(), "Invalid JSON external events file %s, an external event could not be parsed.", _filename.c_str());
+    xbt_assert(doc.HasMember("timestamp") && doc["timestamp"].IsNumber(),
+               "Invalid JSON external events file %s, an external event has no valid 'timestamp' field.", _filename.c_str());
+    return doc["timestamp"].GetDouble();
+}
+
+double ExternalEventReader::validate_event(const string & line) const
+{
+    // Invalid events abort the simulation before it starts rather than when they occur
+    std::unique_ptr<ExternalEvent> event = parse_event(line, 0);
+    return static_cast<double>(event->timestamp);
+}
+
+std::unique_ptr<ExternalEvent> ExternalEventReader::parse_event(const string & line, uint64_t event_number) const
+{
+    Document doc;
+    doc.Parse(line.c_str());
+    xbt_assert(!doc.HasParseError() and doc.IsObject(), "Invalid JSON external events file %s, an external event could not be parsed.", _filename.c_str());
+
+    std::unique_ptr<ExternalEvent> event(ExternalEvent::from_json(doc, "Invalid JSON external events file " + _filename));
+    event->set_id(_list_name + "!" + std::to_string(event_number));
+    return event;
 }
@@ -5,7 +5,10 @@
 
 #pragma once
 
+#include <cstdint>
+#include <fstream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -105,12 +108,6 @@ public:
       */
     ~ExternalEventList();
 
-    /**
-     * @brief Loads static ExternalEvents from a JSON filename
-     * @param[in] json_filename The name of the JSON file
-     */
-    void load_from_json(const std::string & json_filename);
-
     /**
      * @brief Gets the list of ExternalEvents
      * @return The internal vector of ExternalEvent*
@@ -143,3 +140,87 @@ private:
     std::vector<ExternalEvent*> _events;    //!< The list of events (should be sorted in non-decreasing timestamp)
     bool _is_static;                //!< Whether the EventList is dynamic
 };
+
+/**
+ * @brief Reads the events of an external events file one by one, by non-decreasing timestamp
+ * @details Files sorted by timestamp are streamed. Otherwise, an index of the timestamp and file offset of each event
+ *          is built when the reader is created, and events are read from the file in the order of the index.
+ *          In both cases, events are only parsed when they are read, so that the whole file is never held in memory.
+ */
+class ExternalEventReader
+{
+public:
+    /**
+     * @brief Opens an external events file, validates its events and checks whether they are sorted by timestamp
+     * @param[in] filename The name of the external events file (one JSON event per line)
+     * @param[in] list_name The name of the ExternalEventList of the file, which prefixes event identifiers
+     */
+    ExternalEventReader(const std::string & filename, const std::string & list_name);
+
+    /**
+     * @brief ExternalEventReader cannot be copied.
+     * @param[in] other Another instance
+     */
+    ExternalEventReader(const ExternalEventReader & other) = delete;
+
+    /**
+     * @brief Reads the next event of the file
+     * @return The newly allocated event, or nullptr if all the events have been read
+     */
+    std::unique_ptr<ExternalEvent> next_event();
+
+    /**
+     * @brief Returns the number of events of the file
+     * @return The number of events of the file
+     */
+    uint64_t nb_events() const;
+
+private:
+    /**
+     * @brief Reads the next non-empty line of the file
+     * @param[out] line The line
+     * @return false if the end of the file has been reached, true otherwise
+     */
+    bool read_line(std::string & line);
+
+    /**
+     * @brief Parses the timestamp of an event line
+     * @param[in] line The JSON description of the event
+     * @return The timestamp of the event
+     */
+    double parse_timestamp(const std::string & line) const;
+
+    /**
+     * @brief Fully parses an event line to check that it is valid, then discards the event
+     * @param[in] line The JSON description of the event
+     * @return The timestamp of the event
+     */
+    double validate_event(const std::string & line) const;
+
+    /**
+     * @brief Parses an event line
+     * @param[in] line The JSON description of the event
+     * @param[in] event_number The position of the event in the file, which identifies it
+     * @return The newly allocated event
+     */
+    std::unique_ptr<ExternalEvent> parse_event(const std::string & line, uint64_t event_number) const;
+
+private:
+    /**
+     * @brief Where an event of an unsorted file is
+     */
+    struct IndexEntry
+    {
+        double timestamp;           //!< The timestamp of the event
+        std::streamoff offset;      //!< The offset of the event line in the file
+        uint64_t event_number;      //!< The position of the event in the file
+    };
+
+    std::string _filename;              //!< The name of the external events file
+    std::string _list_name;             //!< The name of the ExternalEventList of the file
+    std::ifstream _file;                //!< The external events file
+    bool _sorted = true;                //!< Whether the events of the file are sorted by timestamp
+    std::vector<IndexEntry> _index;     //!< The events sorted by timestamp. Only built if the file is not sorted.
+    uint64_t _nb_events = 0;            //!< The number of events of the file
+    uint64_t _nb_read_events = 0;       //!< The number of events read so far
+};
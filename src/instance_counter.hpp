@@ -0,0 +1,62 @@
+/**
+ * @file instance_counter.hpp
+ * @brief Counts how many instances of a type are alive, to report memory-related statistics
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Counts the instances of type T. Put an InstanceCounter<T> member in T to count T instances.
+ * @details Counters are atomic, as instances may be created by actors running on several threads (SimGrid parallel contexts).
+ */
+template <typename T>
+struct InstanceCounter
+{
+    /**
+     * @brief Counts a new instance
+     */
+    InstanceCounter()
+    {
+        nb_created.fetch_add(1, std::memory_order_relaxed);
+        const uint64_t alive = nb_alive.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint64_t max_alive = max_nb_alive.load(std::memory_order_relaxed);
+        while (alive > max_alive && !max_nb_alive.compare_exchange_weak(max_alive, alive, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /**
+     * @brief Counts a new instance (copies are instances too)
+     * @param[in] other Another instance
+     */
+    InstanceCounter(const InstanceCounter & other) : InstanceCounter()
+    {
+        (void) other;
+    }
+
+    /**
+     * @brief Assigning an instance does not create a new one
+     * @param[in] other Another instance
+     * @return *this
+     */
+    InstanceCounter & operator=(const InstanceCounter & other)
+    {
+        (void) other;
+        return *this;
+    }
+
+    /**
+     * @brief Uncounts a destroyed instance
+     */
+    ~InstanceCounter()
+    {
+        nb_alive.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    static inline std::atomic<uint64_t> nb_created{0};      //!< The number of T instances created so far
+    static inline std::atomic<uint64_t> nb_alive{0};        //!< The number of T instances currently alive
+    static inline std::atomic<uint64_t> max_nb_alive{0};    //!< The maximum number of T instances that have been alive at the same time
+};
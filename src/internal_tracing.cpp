@@ -0,0 +1,116 @@
+/**
+ * @file internal_tracing.cpp
+ * @brief Tracing of Batsim's internal phases into a Chrome trace-event file
+ */
+
+#include "internal_tracing.hpp"
+
+#include <chrono>
+#include <mutex>
+
+#include <simgrid/s4u.hpp>
+
+#include "export.hpp"
+
+using namespace std;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(internal_tracing, "internal_tracing"); //!< Logging
+
+namespace internal_tracing
+{
+
+bool enabled = false;
+
+static WriteBuffer * trace_buffer = nullptr; //!< The buffer of the trace file
+static chrono::steady_clock::time_point trace_origin; //!< The real time origin of the trace
+static bool first_event = true; //!< Whether no event has been written yet
+static mutex trace_mutex; //!< Protects the trace buffer, as job actors may run on several threads
+
+/**
+ * @brief Returns the real time elapsed since the tracing started
+ * @return The real time elapsed since the tracing started (in microseconds)
+ */
+static long long now_us()
+{
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - trace_origin).count();
+}
+
+/**
+ * @brief Writes an event into the trace file
+ * @param[in] event The event, as a JSON object
+ */
+static void write_event(const string & event)
+{
+    lock_guard<mutex> lock(trace_mutex);
+    if (!first_event)
+    {
+        trace_buffer->append_text(",\n", 2);
+    }
+    first_event = false;
+    trace_buffer->append_text(event.c_str(), event.size());
+}
+
+void start(const string & filename, const WriteBufferOptions & options)
+{
+    xbt_assert(!enabled, "Internal tracing has already been started");
+    trace_buffer = new WriteBuffer(filename, options);
+    trace_buffer->append_text("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    trace_origin = chrono::steady_clock::now();
+    first_event = true;
+    enabled = true;
+
+    XBT_INFO("Tracing Batsim internals into file '%s'", trace_buffer->filename().c_str());
+}
+
+void stop()
+{
+    if (!enabled)
+    {
+        return;
+    }
+
+    enabled = false;
+    trace_buffer->append_text("\n]}\n");
+    delete trace_buffer;
+    trace_buffer = nullptr;
+}
+
+void add_async_event(char phase, const char * category, const string & name, const string & id)
+{
+    xbt_assert(phase == 'b' || phase == 'e', "Invalid asynchronous event phase '%c'", phase);
+    char buf[256];
+    snprintf(buf, sizeof(buf), "\"ph\": \"%c\", \"ts\": %lld, \"pid\": 1, \"tid\": 1, \"args\": {\"sim_time\": %.17g}}",
+             phase, now_us(), simgrid::s4u::Engine::get_clock());
+
+    write_event("{\"name\": \""s + json_escape(name) + "\", \"cat\": \""s + category +
+                "\", \"id\": \""s + json_escape(id) + "\", "s + buf);
+}
+
+Span::Span(const char * category, string name) :
+    _traced(enabled),
+    _category(category)
+{
+    if (_traced)
+    {
+        _name = std::move(name);
+        _start_us = now_us();
+        _sim_start = simgrid::s4u::Engine::get_clock();
+    }
+}
+
+Span::~Span()
+{
+    // Tracing may have been stopped during the span
+    if (!_traced || !enabled)
+    {
+        return;
+    }
+
+    char buf[256];
+    snprintf(buf, sizeof(buf), "\"ph\": \"X\", \"ts\": %lld, \"dur\": %lld, \"pid\": 1, \"tid\": 0, \"args\": {\"sim_time_start\": %.17g, \"sim_time_end\": %.17g}}",
+             _start_us, now_us() - _start_us, _sim_start, simgrid::s4u::Engine::get_clock());
+
+    write_event("{\"name\": \""s + json_escape(_name) + "\", \"cat\": \""s + _category + "\", "s + buf);
+}
+
+} // end of namespace internal_tracing
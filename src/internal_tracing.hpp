@@ -0,0 +1,105 @@
+/**
+ * @file internal_tracing.hpp
+ * @brief Tracing of Batsim's internal phases into a Chrome trace-event file
+ * @details Instrumentation is only compiled in if Batsim is built with the trace_internals meson option (which defines BATSIM_TRACE_INTERNALS).
+ *          Otherwise, the BATSIM_TRACE_* macros expand to nothing.
+ *          The generated file can be opened with chrome://tracing or https://ui.perfetto.dev.
+ */
+
+#pragma once
+
+#include <string>
+
+struct WriteBufferOptions;
+
+namespace internal_tracing
+{
+
+extern bool enabled; //!< Whether internal tracing is currently enabled. Use is_enabled() to read it.
+
+/**
+ * @brief Returns whether internal tracing is currently enabled
+ * @return Whether internal tracing is currently enabled
+ */
+inline bool is_enabled()
+{
+    return enabled;
+}
+
+/**
+ * @brief Starts tracing Batsim's internal phases into a file
+ * @param[in] filename The name of the trace file to write
+ * @param[in] options How the trace file should be written
+ */
+void start(const std::string & filename, const WriteBufferOptions & options);
+
+/**
+ * @brief Stops tracing and closes the trace file. Does nothing if tracing is not enabled.
+ */
+void stop();
+
+/**
+ * @brief Traces the beginning or the end of an asynchronous span (that can overlap other spans)
+ * @param[in] phase 'b' for the beginning of the span, 'e' for its end
+ * @param[in] category The category of the span
+ * @param[in] name The name of the span
+ * @param[in] id The identifier of the span, which must be the same at its beginning and end
+ */
+void add_async_event(char phase, const char * category, const std::string & name, const std::string & id);
+
+/**
+ * @brief Traces a synchronous span from its construction to its destruction
+ */
+class Span
+{
+public:
+    /**
+     * @brief Starts a span if tracing is enabled
+     * @param[in] category The category of the span
+     * @param[in] name The name of the span
+     */
+    Span(const char * category, std::string name);
+
+    /**
+     * @brief Spans cannot be copied.
+     * @param[in] other Another instance
+     */
+    Span(const Span & other) = delete;
+
+    /**
+     * @brief Ends the span and traces it if tracing is enabled
+     */
+    ~Span();
+
+private:
+    bool _traced;               //!< Whether the span is traced (tracing was enabled when the span started)
+    const char * _category;     //!< The category of the span
+    std::string _name;          //!< The name of the span
+    long long _start_us = 0;    //!< The real time at which the span started (in microseconds)
+    double _sim_start = 0;      //!< The simulated time at which the span started (in seconds)
+};
+
+} // end of namespace internal_tracing
+
+/** @def BATSIM_TRACE_CONCAT(a, b)
+ *  @brief Concatenates two tokens after expanding them
+ */
+#define BATSIM_TRACE_CONCAT_(a, b) a##b
+#define BATSIM_TRACE_CONCAT(a, b) BATSIM_TRACE_CONCAT_(a, b)
+
+#ifdef BATSIM_TRACE_INTERNALS
+/** @def BATSIM_TRACE_SPAN(category, name)
+ *  @brief Traces a span until the end of the current scope. name is only evaluated if tracing is enabled.
+ */
+#define BATSIM_TRACE_SPAN(category, name) \
+    internal_tracing::Span BATSIM_TRACE_CONCAT(batsim_trace_span_, __LINE__)(category, internal_tracing::is_enabled() ? std::string(name) : std::string())
+
+/** @def BATSIM_TRACE_ASYNC(phase, category, name, id)
+ *  @brief Traces the beginning ('b') or the end ('e') of an asynchronous span. name and id are only evaluated if tracing is enabled.
+ */
+#define BATSIM_TRACE_ASYNC(phase, category, name, id) \
+    do { if (internal_tracing::is_enabled()) { internal_tracing::add_async_event(phase, category, name, id); } } while (0)
+#else
+#define BATSIM_TRACE_SPAN(category, name) ((void) 0)
+#define BATSIM_TRACE_ASYNC(phase, category, name, id) ((void) 0)
+#endif
@@ -258,6 +258,12 @@ std::string ip_message_type_to_string(IPMessageType type)
         case IPMessageType::EXTERNAL_EVENTS_OCCURRED:
             s = "EXTERNAL_EVENTS_OCCURRED";
             break;
+        case IPMessageType::TIME_WINDOW_START:
+            s = "TIME_WINDOW_START";
+            break;
+        case IPMessageType::TIME_WINDOW_END:
+            s = "TIME_WINDOW_END";
+            break;
         case IPMessageType::DIE:
             s = "DIE";
             break;
@@ -279,7 +285,7 @@ IPMessage::~IPMessage()
         } break;
         case IPMessageType::SCHED_JOB_REGISTERED:
         {
-            auto * msg = static_cast<JobRegisteredByEDCMessage *>(data);
+            auto * msg = static_cast<JobsRegisteredByEDCMessage *>(data);
             delete msg;
         } break;
         case IPMessageType::SCHED_PROFILE_REGISTERED:
@@ -402,8 +408,17 @@ IPMessage::~IPMessage()
         case IPMessageType::EXTERNAL_EVENTS_OCCURRED:
         {
             auto * msg = static_cast<ExternalEventsOccurredMessage *>(data);
+            for (const ExternalEvent * event : msg->occurred_events)
+            {
+                delete event;
+            }
             delete msg;
         } break;
+        case IPMessageType::TIME_WINDOW_START:
+        case IPMessageType::TIME_WINDOW_END:
+        {
+            // No data in this event
+        } break;
         case IPMessageType::DIE:
         {
         } break;
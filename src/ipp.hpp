@@ -16,6 +16,7 @@
 #include <batprotocol.hpp>
 #include <intervalset.hpp>
 
+#include "instance_counter.hpp"
 #include "pointers.hpp"
 #include "jobs.hpp"
 #include "external_events.hpp"
@@ -29,7 +30,7 @@ struct ServerData;
 enum class IPMessageType
 {
     SUBMITTER_HELLO         //!< Submitter -> Server. The submitter tells it starts submitting to the server.
-    ,SUBMITTER_CALLBACK     //!< Server -> Submitter. The server sends a message to the Submitter. This message is initiated when a Job which has been submitted by the submitter has completed. The submitter must have said that it wanted to be called back when he said hello.
+    ,SUBMITTER_CALLBACK     //!< Server -> Submitter. The server sends a message to the Submitter. This message is initiated when a Job which has been submitted by the submitter has completed (or has been killed or rejected). The submitter must have said that it wanted to be called back when he said hello.
     ,SUBMITTER_BYE          //!< Submitter -> Server. The submitter tells it stops submitting to the server.
     ,EXTERNAL_EVENTS_OCCURRED//!< Sumbitter -> Server. The external event submitter tells the server that one or several external events have occurred.
     ,JOB_SUBMITTED          //!< Submitter -> Server. The submitter tells the server that one or several new jobs have been submitted.
@@ -37,6 +38,8 @@ enum class IPMessageType
     ,KILLING_DONE           //!< Killer -> Server. The killer tells the server that all the jobs have been killed.
     ,SWITCHED_ON            //!< SwitcherON -> Server. The switcherON process tells the server the machine pstate has been changed
     ,SWITCHED_OFF           //!< SwitcherOFF -> Server. The switcherOFF process tells the server the machine pstate has been changed.
+    ,TIME_WINDOW_START      //!< TimeWindow -> Server. The start of the simulated time window has been reached.
+    ,TIME_WINDOW_END        //!< TimeWindow -> Server. The end of the simulated time window has been reached.
 
     // EDC-related
     ,SCHED_HELLO              //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (say hello).
@@ -49,7 +52,7 @@ enum class IPMessageType
     ,SCHED_STOP_CALL_ME_LATER //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (the scheduler no longer wants to be called in the future).
     ,SCHED_CREATE_PROBE       //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (create a new probe).
     ,SCHED_STOP_PROBE         //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (stop a probe).
-    ,SCHED_JOB_REGISTERED     //!< Scheduler -> Server. The scheduler tells the server that the decision process wants to register a job
+    ,SCHED_JOB_REGISTERED     //!< Scheduler -> Server. The scheduler tells the server that the decision process wants to register jobs
     ,SCHED_PROFILE_REGISTERED //!< Scheduler -> Server. The scheduler tells the server that the decision process wants to register a profile
     ,SCHED_END_DYNAMIC_REGISTRATION //!< Scheduler -> Server. The scheduler tells the server that dynamic job submissions are finished.
     ,SCHED_CHANGE_HOSTS_PSTATE       //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (change the pstate of hosts instantaneously).
@@ -107,6 +110,7 @@ struct SubmitterByeMessage
 struct SubmitterJobCompletionCallbackMessage
 {
     JobIdentifier job_id; //!< The JobIdentifier
+    JobState job_state; //!< The final state of the job (it may have failed, been killed or been rejected)
 };
 
 /**
@@ -120,11 +124,12 @@ struct JobSubmittedMessage
 
 /**
  * @brief The content of the SCHED_JOB_REGISTERED message
+ * @details Consecutive job registrations of an EDC message that share the same timestamp are grouped into a single message.
  */
-struct JobRegisteredByEDCMessage
+struct JobsRegisteredByEDCMessage
 {
-    JobPtr job; //!< The freshly registered Job
-    std::string profile_id; //!< The profile id, preferably of the form workload!name
+    std::vector<JobPtr> jobs; //!< The freshly registered Jobs
+    std::vector<std::string> profile_ids; //!< The profile id of each job, preferably of the form workload!name
 };
 
 /**
@@ -180,6 +185,7 @@ struct ExecuteJobMessage
 struct KillJobsMessage
 {
     std::vector<JobIdentifier> job_ids; //!< The IDs of the jobs to kill
+    std::vector<JobPtr> jobs; //!< The jobs to kill, in the same order as job_ids. Filled by the server.
 };
 
 /**
@@ -274,6 +280,19 @@ struct StopCallMeLaterMessage
     std::string call_id; //!< The identifier of the CALL_ME_LATER to stop
 };
 
+/**
+ * @brief The immutable description of a probe, shared by all the data it emits
+ */
+struct ProbeMetadata
+{
+    std::string probe_id; //!< The identifier of the probe
+    batprotocol::fb::Metrics metrics; //!< The metrics that is probed
+    batprotocol::fb::Resources resource_type; //!< The type of resources that are probed
+    IntervalSet hosts; //!< The probed hosts (only defined if resources are hosts)
+    std::string hosts_str; //!< The probed hosts as a hyphenated string, as sent to the EDC (only defined if resources are hosts)
+    std::shared_ptr<std::vector<std::string>> links; //!< The probed links (only defined if resources are links)
+};
+
 struct CreateProbeMessage
 {
     std::string probe_id; //!< The identifier of the probe
@@ -291,6 +310,12 @@ struct CreateProbeMessage
     Periodic periodic; //!< Defines all periodic information for periodic calls
     bool initialized; //!< For periodic probes, whether they were already reset or not
 
+    std::shared_ptr<const ProbeMetadata> metadata; //!< The immutable description of the probe, set by the server when the probe is created
+    std::vector<simgrid::s4u::Host*> probed_hosts; //!< The SimGrid hosts of the probed machines, resolved once when the probe is created
+    std::vector<double> probed_values; //!< The buffer in which the values of the probed hosts are measured at each trigger
+    std::vector<double> accumulation_origin; //!< For accumulative probes with reset, the value of the energy counter of each host at the last reset
+    double accumulation_origin_time = 0; //!< For accumulative probes, the time (in seconds) of the last reset
+
     batprotocol::fb::ProbeDataAccumulationStrategy data_accumulation_strategy; //!< How probed data should be accumulated over several triggers
     batprotocol::fb::ResetMode data_accumulation_reset_mode; //!< If data should be accumulated, how the accumulated value should be reset at each trigger?
     double data_accumulation_reset_value; //!< If data should be accumulated and reset, this is the value to set after reading the counter
@@ -312,13 +337,7 @@ struct StopProbeMessage
 };
 
 struct ProbeData {
-    std::string probe_id; //!< The identifier of the probe
-
-    batprotocol::fb::Resources resource_type; //!< The type of resources that should be probed
-    IntervalSet hosts; //!< The hosts to probe (only defined if resources are hosts)
-    std::vector<std::string> links; //!< The links to probe (only defined if resources are links)
-
-    batprotocol::fb::Metrics metrics; //!< The metrics that should be probed
+    std::shared_ptr<const ProbeMetadata> metadata; //!< The immutable description of the probe that emitted the data
 
     batprotocol::fb::ProbeData data_type; //!< Whether the emitted data is raw vectorial data or an aggregation
     double aggregated_data; //!< Stores the actual data when it is an aggregation over several resources
@@ -362,7 +381,7 @@ struct KillingDoneMessage
 struct ExternalEventsOccurredMessage
 {
     std::string submitter_name;          //!< The name of the submitter which submitted the events.
-    std::vector<const ExternalEvent *> occurred_events; //!< The list of Event that occurred
+    std::vector<const ExternalEvent *> occurred_events; //!< The list of Event that occurred. The events are owned by the message.
 };
 
 /**
@@ -377,6 +396,7 @@ struct IPMessage
     ~IPMessage();
     IPMessageType type; //!< The message type
     void * data; //!< The message data. Can be NULL for message types without associated data. Otherwise, the C++ type depends on the message type.
+    InstanceCounter<IPMessage> instance_counter; //!< Counts IPMessage instances (for real execution statistics)
 };
 
 /**
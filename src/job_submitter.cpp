@@ -9,6 +9,10 @@
 #include <algorithm>
 #include <boost/bind.hpp>
 #include <memory>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <unordered_map>
 
 #include <simgrid/s4u.hpp>
 
@@ -16,6 +20,10 @@
 #include "jobs_execution.hpp"
 #include "ipp.hpp"
 #include "context.hpp"
+#include "profiles.hpp"
+#include "swf.hpp"
+#include "workload.hpp"
+#include "workload_generator.hpp"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(job_submitter, "job_submitter"); //!< Logging
 
@@ -73,6 +81,7 @@ void static_job_submitter_process(BatsimContext * context,
     long double current_submission_date = static_cast<long double>(simgrid::s4u::Engine::get_clock());
 
     // sort jobs by arrival date in a temporary vector
+    // (the server cannot modify the workload yet, as none of its jobs has been submitted)
     vector<JobPtr> jobs_to_submit_vector;
     const auto & jobs = workload->jobs->jobs();
     for (const auto & mit : jobs)
@@ -90,7 +99,6 @@ void static_job_submitter_process(BatsimContext * context,
     if (jobs_to_submit.size() > 0)
     {
         vector<JobPtr> jobs_to_send;
-        bool is_first_job = true;
 
         for ( ; !jobs_to_submit.empty() ; jobs_to_submit.pop_front())
         {
@@ -110,23 +118,323 @@ void static_job_submitter_process(BatsimContext * context,
 
             // Populate the vector of job identifiers to submit
             jobs_to_send.push_back(job);
+        }
+
+        // Send last vector of submitted jobs
+        submit_jobs_to_server(jobs_to_send, submitter_name);
+    }
+
+    SubmitterByeMessage * bye_msg = new SubmitterByeMessage;
+    bye_msg->submitter_name = submitter_name;
+    bye_msg->submitter_type = SubmitterType::JOB_SUBMITTER;
+    send_message("server", IPMessageType::SUBMITTER_BYE, static_cast<void*>(bye_msg));
+}
+
+/**
+ * @brief A job of a workflow, as tracked by its submitter
+ */
+struct WorkflowNode
+{
+    JobPtr job; //!< The job. Reset once the job is over, so that the job can be freed.
+    unsigned int nb_pending_dependencies = 0; //!< The number of jobs that must still complete before the job is submitted
+    std::vector<JobIdentifier> successors; //!< The jobs that depend on this job
+    bool dropped = false; //!< Whether the job will never be submitted, as one of the jobs it depends on has not completed successfully
+};
+
+void workflow_job_submitter_process(BatsimContext * context,
+                                    std::string workload_name)
+{
+    xbt_assert(context->workloads.exists(workload_name),
+               "Error: a workflow_job_submitter_process is in charge of workload '%s', "
+               "which does not exist", workload_name.c_str());
+
+    Workload * workload = context->workloads.at(workload_name);
+
+    string submitter_name = workload_name + "_submitter";
 
-            if (is_first_job)
+    // Completion callbacks are sent asynchronously by the server, they must be received even while the submitter sleeps
+    auto mailbox = simgrid::s4u::Mailbox::by_name(submitter_name);
+    mailbox->set_receiver(simgrid::s4u::Actor::self());
+
+    SubmitterHelloMessage * hello_msg = new SubmitterHelloMessage;
+    hello_msg->submitter_name = submitter_name;
+    hello_msg->enable_callback_on_job_completion = true;
+    hello_msg->submitter_type = SubmitterType::JOB_SUBMITTER;
+
+    send_message("server", IPMessageType::SUBMITTER_HELLO, static_cast<void*>(hello_msg));
+
+    // Build the dependency graph (its validity has been checked when the workload was loaded)
+    // Jobs whose dependencies are resolved are released at their submission time, or when their last dependency completes
+    std::unordered_map<JobIdentifier, WorkflowNode, JobIdentifierHasher> nodes;
+    std::multimap<long double, JobIdentifier> released_jobs;
+    const auto & jobs = workload->jobs->jobs();
+    nodes.reserve(jobs.size());
+    for (const auto & mit : jobs)
+    {
+        const JobPtr & job = mit.second;
+        WorkflowNode & node = nodes[job->id];
+        node.job = job;
+        node.nb_pending_dependencies = static_cast<unsigned int>(job->dependencies.size());
+        for (const JobIdentifier & dependency : job->dependencies)
+        {
+            nodes[dependency].successors.push_back(job->id);
+        }
+
+        if (job->dependencies.empty())
+        {
+            released_jobs.emplace(job->submission_time, job->id);
+        }
+    }
+
+    const size_t nb_jobs = nodes.size();
+    size_t nb_finished_jobs = 0;
+    size_t nb_dropped_jobs = 0;
+
+    while (nb_finished_jobs + nb_dropped_jobs < nb_jobs)
+    {
+        // Submit the jobs whose dependencies are resolved and whose submission time is reached
+        const long double now = static_cast<long double>(simgrid::s4u::Engine::get_clock());
+        vector<JobPtr> jobs_to_send;
+        while (!released_jobs.empty() && released_jobs.begin()->first <= now)
+        {
+            WorkflowNode & node = nodes.at(released_jobs.begin()->second);
+            node.job->submission_time = std::max(node.job->submission_time, now);
+            jobs_to_send.push_back(node.job);
+            released_jobs.erase(released_jobs.begin());
+        }
+        submit_jobs_to_server(jobs_to_send, submitter_name);
+
+        // Wait for a job to finish, or for the submission time of the next released job
+        IPMessage * message = nullptr;
+        try
+        {
+            if (released_jobs.empty())
             {
-                is_first_job = false;
-                if (context->energy_first_job_submission < 0)
+                message = mailbox->get<IPMessage>();
+            }
+            else
+            {
+                message = mailbox->get<IPMessage>(static_cast<double>(released_jobs.begin()->first - now));
+            }
+        }
+        catch (const simgrid::TimeoutException &)
+        {
+            continue;
+        }
+
+        xbt_assert(message->type == IPMessageType::SUBMITTER_CALLBACK,
+                   "The workflow submitter of workload '%s' received an unexpected message of type %s",
+                   workload_name.c_str(), ip_message_type_to_string(message->type).c_str());
+        auto * callback = static_cast<SubmitterJobCompletionCallbackMessage *>(message->data);
+
+        WorkflowNode & finished_node = nodes.at(callback->job_id);
+        finished_node.job = nullptr;
+        ++nb_finished_jobs;
+
+        if (callback->job_state == JobState::JOB_STATE_COMPLETED_SUCCESSFULLY)
+        {
+            for (const JobIdentifier & successor_id : finished_node.successors)
+            {
+                WorkflowNode & successor = nodes.at(successor_id);
+                if (--successor.nb_pending_dependencies == 0 && !successor.dropped)
+                {
+                    released_jobs.emplace(std::max(successor.job->submission_time, now), successor_id);
+                }
+            }
+        }
+        else
+        {
+            // Jobs that depend on an unsuccessful job are never submitted
+            vector<JobIdentifier> jobs_to_drop = finished_node.successors;
+            while (!jobs_to_drop.empty())
+            {
+                WorkflowNode & node = nodes.at(jobs_to_drop.back());
+                jobs_to_drop.pop_back();
+                if (!node.dropped)
                 {
-                    context->energy_first_job_submission = context->machines.total_consumed_energy(context);
+                    node.dropped = true;
+                    node.job = nullptr;
+                    ++nb_dropped_jobs;
+                    jobs_to_drop.insert(jobs_to_drop.end(), node.successors.begin(), node.successors.end());
                 }
             }
         }
 
-        // Send last vector of submitted jobs
-        submit_jobs_to_server(jobs_to_send, submitter_name);
+        delete message;
+    }
+
+    XBT_INFO("All the jobs of workflow '%s' are over (%zu jobs finished, %zu jobs not submitted as they depend on unsuccessful jobs).",
+             workload_name.c_str(), nb_finished_jobs, nb_dropped_jobs);
+
+    SubmitterByeMessage * bye_msg = new SubmitterByeMessage;
+    bye_msg->submitter_name = submitter_name;
+    bye_msg->submitter_type = SubmitterType::JOB_SUBMITTER;
+    send_message("server", IPMessageType::SUBMITTER_BYE, static_cast<void*>(bye_msg));
+}
+
+/**
+ * @brief Returns the profile of a streamed (SWF or generated) job, creating it if no job in memory uses it
+ * @details Jobs with the same runtime share their profile.
+ *          Profiles are registered in the workload by the server when their jobs are submitted, as workloads are only modified by the server.
+ * @param[in] workload The workload of the job
+ * @param[in,out] profiles The profiles created by the submitter, by name
+ * @param[in] streamed_job The job
+ * @param[in] options How SWF jobs are mapped to profiles
+ * @return The profile of the job
+ */
+static ProfilePtr streamed_job_profile(const Workload * workload,
+                                       std::unordered_map<std::string, std::weak_ptr<Profile> > & profiles,
+                                       const SwfJob & streamed_job,
+                                       const SwfWorkloadOptions & options)
+{
+    const string profile_name = runtime_profile_name(workload->name, streamed_job.runtime, options);
+
+    // Profiles are freed once their last job is deleted, they are then created again if needed
+    auto profile_it = profiles.find(profile_name);
+    if (profile_it != profiles.end())
+    {
+        ProfilePtr profile = profile_it->second.lock();
+        if (profile != nullptr)
+        {
+            return profile;
+        }
     }
 
+    ProfilePtr profile = new_runtime_profile(profile_name, streamed_job.runtime, options);
+    profiles[profile_name] = profile;
+    return profile;
+}
+
+/**
+ * @brief Submits jobs produced one by one, creating each job right before its submission
+ * @param[in] context The BatsimContext
+ * @param[in] workload_name The name of the (initially empty) workload attached to the submitter
+ * @param[in] next_job Produces the next job, returns false once all the jobs have been produced. Jobs should be produced by submission time.
+ * @param[in] options How produced jobs are mapped to profiles and walltimes
+ */
+static void streamed_job_submitter(BatsimContext * context,
+                                   const std::string & workload_name,
+                                   const std::function<bool(SwfJob &)> & next_job,
+                                   const SwfWorkloadOptions & options)
+{
+    Workload * workload = context->workloads.at(workload_name);
+
+    string submitter_name = workload_name + "_submitter";
+
+    SubmitterHelloMessage * hello_msg = new SubmitterHelloMessage;
+    hello_msg->submitter_name = submitter_name;
+    hello_msg->enable_callback_on_job_completion = false;
+    hello_msg->submitter_type = SubmitterType::JOB_SUBMITTER;
+
+    send_message("server", IPMessageType::SUBMITTER_HELLO, static_cast<void*>(hello_msg));
+
+    long double current_submission_date = static_cast<long double>(simgrid::s4u::Engine::get_clock());
+
+    vector<JobPtr> jobs_to_send;
+    std::unordered_map<std::string, std::weak_ptr<Profile> > profiles;
+    double first_submission_time = 0;
+    unsigned int nb_submitted_jobs = 0;
+    unsigned int nb_skipped_jobs = 0;
+
+    SwfJob streamed_job;
+    while (next_job(streamed_job))
+    {
+        // Submission times are translated so that the first job is submitted at time 0,
+        // as tools/swf_to_batsim_workload_*.py do with --translate_submit_times
+        if (nb_submitted_jobs == 0 && nb_skipped_jobs == 0)
+        {
+            first_submission_time = streamed_job.submission_time;
+        }
+
+        // Jobs outside of the time window are never simulated. Streams are sorted, nothing is simulated after the window.
+        const long double submission_time = static_cast<long double>(streamed_job.submission_time - first_submission_time);
+        if (context->time_window.skips(submission_time))
+        {
+            if (submission_time > context->time_window.end)
+            {
+                break;
+            }
+            ++nb_skipped_jobs;
+            continue;
+        }
+
+        auto job = std::make_shared<Job>();
+        job->workload = workload;
+        job->id = JobIdentifier(workload->name, streamed_job.id);
+        job->starting_time = -1;
+        job->runtime = -1;
+        job->state = JobState::JOB_STATE_NOT_SUBMITTED;
+        job->consumed_energy = -1;
+        job->submission_time = submission_time;
+        job->walltime = static_cast<long double>(std::max(streamed_job.requested_time, options.walltime_factor * streamed_job.runtime));
+        job->requested_nb_res = static_cast<unsigned int>(streamed_job.nb_res);
+
+        // Jobs produced out of submission time order are submitted as soon as they are produced
+        if (job->submission_time > current_submission_date)
+        {
+            // Next job submission time is after current time, send the message to the server for previous submitted jobs
+            submit_jobs_to_server(jobs_to_send, submitter_name);
+            jobs_to_send.clear();
+
+            // Now let's sleep until it's time to submit the current job
+            simgrid::s4u::this_actor::sleep_for(static_cast<double>(job->submission_time - current_submission_date));
+            current_submission_date = static_cast<long double>(simgrid::s4u::Engine::get_clock());
+        }
+
+        // The profile is only retrieved now, as it may have been freed while sleeping
+        job->profile = streamed_job_profile(workload, profiles, streamed_job, options);
+
+        // The server registers the job in its workload
+        jobs_to_send.push_back(job);
+        ++nb_submitted_jobs;
+    }
+
+    // Send last vector of submitted jobs
+    submit_jobs_to_server(jobs_to_send, submitter_name);
+
+    XBT_INFO("All the jobs of workload '%s' have been submitted (%u jobs, %u skipped before the time window).",
+             workload_name.c_str(), nb_submitted_jobs, nb_skipped_jobs);
+
     SubmitterByeMessage * bye_msg = new SubmitterByeMessage;
     bye_msg->submitter_name = submitter_name;
     bye_msg->submitter_type = SubmitterType::JOB_SUBMITTER;
     send_message("server", IPMessageType::SUBMITTER_BYE, static_cast<void*>(bye_msg));
 }
+
+void swf_job_submitter_process(BatsimContext * context,
+                               std::string workload_name,
+                               SwfWorkloadOptions options)
+{
+    xbt_assert(context->workloads.exists(workload_name),
+               "Error: a swf_job_submitter_process is in charge of workload '%s', "
+               "which does not exist", workload_name.c_str());
+
+    SwfReader reader(context->workloads.at(workload_name)->filename);
+    streamed_job_submitter(context, workload_name,
+                           [&reader](SwfJob & job) { return reader.read_job(job); },
+                           options);
+
+    XBT_INFO("%u jobs of SWF workload '%s' have been skipped.", reader.nb_skipped_jobs(), workload_name.c_str());
+}
+
+void generated_job_submitter_process(BatsimContext * context,
+                                     std::string workload_name,
+                                     SwfWorkloadOptions options,
+                                     GeneratorWorkloadOptions generator_options)
+{
+    xbt_assert(context->workloads.exists(workload_name),
+               "Error: a generated_job_submitter_process is in charge of workload '%s', "
+               "which does not exist", workload_name.c_str());
+
+    // Without nb_res, jobs are generated for all the compute machines of the platform
+    int nb_res = options.nb_res;
+    if (nb_res == -1)
+    {
+        nb_res = static_cast<int>(context->machines.nb_compute_machines());
+    }
+
+    WorkloadGenerator generator(generator_options, nb_res);
+    streamed_job_submitter(context, workload_name,
+                           [&generator](SwfJob & job) { return generator.next_job(job); },
+                           options);
+}
@@ -7,6 +7,9 @@
 
 #include <string>
 
+#include "swf.hpp"
+#include "workload_generator.hpp"
+
 struct BatsimContext;
 
 /**
@@ -16,3 +19,38 @@ struct BatsimContext;
  */
 void static_job_submitter_process(BatsimContext * context,
                                   std::string workload_name);
+
+/**
+ * @brief The process in charge of submitting the jobs of a workflow (a static workload whose jobs depend on other jobs)
+ * @details A job is submitted once all the jobs it depends on have completed successfully, but not before its submission time.
+ *          Jobs that depend (even indirectly) on a job that failed, was killed or was rejected are never submitted.
+ * @param[in] context The BatsimContext
+ * @param[in] workload_name The name of the workload attached to the submitter
+ */
+void workflow_job_submitter_process(BatsimContext * context,
+                                    std::string workload_name);
+
+/**
+ * @brief The process in charge of submitting the jobs of a SWF workload
+ * @details Jobs are read from the SWF file and created right before their submission,
+ *          so that the whole trace is never held in memory.
+ * @param[in] context The BatsimContext
+ * @param[in] workload_name The name of the (initially empty) workload attached to the submitter
+ * @param[in] options How jobs are read from the SWF file
+ */
+void swf_job_submitter_process(BatsimContext * context,
+                               std::string workload_name,
+                               SwfWorkloadOptions options);
+
+/**
+ * @brief The process in charge of submitting the jobs of a generated workload
+ * @details Jobs are generated right before their submission, so that memory usage does not depend on the number of jobs.
+ * @param[in] context The BatsimContext
+ * @param[in] workload_name The name of the (initially empty) workload attached to the submitter
+ * @param[in] options How generated jobs are mapped to profiles and walltimes. Jobs are generated for nb_res resources (all compute machines if -1).
+ * @param[in] generator_options How jobs are generated
+ */
+void generated_job_submitter_process(BatsimContext * context,
+                                     std::string workload_name,
+                                     SwfWorkloadOptions options,
+                                     GeneratorWorkloadOptions generator_options);
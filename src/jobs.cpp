@@ -161,7 +161,7 @@ void Jobs::set_workload(Workload *workload)
     _workload = workload;
 }
 
-void Jobs::load_from_json(const rapidjson::Document &doc, const std::string &filename)
+void Jobs::load_from_json(const rapidjson::Document &doc, const std::string &filename, const TimeWindow & time_window)
 {
     string error_prefix = "Invalid JSON file '" + filename + "'";
 
@@ -170,17 +170,115 @@ void Jobs::load_from_json(const rapidjson::Document &doc, const std::string &fil
     const Value & jobs = doc["jobs"];
     xbt_assert(jobs.IsArray(), "%s: the 'jobs' member is not an array", error_prefix.c_str());
 
+    unsigned int nb_skipped_jobs = 0;
     for (SizeType i = 0; i < jobs.Size(); i++) // Uses SizeType instead of size_t
     {
         const Value & job_json_description = jobs[i];
 
+        // Jobs outside of the time window are never simulated
+        if (time_window.enabled && job_json_description.IsObject() && job_json_description.HasMember("subtime") &&
+            job_json_description["subtime"].IsNumber() &&
+            time_window.skips(static_cast<long double>(job_json_description["subtime"].GetDouble())))
+        {
+            ++nb_skipped_jobs;
+            continue;
+        }
+
         auto j = Job::from_json(job_json_description, _workload, error_prefix);
 
         xbt_assert(!exists(j->id), "%s: duplication of job id '%s'",
                    error_prefix.c_str(), j->id.to_string().c_str());
         _jobs[j->id] = j;
         _jobs_met.insert({j->id, true});
+        ++j->profile->nb_referencing_jobs;
+    }
+
+    if (nb_skipped_jobs > 0)
+    {
+        XBT_INFO("%u jobs of file '%s' are outside of the time window and have been skipped.", nb_skipped_jobs, filename.c_str());
     }
+
+    check_dependencies(filename, time_window);
+}
+
+void Jobs::check_dependencies(const std::string & filename, const TimeWindow & time_window)
+{
+    string error_prefix = "Invalid workload file '" + filename + "'";
+
+    // Number of unresolved dependencies and successors of each job, to detect cycles (Kahn's algorithm)
+    std::unordered_map<JobIdentifier, unsigned int, JobIdentifierHasher> nb_pending_dependencies;
+    std::unordered_map<JobIdentifier, vector<JobIdentifier>, JobIdentifierHasher> successors;
+    unsigned int nb_dropped_dependencies = 0;
+    _has_dependencies = false;
+
+    for (auto & mit : _jobs)
+    {
+        JobPtr job = mit.second;
+        auto & dependencies = job->dependencies;
+        for (auto dependency_it = dependencies.begin(); dependency_it != dependencies.end(); )
+        {
+            if (_jobs.count(*dependency_it) == 0)
+            {
+                xbt_assert(time_window.enabled, "%s: job '%s' depends on job '%s', which does not exist",
+                           error_prefix.c_str(), job->id.to_cstring(), dependency_it->to_cstring());
+                dependency_it = dependencies.erase(dependency_it);
+                ++nb_dropped_dependencies;
+                continue;
+            }
+
+            xbt_assert(!(*dependency_it == job->id), "%s: job '%s' depends on itself",
+                       error_prefix.c_str(), job->id.to_cstring());
+            successors[*dependency_it].push_back(job->id);
+            ++dependency_it;
+        }
+
+        nb_pending_dependencies[job->id] = static_cast<unsigned int>(dependencies.size());
+        _has_dependencies = _has_dependencies || !dependencies.empty();
+    }
+
+    if (nb_dropped_dependencies > 0)
+    {
+        XBT_INFO("%u dependencies of file '%s' are on jobs outside of the time window and have been dropped.",
+                 nb_dropped_dependencies, filename.c_str());
+    }
+
+    if (!_has_dependencies)
+    {
+        return;
+    }
+
+    vector<JobIdentifier> ready_jobs;
+    for (const auto & mit : nb_pending_dependencies)
+    {
+        if (mit.second == 0)
+        {
+            ready_jobs.push_back(mit.first);
+        }
+    }
+
+    size_t nb_ordered_jobs = 0;
+    while (!ready_jobs.empty())
+    {
+        JobIdentifier job_id = ready_jobs.back();
+        ready_jobs.pop_back();
+        ++nb_ordered_jobs;
+
+        for (const JobIdentifier & successor_id : successors[job_id])
+        {
+            if (--nb_pending_dependencies[successor_id] == 0)
+            {
+                ready_jobs.push_back(successor_id);
+            }
+        }
+    }
+
+    xbt_assert(nb_ordered_jobs == _jobs.size(), "%s: the dependencies between jobs form a cycle (%zu jobs are part of or depend on it)",
+               error_prefix.c_str(), _jobs.size() - nb_ordered_jobs);
+}
+
+bool Jobs::has_dependencies() const
+{
+    return _has_dependencies;
 }
 
 JobPtr Jobs::operator[](JobIdentifier job_id)
@@ -217,6 +315,7 @@ void Jobs::add_job(JobPtr job)
 
     _jobs[job->id] = job;
     _jobs_met.insert({job->id, true});
+    ++job->profile->nb_referencing_jobs;
 }
 
 void Jobs::delete_job(const JobIdentifier & job_id, const bool & garbage_collect_profiles)
@@ -225,13 +324,18 @@ void Jobs::delete_job(const JobIdentifier & job_id, const bool & garbage_collect
                "Bad Jobs::delete_job call: The job with name='%s' does not exist.",
                job_id.to_cstring());
 
-    std::string profile_name = _jobs[job_id]->profile->name;
-    Workload * profile_workload = _jobs[job_id]->profile->workload;
+    ProfilePtr profile = _jobs[job_id]->profile;
     _jobs.erase(job_id);
+    if (_forget_deleted_jobs)
+    {
+        _jobs_met.erase(job_id);
+    }
+    --profile->nb_referencing_jobs;
 
-    if (garbage_collect_profiles)
+    // The profile may be shared by other jobs, which keep it alive
+    if (garbage_collect_profiles && profile->nb_referencing_jobs == 0)
     {
-        profile_workload->profiles->remove_profile(profile_name);
+        profile->workload->profiles->remove_profile(profile->name);
     }
 }
 
@@ -241,20 +345,6 @@ bool Jobs::exists(const JobIdentifier & job_id) const
     return it != _jobs_met.end();
 }
 
-bool Jobs::contains_smpi_job() const
-{
-    xbt_assert(_profiles != nullptr, "Invalid Jobs::containsSMPIJob call: setProfiles had not been called yet");
-    for (auto & mit : _jobs)
-    {
-        auto job = mit.second;
-        if (job->profile->type == ProfileType::REPLAY_SMPI)
-        {
-            return true;
-        }
-    }
-    return false;
-}
-
 void Jobs::displayDebug() const
 {
     // Let us traverse jobs to display some information about them
@@ -289,6 +379,17 @@ int Jobs::nb_jobs() const
     return static_cast<int>(_jobs.size());
 }
 
+void Jobs::reserve(size_t nb_new_jobs)
+{
+    _jobs.reserve(_jobs.size() + nb_new_jobs);
+    _jobs_met.reserve(_jobs_met.size() + nb_new_jobs);
+}
+
+void Jobs::set_forget_deleted_jobs(bool forget_deleted_jobs)
+{
+    _forget_deleted_jobs = forget_deleted_jobs;
+}
+
 bool job_comparator_subtime_number(const JobPtr a, const JobPtr b)
 {
     if (a->submission_time == b->submission_time)
@@ -298,6 +399,32 @@ bool job_comparator_subtime_number(const JobPtr a, const JobPtr b)
     return a->submission_time < b->submission_time;
 }
 
+void JobExecutionActors::insert(const simgrid::s4u::ActorPtr & actor)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _actors.insert(actor);
+}
+
+void JobExecutionActors::erase(const simgrid::s4u::ActorPtr & actor)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _actors.erase(actor);
+}
+
+std::set<simgrid::s4u::ActorPtr> JobExecutionActors::take_all()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::set<simgrid::s4u::ActorPtr> actors;
+    actors.swap(_actors);
+    return actors;
+}
+
+size_t JobExecutionActors::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _actors.size();
+}
+
 Job::~Job()
 {
     XBT_INFO("Job '%s' is being deleted from workload %s", id.to_string().c_str(), workload->name.c_str());
@@ -429,6 +556,30 @@ JobPtr Job::from_json(const rapidjson::Value & json_desc,
                        error_prefix.c_str(), j->id.to_string().c_str());
     }
 
+    // Get the jobs this job depends on (optional)
+    if (json_desc.HasMember("dependencies"))
+    {
+        const Value & dependencies = json_desc["dependencies"];
+        xbt_assert(dependencies.IsArray(), "%s: job %s has a non-array 'dependencies' field",
+                   error_prefix.c_str(), j->id.to_string().c_str());
+        j->dependencies.reserve(dependencies.Size());
+        for (SizeType i = 0; i < dependencies.Size(); i++)
+        {
+            xbt_assert(dependencies[i].IsString() || dependencies[i].IsInt(),
+                       "%s: job %s has an invalid dependency, it should be a job id (string or integer)",
+                       error_prefix.c_str(), j->id.to_string().c_str());
+            string dependency_str = dependencies[i].IsString() ? dependencies[i].GetString() : to_string(dependencies[i].GetInt());
+            if (dependency_str.find(workload->name) == std::string::npos)
+            {
+                j->dependencies.push_back(JobIdentifier(workload->name, dependency_str));
+            }
+            else
+            {
+                j->dependencies.push_back(JobIdentifier(dependency_str));
+            }
+        }
+    }
+
     XBT_DEBUG("Job '%s' Loaded", j->id.to_string().c_str());
     return j;
 }
@@ -5,10 +5,13 @@
 
 #pragma once
 
+#include <map>
 #include <unordered_map>
 #include <vector>
 #include <deque>
 #include <memory>
+#include <mutex>
+#include <set>
 
 #include <rapidjson/document.h>
 
@@ -16,6 +19,8 @@
 
 #include <intervalset.hpp>
 
+#include "cli.hpp"
+#include "instance_counter.hpp"
 #include "pointers.hpp"
 
 class Profiles;
@@ -178,6 +183,7 @@ struct BatTask
 public:
     JobPtrWeak parent_job; //!< The parent job that owns this task
     ProfilePtr profile; //!< The task profile. The corresponding profile tells how the job should be computed
+    std::string position_in_job; //!< Where the task is in the compositions of the job (empty for the root task). Deterministic, unlike unique_name().
 
     // Manage parallel profiles
     simgrid::s4u::ExecPtr ptask = nullptr; //!< The final task to execute (only set for BatTask leaves with parallel profiles)
@@ -191,6 +197,54 @@ public:
     unsigned int current_repetition = static_cast<unsigned int>(-1); //!< The current repetition number (=iteration number) of the whole sequence.
     unsigned int current_task_index = static_cast<unsigned int>(-1); //!< Index of the task that is currently being executed in the sub_tasks vector. Only set for BatTask non-leaves with sequential profiles.
     double current_task_progress_ratio = -1; //!< Gives the progress of the current task from 0 to 1. Only set for BatTask non-leaves with sequential profiles.
+
+    // manage fork-join profile
+    std::map<unsigned int, simgrid::s4u::ActorPtr> branch_actors; //!< The actors of the branches that are still running, by branch index. Only set for BatTask non-leaves with fork-join profiles.
+
+    // manage the fast-forward of sequential profiles
+    double fast_forward_start = -1; //!< When the repetitions of the sequence started to be fast-forwarded. -1 if they are not being fast-forwarded.
+    double fast_forward_period = 0; //!< The simulated duration of one fast-forwarded repetition
+    unsigned int fast_forward_first_repetition = 0; //!< The first fast-forwarded repetition
+    std::vector<double> fast_forward_sub_task_durations; //!< The simulated duration of each profile of the sequence in a fast-forwarded repetition
+    double remaining_work_ratio = 1; //!< The fraction of the work of the profile that remains to be done (below 1 when resuming an interrupted fast-forward). Only used by delay, parallel task and storage profiles.
+};
+
+/**
+ * @brief The actors that run a job
+ * @details Job actors add and remove their children while the server or a killer may kill all of them,
+ *          possibly on several threads with SimGrid parallel contexts: all accesses are protected by a mutex.
+ *          Actors are never killed while the mutex is held, as killing an actor is a simcall.
+ */
+class JobExecutionActors
+{
+public:
+    /**
+     * @brief Adds an actor
+     * @param[in] actor The actor
+     */
+    void insert(const simgrid::s4u::ActorPtr & actor);
+
+    /**
+     * @brief Removes an actor
+     * @param[in] actor The actor
+     */
+    void erase(const simgrid::s4u::ActorPtr & actor);
+
+    /**
+     * @brief Removes all the actors
+     * @return The removed actors, e.g., to kill them
+     */
+    std::set<simgrid::s4u::ActorPtr> take_all();
+
+    /**
+     * @brief Returns the number of actors
+     * @return The number of actors
+     */
+    size_t size() const;
+
+private:
+    mutable std::mutex _mutex; //!< Protects _actors
+    std::set<simgrid::s4u::ActorPtr> _actors; //!< The actors
 };
 
 /**
@@ -209,7 +263,7 @@ struct Job
     Workload * workload = nullptr; //!< The workload the job belongs to
     JobIdentifier id; //!< The job unique identifier
     BatTask * task = nullptr; //!< The root task be executed by this job (profile instantiation).
-    std::set<simgrid::s4u::ActorPtr> execution_actors; //!< The actors involved in running the job
+    JobExecutionActors execution_actors; //!< The actors involved in running the job
 
     // Execution information, as sent by the decision component
     std::shared_ptr<ExecuteJobMessage> execution_request; //!< The execution request as sent by the decision component via an EXECUTE_JOB event.
@@ -228,6 +282,9 @@ struct Job
     unsigned int requested_nb_res = 0; //!< The number of resources the job is requested to be executed on
     int return_code = -1; //!< The return code of the job
     std::string extra_data = ""; //!< User-given extra data. Not used by Batsim at all but forwarded to EDCs.
+    std::vector<JobIdentifier> dependencies; //!< The jobs of the same workload that must complete successfully before the job is submitted
+
+    InstanceCounter<Job> instance_counter; //!< Counts Job instances (for real execution statistics)
 
 public:
     /**
@@ -316,8 +373,24 @@ public:
      * @brief Loads the jobs from a JSON document
      * @param[in] doc The JSON document
      * @param[in] filename The name of the file the JSON document has been extracted from
+     * @param[in] time_window The simulated time window. Jobs outside of it are skipped.
+     */
+    void load_from_json(const rapidjson::Document & doc, const std::string & filename, const TimeWindow & time_window = TimeWindow());
+
+    /**
+     * @brief Checks the dependencies between the jobs once they have all been added
+     * @details Dependencies on jobs outside of the time window are dropped, as these jobs are never simulated.
+     * @param[in] filename The name of the file the jobs come from
+     * @param[in] time_window The simulated time window
+     * @pre Dependencies are on existing jobs (or on jobs outside of the time window) and do not form cycles
+     */
+    void check_dependencies(const std::string & filename, const TimeWindow & time_window = TimeWindow());
+
+    /**
+     * @brief Returns whether some jobs depend on other jobs
+     * @return Whether some jobs depend on other jobs
      */
-    void load_from_json(const rapidjson::Document & doc, const std::string & filename);
+    bool has_dependencies() const;
 
     /**
      * @brief Accesses one job thanks to its identifier
@@ -370,12 +443,6 @@ public:
      */
     bool exists(const JobIdentifier & job_id) const;
 
-    /**
-     * @brief Allows to know whether the Jobs contains any SMPI job
-     * @return True if the number of SMPI jobs in the Jobs is greater than 0.
-     */
-    bool contains_smpi_job() const;
-
     /**
      * @brief Displays the contents of the Jobs class (debug purpose)
      */
@@ -399,11 +466,27 @@ public:
      */
     int nb_jobs() const;
 
+    /**
+     * @brief Reserves memory so that a given number of jobs can be added without rehashing
+     * @param[in] nb_new_jobs The number of jobs that are about to be added
+     */
+    void reserve(size_t nb_new_jobs);
+
+    /**
+     * @brief Sets whether the identifiers of deleted jobs should be forgotten
+     * @details By default, deleted jobs are remembered so that they are still considered to exist.
+     *          Streamed workloads forget them, so that their memory usage does not grow with the number of jobs.
+     * @param[in] forget_deleted_jobs Whether the identifiers of deleted jobs should be forgotten
+     */
+    void set_forget_deleted_jobs(bool forget_deleted_jobs);
+
 private:
     std::unordered_map<JobIdentifier, JobPtr, JobIdentifierHasher> _jobs; //!< The map that contains the jobs
     std::unordered_map<JobIdentifier, bool, JobIdentifierHasher> _jobs_met; //!< Stores the jobs id already met during the simulation
     Profiles * _profiles = nullptr; //!< The profiles associated with the jobs
     Workload * _workload = nullptr; //!< The Workload the jobs belong to
+    bool _has_dependencies = false; //!< Whether some jobs depend on other jobs
+    bool _forget_deleted_jobs = false; //!< Whether the identifiers of deleted jobs are removed from _jobs_met
 };
 
 /**
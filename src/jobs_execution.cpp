@@ -4,20 +4,319 @@
  */
 #include <algorithm>
 #include <cmath>
+#include <list>
+#include <map>
+#include <mutex>
 #include <regex>
 
 #include "jobs_execution.hpp"
+#include "internal_tracing.hpp"
 #include "jobs.hpp"
 #include "task_execution.hpp"
 #include "server.hpp"
 
 #include <simgrid/s4u.hpp>
+#include <simgrid/simix.hpp>
 #include <simgrid/plugins/energy.h>
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(jobs_execution, "jobs_execution"); //!< Logging
 
 using namespace std;
 
+/**
+ * @brief Returns whether the repetitions of a sequence profile can be fast-forwarded
+ * @details The repetitions of a sequence can be fast-forwarded if they always last the same time while the platform
+ *          sharing does not change, which is the case if all its profiles are delays or parallel tasks.
+ * @param[in] data The data of the sequence profile
+ * @param[out] nb_shared_sub_profiles The number of profiles of the sequence that use shared resources (parallel tasks)
+ * @return Whether the repetitions of the sequence can be fast-forwarded
+ */
+static bool sequence_can_be_fast_forwarded(const SequenceProfileData * data, unsigned int & nb_shared_sub_profiles)
+{
+    nb_shared_sub_profiles = 0;
+    for (const auto & sub_profile : data->profile_sequence)
+    {
+        switch (sub_profile->type)
+        {
+        case ProfileType::DELAY:
+            break;
+        case ProfileType::PTASK:
+        case ProfileType::PTASK_HOMOGENEOUS:
+        case ProfileType::PTASK_ON_STORAGE_HOMOGENEOUS:
+        case ProfileType::PTASK_DATA_STAGING_BETWEEN_STORAGES:
+        case ProfileType::PTASK_MERGE_COMPOSITION:
+            ++nb_shared_sub_profiles;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Skips the next repetitions of a sequence profile without simulating them, until they are all done,
+ *        the walltime is reached or the platform sharing changes
+ * @details If the platform sharing changes, the repetitions completed at the previous rate are skipped and the caller
+ *          resumes the repetition in progress from the sub-task that was running, with the work that remains to be done,
+ *          then simulates the next repetitions normally.
+ * @param[in,out] btask The task of the sequence profile. Its progress information is stored within it.
+ * @param[in,out] context The BatsimContext
+ * @param[in] first_repetition The first repetition to skip
+ * @param[in] period The simulated duration of one repetition
+ * @param[in] sub_task_durations The simulated duration of each profile of the sequence in one repetition
+ * @param[in] uses_shared_resources Whether the sequence uses shared resources, in which case changes in the platform sharing stop the fast-forward
+ * @param[in,out] remaining_time The remaining time of the current task. It will be automatically killed if 0 is reached.
+ * @param[out] nb_fast_forwarded The number of repetitions that have been skipped
+ * @param[out] resume_task_index The index in the sequence of the sub-task to resume after an interruption
+ * @param[out] resume_work_ratio The fraction of the work of the resumed sub-task that remains to be done
+ * @return 0 on success, -1 on timeout (remaining time reached 0)
+ */
+static int fast_forward_sequence(
+    BatTask * btask,
+    BatsimContext * context,
+    unsigned int first_repetition,
+    double period,
+    const std::vector<double> & sub_task_durations,
+    bool uses_shared_resources,
+    double * remaining_time,
+    unsigned int & nb_fast_forwarded,
+    unsigned int & resume_task_index,
+    double & resume_work_ratio)
+{
+    auto * data = static_cast<SequenceProfileData *>(btask->profile->data);
+    const unsigned int nb_left = data->repetition_count - first_repetition;
+    const double start = simgrid::s4u::Engine::get_clock();
+
+    double duration = nb_left * period;
+    bool reaches_walltime = false;
+    if (*remaining_time >= 0 && *remaining_time < duration)
+    {
+        duration = *remaining_time;
+        reaches_walltime = true;
+    }
+
+    XBT_DEBUG("Fast-forwarding repetitions [%u, %u[ of job '%s' (profile '%s'), each lasting %g",
+              first_repetition, data->repetition_count, JobPtr(btask->parent_job)->id.to_cstring(),
+              btask->profile->name.c_str(), period);
+
+    // A sub-task is kept so that the progress of the sequence can be reported on kill
+    btask->fast_forward_start = start;
+    btask->fast_forward_period = period;
+    btask->fast_forward_first_repetition = first_repetition;
+    btask->fast_forward_sub_task_durations = sub_task_durations;
+    btask->sub_tasks.push_back(new BatTask(JobPtr(btask->parent_job), data->profile_sequence[0]));
+
+    bool interrupted = false;
+    if (!uses_shared_resources)
+    {
+        simgrid::s4u::this_actor::sleep_for(duration);
+    }
+    else
+    {
+        xbt_assert(context->platform_change_cv != nullptr, "Internal error: sequences are fast-forwarded but platform changes are not notified");
+
+        // Notifiers hold the mutex with parallel contexts: no change can be missed between the count check and the wait
+        std::unique_lock<simgrid::s4u::Mutex> lock(*context->platform_change_mutex);
+        const unsigned long long platform_change_count = context->platform_change_count;
+        while (context->platform_change_count == platform_change_count &&
+               simgrid::s4u::Engine::get_clock() < start + duration)
+        {
+            context->platform_change_cv->wait_until(lock, start + duration);
+        }
+        interrupted = (context->platform_change_count != platform_change_count);
+    }
+
+    const double elapsed = simgrid::s4u::Engine::get_clock() - start;
+    resume_task_index = 0;
+    resume_work_ratio = 1;
+    if (interrupted)
+    {
+        // Only the work done before the change progressed at the measured rate: the repetitions that completed are
+        // skipped, and the caller resumes the sub-task in progress with the work it had left at the new rate
+        reaches_walltime = false;
+        nb_fast_forwarded = (period > 0) ? std::min(nb_left, static_cast<unsigned int>(std::floor(elapsed / period))) : nb_left;
+        if (nb_fast_forwarded < nb_left)
+        {
+            double offset = elapsed - nb_fast_forwarded * period;
+            while (resume_task_index < sub_task_durations.size() && offset >= sub_task_durations[resume_task_index])
+            {
+                offset -= sub_task_durations[resume_task_index];
+                ++resume_task_index;
+            }
+
+            if (resume_task_index == sub_task_durations.size())
+            {
+                // Rounding errors only: the repetition in progress was just done
+                ++nb_fast_forwarded;
+                resume_task_index = 0;
+            }
+            else
+            {
+                resume_work_ratio = 1 - offset / sub_task_durations[resume_task_index];
+            }
+        }
+    }
+
+    if (reaches_walltime)
+    {
+        nb_fast_forwarded = (period > 0) ? std::min(nb_left, static_cast<unsigned int>(std::floor(elapsed / period))) : nb_left;
+        update_fast_forward_progress(btask);
+    }
+    else if (!interrupted)
+    {
+        nb_fast_forwarded = nb_left;
+    }
+
+    if (*remaining_time >= 0)
+    {
+        *remaining_time = std::max(0.0, *remaining_time - elapsed);
+    }
+    context->nb_fast_forwarded_repetitions += nb_fast_forwarded;
+
+    btask->fast_forward_start = -1;
+    for (auto * sub_btask : btask->sub_tasks)
+    {
+        delete sub_btask;
+    }
+    btask->sub_tasks.clear();
+
+    return reaches_walltime ? -1 : 0;
+}
+
+/**
+ * @brief Kills the actors of the fork-join branches that still run within a task, recursively
+ * @details Each killed actor is waited for: once it has terminated, the tasks it executed are no longer accessed
+ *          and can be released, except by the branches of the fork-join compositions nested within them.
+ * @param[in] job The job of the task
+ * @param[in,out] btask The task
+ */
+static void kill_branch_actors(const JobPtr & job, BatTask * btask)
+{
+    for (auto mit : btask->branch_actors)
+    {
+        job->execution_actors.erase(mit.second);
+        mit.second->kill();
+    }
+    for (auto mit : btask->branch_actors)
+    {
+        mit.second->join();
+    }
+    btask->branch_actors.clear();
+
+    for (auto * sub_btask : btask->sub_tasks)
+    {
+        kill_branch_actors(job, sub_btask);
+    }
+}
+
+/**
+ * @brief Executes the sub-profiles of a fork-join composition concurrently, each in its own actor
+ * @param[in,out] btask The task to execute. Its sub-tasks are stored within it while they run.
+ * @param[in] context The BatsimContext
+ * @param[in] execute_job_msg The message that started the job
+ * @param[in,out] remaining_time The remaining time of the current task. It will be automatically killed if 0 is reached.
+ * @return 0 if all the sub-profiles succeeded, the return code of the first failing sub-profile otherwise
+ *         (-1 on timeout, -2 on task cancelled)
+ */
+static int execute_forkjoin_composition(
+    BatTask * btask,
+    BatsimContext * context,
+    const std::shared_ptr<ExecuteJobMessage> & execute_job_msg,
+    double * remaining_time)
+{
+    auto job = JobPtr(btask->parent_job);
+    auto * data = static_cast<ForkJoinCompositionProfileData *>(btask->profile->data);
+    const unsigned int nb_branches = static_cast<unsigned int>(data->profiles.size());
+
+    // A semaphore + list is used to enable child actors to tell the current actor that they have finished.
+    // The list is shared with the children, as they may still finish after the current actor has been killed.
+    auto & child_actors = btask->branch_actors;
+    simgrid::s4u::SemaphorePtr sem_termination = simgrid::s4u::Semaphore::create(0);
+    auto list_termination = std::make_shared<std::list<std::pair<unsigned int, int> > >();
+
+    xbt_assert(btask->sub_tasks.empty(), "internal inconsistency: there should be no current sub_tasks");
+    btask->sub_tasks.reserve(nb_branches);
+    for (unsigned int branch = 0; branch < nb_branches; ++branch)
+    {
+        BatTask * sub_btask = new BatTask(job, data->profiles[branch]);
+        sub_btask->position_in_job = btask->position_in_job + "_f" + std::to_string(branch);
+        btask->sub_tasks.push_back(sub_btask);
+    }
+    const std::vector<BatTask *> branch_tasks = btask->sub_tasks;
+
+    // Only the branches that are still running are kept in the sub-tasks, so that the kill progress only reports them
+    auto release_branch_task = [btask, &branch_tasks](unsigned int branch)
+    {
+        auto it = std::find(btask->sub_tasks.begin(), btask->sub_tasks.end(), branch_tasks[branch]);
+        xbt_assert(it != btask->sub_tasks.end(), "Internal error: the task of branch %u has already been released", branch);
+        btask->sub_tasks.erase(it);
+        delete branch_tasks[branch];
+    };
+
+    for (unsigned int branch = 0; branch < nb_branches; ++branch)
+    {
+        BatTask * sub_btask = branch_tasks[branch];
+        const double branch_remaining_time = *remaining_time;
+        std::string actor_name = job->id.to_string() + "_fj" + std::to_string(branch);
+
+        // Each branch uses its own copy of the remaining time, so that it times out by itself
+        auto actor = simgrid::s4u::Engine::get_instance()->add_actor(actor_name, simgrid::s4u::this_actor::get_host(),
+            [sub_btask, context, execute_job_msg, branch_remaining_time, sem_termination, list_termination, branch]()
+            {
+                double branch_time = branch_remaining_time;
+                int return_code = execute_task(sub_btask, context, execute_job_msg, &branch_time);
+                list_termination->push_back({branch, return_code});
+                sem_termination->release();
+            });
+
+        child_actors[branch] = actor;
+        job->execution_actors.insert(actor);
+    }
+
+    // Wait until all branches have finished, or until one of them fails.
+    const double time_before_wait = simgrid::s4u::Engine::get_clock();
+    int return_code = 0;
+    while (!child_actors.empty())
+    {
+        sem_termination->acquire();
+        auto [finished_branch, branch_return_code] = list_termination->front();
+        list_termination->pop_front();
+
+        xbt_assert(child_actors.count(finished_branch) == 1, "Internal error: unexpected branch received (%u)", finished_branch);
+        job->execution_actors.erase(child_actors[finished_branch]);
+        child_actors.erase(finished_branch);
+        release_branch_task(finished_branch);
+
+        // The whole composition fails if a branch fails
+        if (branch_return_code != 0)
+        {
+            return_code = branch_return_code;
+
+            // Killed branches reference their task until they have terminated, as do the branches nested within them
+            std::vector<unsigned int> killed_branches;
+            for (auto mit : child_actors)
+            {
+                killed_branches.push_back(mit.first);
+            }
+            kill_branch_actors(job, btask);
+            for (unsigned int killed_branch : killed_branches)
+            {
+                release_branch_task(killed_branch);
+            }
+        }
+    }
+
+    if (*remaining_time >= 0)
+    {
+        *remaining_time = std::max(0.0, *remaining_time - (simgrid::s4u::Engine::get_clock() - time_before_wait));
+    }
+
+    xbt_assert(btask->sub_tasks.empty(), "Internal error: fork-join branches have not all been released");
+
+    return return_code;
+}
+
 int execute_task(
     BatTask * btask,
     BatsimContext *context,
@@ -35,9 +334,6 @@ int execute_task(
         alloc_placement = alloc_placement_it->second;
     }
 
-    // TODO: generate final hosts to use (from allocated hosts, profile data, placement strategy or custom mapping)
-    // should be quite simple for profile_type != composition_ptask_merge
-
     switch(profile->type)
     {
         case ProfileType::PTASK:
@@ -57,9 +353,22 @@ int execute_task(
         {
             auto * data = static_cast<SequenceProfileData *>(profile->data);
 
+            unsigned int nb_shared_sub_profiles = 0;
+            const bool can_fast_forward = context->fast_forward_sequences && data->repetition_count > 2 &&
+                                          sequence_can_be_fast_forwarded(data, nb_shared_sub_profiles);
+            std::vector<double> sub_task_durations(can_fast_forward ? data->sequence_names.size() : 0);
+
+            // Where to resume the repetition that was in progress when a fast-forward was interrupted
+            unsigned int resume_task_index = 0;
+            double resume_work_ratio = 1;
+
             for (unsigned int sequence_iteration = 0; sequence_iteration < data->repetition_count; sequence_iteration++)
             {
-                for (unsigned int profile_index_in_sequence = 0;
+                const double iteration_start = simgrid::s4u::Engine::get_clock();
+                const unsigned long long platform_change_count_before = context->platform_change_count;
+                const bool is_resumed_iteration = (resume_task_index > 0 || resume_work_ratio < 1);
+
+                for (unsigned int profile_index_in_sequence = resume_task_index;
                     profile_index_in_sequence < data->sequence_names.size();
                     profile_index_in_sequence++)
                 {
@@ -70,17 +379,55 @@ int execute_task(
                     xbt_assert(btask->sub_tasks.empty(), "internal inconsistency: there should be no current sub_tasks");
                     auto sub_profile = data->profile_sequence[profile_index_in_sequence];
                     BatTask * sub_btask = new BatTask(JobPtr(btask->parent_job), sub_profile);
+                    sub_btask->position_in_job = btask->position_in_job + "_s" + std::to_string(sequence_iteration) + "." + std::to_string(profile_index_in_sequence);
+                    if (profile_index_in_sequence == resume_task_index)
+                    {
+                        sub_btask->remaining_work_ratio = resume_work_ratio;
+                    }
                     btask->sub_tasks.push_back(sub_btask);
 
+                    const double sub_task_start = simgrid::s4u::Engine::get_clock();
                     int ret_last_profile = execute_task(sub_btask, context, execute_job_msg, remaining_time);
 
-                    btask->sub_tasks.clear();
-
                     // The whole sequence fails if a subtask fails
                     if (ret_last_profile != 0)
                     {
                         return ret_last_profile;
                     }
+
+                    if (can_fast_forward)
+                    {
+                        sub_task_durations[profile_index_in_sequence] = simgrid::s4u::Engine::get_clock() - sub_task_start;
+                    }
+                    btask->sub_tasks.clear();
+                    delete sub_btask;
+                }
+                resume_task_index = 0;
+                resume_work_ratio = 1;
+
+                // The first repetition may start while other jobs start. A later repetition during which the
+                // platform sharing did not change (only this repetition's own parallel tasks started and ended)
+                // lasts exactly as long as the next ones, as long as the platform sharing still does not change.
+                // A resumed repetition only did part of the work, so it cannot be used as a period.
+                // Skipped repetitions do not load the platform: this is only exact if no other activity runs
+                // (which would otherwise be sped up), and if the energy consumed by the computations is not measured.
+                if (can_fast_forward && sequence_iteration > 0 && !is_resumed_iteration && sequence_iteration + 1 < data->repetition_count &&
+                    (nb_shared_sub_profiles == 0 ||
+                     (!context->energy_used &&
+                      context->nb_running_trace_replays == 0 &&
+                      context->nb_running_activities == 0 &&
+                      context->platform_change_count - platform_change_count_before == 2 * nb_shared_sub_profiles)))
+                {
+                    unsigned int nb_fast_forwarded = 0;
+                    int ret_fast_forward = fast_forward_sequence(btask, context, sequence_iteration + 1,
+                        simgrid::s4u::Engine::get_clock() - iteration_start, sub_task_durations,
+                        nb_shared_sub_profiles > 0, remaining_time, nb_fast_forwarded, resume_task_index, resume_work_ratio);
+                    sequence_iteration += nb_fast_forwarded;
+
+                    if (ret_fast_forward != 0)
+                    {
+                        return ret_fast_forward;
+                    }
                 }
             }
             return profile->return_code;
@@ -90,9 +437,9 @@ int execute_task(
             auto * data = static_cast<DelayProfileData *>(profile->data);
 
             btask->delay_task_start = simgrid::s4u::Engine::get_clock();
-            btask->delay_task_required = data->delay;
+            btask->delay_task_required = data->delay * btask->remaining_work_ratio;
 
-            if (do_delay_task(data->delay, remaining_time) == -1)
+            if (do_delay_task(btask->delay_task_required, remaining_time) == -1)
             {
                 return -1;
             }
@@ -100,13 +447,23 @@ int execute_task(
         }
         case ProfileType::FORKJOIN_COMPOSITION:
         {
-            xbt_die("Execution of ForkJoin Composition profiles is not implemented yet");
-            //TODO implement me
+            int return_code = execute_forkjoin_composition(btask, context, execute_job_msg, remaining_time);
+            if (return_code != 0)
+            {
+                return return_code;
+            }
+
+            return profile->return_code;
         }
         case ProfileType::PTASK_MERGE_COMPOSITION:
         {
-            xbt_die("Execution of Parallel Task Merge Composition profiles is not implemented yet");
-            //TODO implement me
+            int return_code = execute_parallel_task_merge(btask, execute_job_msg, alloc_placement, remaining_time, context);
+            if (return_code != 0)
+            {
+                return return_code;
+            }
+
+            return profile->return_code;
         }
         case ProfileType::REPLAY_SMPI:
         case ProfileType::REPLAY_USAGE:
@@ -167,21 +524,24 @@ void execute_job_process(
 {
     job->starting_time = static_cast<long double>(simgrid::s4u::Engine::get_clock());
     double remaining_time = static_cast<double>(job->walltime);
+
+#ifdef BATSIM_TRACE_INTERNALS
+    if (internal_tracing::is_enabled())
+    {
+        // The job actor can be killed, its end is traced whenever it terminates
+        const std::string job_id = job->id.to_string();
+        BATSIM_TRACE_ASYNC('b', "job", "job_actor", job_id);
+        simgrid::s4u::this_actor::on_exit([job_id](bool) {
+            BATSIM_TRACE_ASYNC('e', "job", "job_actor", job_id);
+        });
+    }
+#endif
     const auto & execution_request = job->execution_request;
 
     // Create the root task
     job->task = new BatTask(job, job->profile);
 
-    if (context->energy_used)
-    {
-        // If energy is enabled, compute the energy used by the machines before running the job
-        job->consumed_energy = consumed_energy_on_machines(context, execution_request->job_allocation->hosts);
-
-        // Trace the consumed energy
-        context->energy_tracer.add_job_start(simgrid::s4u::Engine::get_clock(), job->id);
-    }
-
-    context->machines.update_machines_on_job_run(job, execution_request->job_allocation->hosts, context);
+    // Machines, energy and tracers are updated by the server when the job starts and ends, as job actors may run on several threads
 
     // Execute the task
     job->return_code = execute_task(job->task, context, execution_request, &remaining_time);
@@ -210,7 +570,6 @@ void execute_job_process(
         xbt_die("Job '%s' completed with unknown return code: %d", job->id.to_cstring(), job->return_code);
     }
 
-    context->machines.update_machines_on_job_end(job, execution_request->job_allocation->hosts, context);
     job->runtime = static_cast<long double>(simgrid::s4u::Engine::get_clock()) - job->starting_time;
     if (job->runtime == 0)
     {
@@ -218,17 +577,6 @@ void execute_job_process(
         job->runtime = 1e-5l;
     }
 
-    // If energy is enabled, let us compute the energy used by the machines after running the job
-    if (context->energy_used)
-    {
-        // The consumed energy is the difference (consumed_energy_after_job - consumed_energy_before_job)
-        long double consumed_energy_before = job->consumed_energy;
-        job->consumed_energy = consumed_energy_on_machines(context, execution_request->job_allocation->hosts) - consumed_energy_before;
-
-        // Let's trace the consumed energy
-        context->energy_tracer.add_job_end(simgrid::s4u::Engine::get_clock(), job->id);
-    }
-
     if (notify_server_at_end and job->state != JobState::JOB_STATE_COMPLETED_KILLED)
     {
         // The completion of a killed job is already managed in server_on_killing_done
@@ -239,8 +587,6 @@ void execute_job_process(
 
         send_message("server", IPMessageType::JOB_COMPLETED, static_cast<void*>(message));
     }
-
-    job->execution_actors.erase(simgrid::s4u::Actor::self());
 }
 
 void oneshot_call_me_later_actor(std::string call_id, double target_time, ServerData * server_data)
@@ -278,6 +624,54 @@ void oneshot_call_me_later_actor(std::string call_id, double target_time, Server
     }
 }
 
+void update_fast_forward_progress(BatTask * btask)
+{
+    if (btask->fast_forward_start >= 0)
+    {
+        auto * data = static_cast<SequenceProfileData *>(btask->profile->data);
+        const double now = simgrid::s4u::Engine::get_clock();
+        const double elapsed = now - btask->fast_forward_start;
+        const unsigned int nb_left = data->repetition_count - btask->fast_forward_first_repetition;
+
+        unsigned int nb_done = 0;
+        double offset_in_repetition = 0;
+        if (btask->fast_forward_period > 0)
+        {
+            nb_done = std::min(nb_left - 1, static_cast<unsigned int>(std::floor(elapsed / btask->fast_forward_period)));
+            offset_in_repetition = elapsed - nb_done * btask->fast_forward_period;
+        }
+
+        const auto & durations = btask->fast_forward_sub_task_durations;
+        unsigned int task_index = 0;
+        double task_start_offset = 0;
+        while (task_index + 1 < durations.size() && offset_in_repetition >= task_start_offset + durations[task_index])
+        {
+            task_start_offset += durations[task_index];
+            ++task_index;
+        }
+
+        btask->current_repetition = btask->fast_forward_first_repetition + nb_done;
+        btask->current_task_index = task_index;
+
+        // Delay sub-tasks compute their progress from these fields
+        xbt_assert(btask->sub_tasks.size() == 1, "internal inconsistency: a fast-forwarded sequence should have one sub_task");
+        BatTask * sub_btask = btask->sub_tasks[0];
+        if (sub_btask->profile != data->profile_sequence[task_index])
+        {
+            delete sub_btask;
+            sub_btask = new BatTask(JobPtr(btask->parent_job), data->profile_sequence[task_index]);
+            btask->sub_tasks[0] = sub_btask;
+        }
+        sub_btask->delay_task_start = now - (offset_in_repetition - task_start_offset);
+        sub_btask->delay_task_required = durations[task_index];
+    }
+
+    for (auto * sub_btask : btask->sub_tasks)
+    {
+        update_fast_forward_progress(sub_btask);
+    }
+}
+
 bool cancel_ptasks(BatTask * btask)
 {
     bool cancelled = false;
@@ -312,9 +706,10 @@ void killer_process(
     message->kill_jobs_message = kill_jobs_msg;
     message->acknowledge_kill_on_protocol = acknowledge_kill_on_protocol;
 
-    for (auto job_id : kill_jobs_msg->job_ids)
+    // Jobs have been retrieved by the server, as workloads are only accessed by the server
+    for (const JobPtr & job : kill_jobs_msg->jobs)
     {
-        auto job = context->workloads.job_at(job_id);
+        const JobIdentifier & job_id = job->id;
         xbt_assert(! (job->state == JobState::JOB_STATE_REJECTED ||
                       job->state == JobState::JOB_STATE_SUBMITTED ||
                       job->state == JobState::JOB_STATE_NOT_SUBMITTED),
@@ -327,9 +722,13 @@ void killer_process(
             auto task = job->task;
             xbt_assert(task != nullptr, "Internal error");
 
-            // Compute and store the kill progress of this job in the message
-            auto kill_progress = protocol::battask_to_kill_progress(task);
-            message->jobs_progress[job_id.to_string()] = kill_progress;
+            // Compute and store the kill progress of this job in the message.
+            // Job actors may add or delete sub-tasks concurrently with parallel contexts: the task tree is only read
+            // in the kernel context, which never runs at the same time as actors.
+            simgrid::kernel::actor::simcall_answered([message, &job_id, task] {
+                update_fast_forward_progress(task);
+                message->jobs_progress[job_id.to_string()] = protocol::battask_to_kill_progress(task);
+            });
 
             // Store the job profile if required
             if (context->forward_profiles_on_jobs_killed)
@@ -345,18 +744,17 @@ void killer_process(
                 // There was no ptask running, directly kill the actors
 
                 // Kill all the involved processes
-                xbt_assert(job->execution_actors.size() > 0, "kill inconsistency: no actors to kill while job's task could not be cancelled");
-                for (simgrid::s4u::ActorPtr actor : job->execution_actors)
+                auto actors = job->execution_actors.take_all();
+                xbt_assert(actors.size() > 0, "kill inconsistency: no actors to kill while job's task could not be cancelled");
+                for (simgrid::s4u::ActorPtr actor : actors)
                 {
                     XBT_INFO("Killing process '%s'", actor->get_cname());
                     actor->kill();
                 }
-                job->execution_actors.clear();
 
-                // Update the job information
+                // Update the job information. Machines are updated by the server once the kill is done.
                 job->state = killed_job_state;
 
-                context->machines.update_machines_on_job_end(job, job->execution_request->job_allocation->hosts, context);
                 job->runtime = static_cast<long double>(simgrid::s4u::Engine::get_clock()) - job->starting_time;
 
                 xbt_assert(job->runtime >= 0, "Negative runtime of killed job '%s' (%Lg)!", job_id.to_cstring(), job->runtime);
@@ -366,19 +764,6 @@ void killer_process(
                              job_id.to_cstring());
                     job->runtime = 1e-5l;
                 }
-
-                // If energy is enabled, let us compute the energy used by the machines after running the job
-                if (context->energy_used)
-                {
-                    long double consumed_energy_before = job->consumed_energy;
-                    job->consumed_energy = consumed_energy_on_machines(context, job->execution_request->job_allocation->hosts);
-
-                    // The consumed energy is the difference (consumed_energy_after_job - consumed_energy_before_job)
-                    job->consumed_energy = job->consumed_energy - consumed_energy_before;
-
-                    // Trace the consumed energy
-                    context->energy_tracer.add_job_end(simgrid::s4u::Engine::get_clock(), job_id);
-                }
             }
             // Else the running ptask was asked to cancel by itself.
             // The job process will regularly terminate with the status JOB_STATE_COMPLETED_KILLED
@@ -71,3 +71,11 @@ void oneshot_call_me_later_actor(std::string call_id, double target_time, Server
  * @return True if one or more ptasks have been cancelled by this call, false otherwise
  */
 bool cancel_ptasks(BatTask * btask);
+
+/**
+ * @brief Updates the progress information of the fast-forwarded sequences of this BatTask (recursively), if any
+ * @details Fast-forwarded sequences do not simulate their repetitions, so their current repetition, task index and
+ *          sub-task are computed from the current simulated time.
+ * @param[in,out] btask The BatTask whose progress should be updated
+ */
+void update_fast_forward_progress(BatTask * btask);
@@ -470,6 +470,7 @@ void Machines::update_machines_on_job_run(const JobPtr job,
 
         machine->jobs_being_computed.insert(job);
     }
+    context->notify_platform_change();
 
     if (context->trace_machine_states)
     {
@@ -493,6 +494,7 @@ void Machines::update_machines_on_job_end(const JobPtr job,
         (void) ret; // Avoids a warning if assertions are ignored
         xbt_assert(ret == 1, "could not erase job '%s' from jobs being computed of machine %d", job->id.to_cstring(), machine_id);
     }
+    context->notify_platform_change();
 
     if (context->trace_machine_states)
     {
@@ -13,6 +13,7 @@
 #include "context.hpp"
 #include "ipp.hpp"
 #include "machines.hpp"
+#include "probe_aggregation.hpp"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(periodic, "periodic"); //!< Logging
 
@@ -165,6 +166,61 @@ void generate_static_periodic_schedule(
   }
 }
 
+static bool is_resetting_probe(const CreateProbeMessage * probe) {
+  return probe->data_accumulation_strategy == batprotocol::fb::ProbeDataAccumulationStrategy_ProbeDataAccumulation &&
+         probe->data_accumulation_reset_mode == batprotocol::fb::ResetMode_ProbeAccumulationReset;
+}
+
+/**
+ * @brief Restarts the accumulation of a probe with reset from the current energy counters
+ * @param[in,out] probe The probe
+ */
+static void reset_probe(CreateProbeMessage * probe) {
+  const size_t nb_hosts = probe->probed_hosts.size();
+  probe->accumulation_origin.resize(nb_hosts);
+  for (size_t i = 0; i < nb_hosts; ++i)
+    probe->accumulation_origin[i] = sg_host_get_consumed_energy(probe->probed_hosts[i]);
+  probe->accumulation_origin_time = simgrid::s4u::Engine::get_clock();
+}
+
+/**
+ * @brief Measures the current value of a probe on each of its hosts, into probe->probed_values
+ * @details Non-accumulative probes measure the current power (W) of the hosts.
+ *          Accumulative probes measure the energy (J) consumed since the beginning of the simulation,
+ *          or reset_value plus the energy consumed since the last reset for probes with reset.
+ *          Temporal normalization divides the accumulated value by the time elapsed since the accumulation started.
+ * @param[in,out] probe The probe
+ */
+static void measure_probe(CreateProbeMessage * probe) {
+  const auto & hosts = probe->probed_hosts;
+  auto & values = probe->probed_values;
+  const size_t nb_hosts = hosts.size();
+
+  if (probe->data_accumulation_strategy == batprotocol::fb::ProbeDataAccumulationStrategy_NoProbeDataAccumulation) {
+    for (size_t i = 0; i < nb_hosts; ++i)
+      values[i] = sg_host_get_current_consumption(hosts[i]);
+    return;
+  }
+
+  for (size_t i = 0; i < nb_hosts; ++i)
+    values[i] = sg_host_get_consumed_energy(hosts[i]);
+
+  if (is_resetting_probe(probe)) {
+    const double reset_value = probe->data_accumulation_reset_value;
+    const double * origin = probe->accumulation_origin.data();
+    for (size_t i = 0; i < nb_hosts; ++i)
+      values[i] = reset_value + (values[i] - origin[i]);
+  }
+
+  if (probe->data_accumulation_temporal_normalization) {
+    const double elapsed = simgrid::s4u::Engine::get_clock() - probe->accumulation_origin_time;
+    if (elapsed > 0) {
+      for (size_t i = 0; i < nb_hosts; ++i)
+        values[i] /= elapsed;
+    }
+  }
+}
+
 void periodic_main_actor(BatsimContext * context)
 {
   auto mbox = simgrid::s4u::Mailbox::by_name("periodic");
@@ -308,39 +364,33 @@ void periodic_main_actor(BatsimContext * context)
           xbt_assert(probe->resource_type == batprotocol::fb::Resources_HostResources, "only the host resource type is implemented");
           xbt_assert(context->energy_used, "trying to probe energy on hosts but the 'host_energy' SimGrid plugin has not been enabled");
 
-          // TODO: populate the immutable fields only once, then just memcpy this for a new probe? or just put the original probe data into the message? (requires smart ptr)
-          auto * probe_data = new ProbeData;
-          probe_data->probe_id = probe->probe_id;
-          probe_data->resource_type = probe->resource_type;
-          probe_data->hosts = probe->hosts;
-          probe_data->metrics = probe->metrics;
+          measure_probe(probe);
 
+          auto * probe_data = new ProbeData;
+          probe_data->metadata = probe->metadata;
           probe_data->manually_triggered = false;
           probe_data->nb_triggered = 0; // TODO: implement me
           probe_data->nb_emitted = 0; // TODO: implement me
           probe_data->is_last_periodic = !probe->periodic.is_infinite && probe->periodic.nb_periods == 1;
 
-          // TODO: populate an iterator of s4u hosts once per probe to avoid this slow traversal + host retrieval
-          probe_data->vectorial_data.reserve(probe->hosts.size());
-          for (auto it = probe->hosts.elements_begin(); it != probe->hosts.elements_end(); ++it)
-          {
-              int machine_id = *it;
-              Machine * machine = context->machines[machine_id];
-              probe_data->vectorial_data.emplace_back(sg_host_get_consumed_energy(machine->host));
-          }
-
+          auto & values = probe->probed_values;
           switch(probe->resource_agregation_type) {
             case batprotocol::fb::ResourcesAggregationFunction_NoResourcesAggregation: {
               probe_data->data_type = batprotocol::fb::ProbeData_VectorialProbeData;
+              probe_data->vectorial_data = values;
+            } break;
+            case batprotocol::fb::ResourcesAggregationFunction_Sum: {
+              probe_data->data_type = batprotocol::fb::ProbeData_AggregatedProbeData;
+              probe_data->aggregated_data = probe_sum(values.data(), values.size());
             } break;
-            case batprotocol::fb::ResourcesAggregationFunction_Sum:
             case batprotocol::fb::ResourcesAggregationFunction_ArithmeticMean: {
               probe_data->data_type = batprotocol::fb::ProbeData_AggregatedProbeData;
-              probe_data->aggregated_data = 0.0;
-              for (const auto & value : probe_data->vectorial_data)
-                probe_data->aggregated_data += value;
-              if (probe->resource_agregation_type == batprotocol::fb::ResourcesAggregationFunction_ArithmeticMean)
-                probe_data->aggregated_data /= probe->hosts.size();
+              probe_data->aggregated_data = probe_mean(values.data(), values.size());
+            } break;
+            case batprotocol::fb::ResourcesAggregationFunction_QuantileFunction: {
+              // values is a scratch buffer overwritten at each trigger, it can be reordered
+              probe_data->data_type = batprotocol::fb::ProbeData_AggregatedProbeData;
+              probe_data->aggregated_data = probe_quantile(values.data(), values.size(), probe->quantile_threshold);
             } break;
             default: {
               xbt_assert(false, "unimplemented resource aggregation type");
@@ -368,9 +418,8 @@ void periodic_main_actor(BatsimContext * context)
       // Reset probes
       for (auto * probe : slice.probes) {
         probe->initialized = true;
-        xbt_assert(probe->data_accumulation_strategy == batprotocol::fb::ProbeDataAccumulationStrategy_ProbeDataAccumulation, "non-accumulative probes are not supported right now");
-        xbt_assert(probe->data_accumulation_reset_mode == batprotocol::fb::ResetMode_NoReset, "accumulative probes with reset are not implemented");
-        // TODO: implement reset
+        if (is_resetting_probe(probe))
+          reset_probe(probe);
       }
 
       send_message("server", IPMessageType::PERIODIC_TRIGGER, static_cast<void*>(msg));
@@ -0,0 +1,64 @@
+/**
+ * @file probe_aggregation.cpp
+ * @brief Aggregation of the values measured by probes over several resources
+ */
+
+#include "probe_aggregation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+//! The number of independent partial sums of probe_sum, which matches the width of AVX2 registers
+static const size_t NB_PARTIAL_SUMS = 4;
+
+double probe_sum(const double * values, size_t nb_values)
+{
+    double partial_sums[NB_PARTIAL_SUMS] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + NB_PARTIAL_SUMS <= nb_values; i += NB_PARTIAL_SUMS)
+    {
+        for (size_t j = 0; j < NB_PARTIAL_SUMS; ++j)
+        {
+            partial_sums[j] += values[i + j];
+        }
+    }
+
+    double sum = (partial_sums[0] + partial_sums[1]) + (partial_sums[2] + partial_sums[3]);
+    for (; i < nb_values; ++i)
+    {
+        sum += values[i];
+    }
+    return sum;
+}
+
+double probe_mean(const double * values, size_t nb_values)
+{
+    if (nb_values == 0)
+    {
+        return 0;
+    }
+    return probe_sum(values, nb_values) / static_cast<double>(nb_values);
+}
+
+double probe_quantile(double * values, size_t nb_values, double threshold)
+{
+    if (nb_values == 0)
+    {
+        return 0;
+    }
+
+    const double position = std::clamp(threshold, 0.0, 1.0) * static_cast<double>(nb_values - 1);
+    const size_t lower_rank = static_cast<size_t>(std::floor(position));
+    const double weight = position - static_cast<double>(lower_rank);
+
+    std::nth_element(values, values + lower_rank, values + nb_values);
+    const double lower = values[lower_rank];
+    if (weight == 0 || lower_rank + 1 >= nb_values)
+    {
+        return lower;
+    }
+
+    // After nth_element, the next order statistic is the minimum of the values after the lower one
+    const double upper = *std::min_element(values + lower_rank + 1, values + nb_values);
+    return lower + weight * (upper - lower);
+}
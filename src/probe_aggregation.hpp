@@ -0,0 +1,35 @@
+/**
+ * @file probe_aggregation.hpp
+ * @brief Aggregation of the values measured by probes over several resources
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Computes the sum of some values
+ * @details Several partial sums are computed independently, so that the compiler can vectorize the loop without reordering floating-point operations itself.
+ * @param[in] values The values
+ * @param[in] nb_values The number of values
+ * @return The sum of the values (0 if there is no value)
+ */
+double probe_sum(const double * values, size_t nb_values);
+
+/**
+ * @brief Computes the arithmetic mean of some values
+ * @param[in] values The values
+ * @param[in] nb_values The number of values
+ * @return The mean of the values (0 if there is no value)
+ */
+double probe_mean(const double * values, size_t nb_values);
+
+/**
+ * @brief Computes a quantile of some values in linear time (std::nth_element)
+ * @details The quantile is linearly interpolated between the two closest values, as numpy.quantile does by default.
+ * @param[in,out] values The values, which are reordered
+ * @param[in] nb_values The number of values
+ * @param[in] threshold The quantile to compute, in [0,1] (0.5 is the median)
+ * @return The quantile of the values (0 if there is no value)
+ */
+double probe_quantile(double * values, size_t nb_values, double threshold);
@@ -5,6 +5,8 @@
 
 #include "profiles.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
@@ -25,6 +27,74 @@ namespace fs = std::filesystem;
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(profiles, "profiles"); //!< Logging
 
+std::shared_ptr<const UsageTrace> load_usage_trace(const std::string & filename)
+{
+    // Traces are only kept in the cache while some profile uses them
+    static std::unordered_map<std::string, std::weak_ptr<const UsageTrace> > cache;
+
+    auto cache_it = cache.find(filename);
+    if (cache_it != cache.end())
+    {
+        auto trace = cache_it->second.lock();
+        if (trace != nullptr)
+        {
+            return trace;
+        }
+    }
+
+    ifstream trace_file(filename);
+    xbt_assert(trace_file.is_open(), "Cannot open usage trace file '%s'", filename.c_str());
+
+    auto trace = std::make_shared<UsageTrace>();
+    string line;
+    int line_number = 0;
+    while (std::getline(trace_file, line))
+    {
+        ++line_number;
+        vector<string> tokens;
+        boost::split(tokens, line, boost::is_any_of(" \t"), boost::token_compress_on);
+        tokens.erase(std::remove(tokens.begin(), tokens.end(), ""), tokens.end());
+
+        // Empty lines and comments are ignored, as in SimGrid's replay files
+        if (tokens.empty() || tokens[0][0] == '#')
+        {
+            continue;
+        }
+
+        xbt_assert(tokens.size() >= 4 && tokens[1] == "m_usage",
+                   "Invalid usage trace file '%s': line %d is not a 'RANK m_usage USAGE FLOPS' action",
+                   filename.c_str(), line_number);
+
+        char * end = nullptr;
+        double usage = strtod(tokens[2].c_str(), &end);
+        xbt_assert(*end == '\0', "Invalid usage trace file '%s': line %d has an invalid usage ('%s')", filename.c_str(), line_number, tokens[2].c_str());
+        double flops = strtod(tokens[3].c_str(), &end);
+        xbt_assert(*end == '\0', "Invalid usage trace file '%s': line %d has an invalid flops amount ('%s')", filename.c_str(), line_number, tokens[3].c_str());
+        xbt_assert(isfinite(usage) && usage >= 0.0 && usage <= 1.0, "invalid usage read: %g not in [0,1]", usage);
+        xbt_assert(isfinite(flops) && flops >= 0.0, "invalid flops read: %g not positive and finite", flops);
+
+        trace->usages.push_back(usage);
+        trace->flops.push_back(flops);
+    }
+
+    trace->usages.shrink_to_fit();
+    trace->flops.shrink_to_fit();
+    XBT_DEBUG("Usage trace file '%s' parsed (%zu phases)", filename.c_str(), trace->usages.size());
+
+    cache[filename] = trace;
+    return trace;
+}
+
+void TraceReplayProfileData::load_usage_traces()
+{
+    usage_traces.clear();
+    usage_traces.reserve(trace_filenames.size());
+    for (const auto & trace_filename : trace_filenames)
+    {
+        usage_traces.push_back(load_usage_trace(fs::weakly_canonical(trace_filename).string()));
+    }
+}
+
 Profiles::~Profiles()
 {
     _profiles.clear();
@@ -54,7 +124,9 @@ void Profiles::load_from_json(const Document &doc, const string & filename)
         xbt_assert(!exists(string(key.GetString())), "%s: duplication of profile name '%s'",
                    error_prefix.c_str(), key.GetString());
 
+        intern_profile_data(profile);
         _profiles[profile_name] = profile;
+        _contains_smpi_profile = _contains_smpi_profile || profile->type == ProfileType::REPLAY_SMPI;
     }
 }
 
@@ -90,15 +162,32 @@ bool Profiles::exists(const std::string &profile_name) const
     return mit != _profiles.end();
 }
 
+bool Profiles::is_alive(const std::string &profile_name) const
+{
+    auto mit = _profiles.find(profile_name);
+    return mit != _profiles.end() && mit->second != nullptr;
+}
+
 void Profiles::add_profile(const std::string & profile_name,
                            ProfilePtr & profile)
 {
-    xbt_assert(!exists(profile_name),
+    xbt_assert(!is_alive(profile_name),
                "Bad Profiles::add_profile call: A profile with name='%s' already exists.",
                profile_name.c_str());
 
+    intern_profile_data(profile);
     _profiles[profile_name] = profile;
     profile->workload = _workload;
+    _contains_smpi_profile = _contains_smpi_profile || profile->type == ProfileType::REPLAY_SMPI;
+}
+
+void Profiles::remove_subprofile(const ProfilePtr & subprofile)
+{
+    // Sub-profiles still used directly by jobs in memory must remain accessible
+    if (subprofile->nb_referencing_jobs == 0)
+    {
+        remove_profile(subprofile->name);
+    }
 }
 
 void Profiles::remove_profile(const std::string & profile_name)
@@ -118,7 +207,23 @@ void Profiles::remove_profile(const std::string & profile_name)
         auto * profile_data = static_cast<SequenceProfileData*>(mit->second->data);
         for (const auto & subprofile : profile_data->profile_sequence)
         {
-            remove_profile(subprofile->name);
+            remove_subprofile(subprofile);
+        }
+    }
+    else if (mit->second->type == ProfileType::FORKJOIN_COMPOSITION)
+    {
+        auto * profile_data = static_cast<ForkJoinCompositionProfileData*>(mit->second->data);
+        for (const auto & subprofile : profile_data->profiles)
+        {
+            remove_subprofile(subprofile);
+        }
+    }
+    else if (mit->second->type == ProfileType::PTASK_MERGE_COMPOSITION)
+    {
+        auto * profile_data = static_cast<ParallelTaskMergeCompositionProfileData*>(mit->second->data);
+        for (const auto & subprofile : profile_data->profiles)
+        {
+            remove_subprofile(subprofile);
         }
     }
 
@@ -143,7 +248,7 @@ void Profiles::set_workload(Workload *workload)
     _workload = workload;
 }
 
-const std::unordered_map<std::string, ProfilePtr> Profiles::profiles() const
+const std::unordered_map<std::string, ProfilePtr> & Profiles::profiles() const
 {
     return _profiles;
 }
@@ -153,6 +258,11 @@ int Profiles::nb_profiles() const
     return static_cast<int>(_profiles.size());
 }
 
+bool Profiles::contains_smpi_profile() const
+{
+    return _contains_smpi_profile;
+}
+
 
 ParallelProfileData::~ParallelProfileData()
 {
@@ -168,9 +278,159 @@ ParallelProfileData::~ParallelProfileData()
     }
 }
 
-Profile::~Profile()
+bool ParallelProfileData::has_communications() const
+{
+    return com_format != CommunicationMatrixFormat::DENSE || com != nullptr;
+}
+
+void ParallelProfileData::for_each_transfer(const std::function<void(unsigned int, unsigned int, double)> & f) const
+{
+    switch (com_format)
+    {
+    case CommunicationMatrixFormat::DENSE:
+    {
+        if (com == nullptr)
+            return;
+
+        for (unsigned int sender = 0; sender < nb_res; ++sender)
+        {
+            for (unsigned int receiver = 0; receiver < nb_res; ++receiver)
+            {
+                const double bytes = com[static_cast<size_t>(sender) * nb_res + receiver];
+                if (bytes != 0)
+                    f(sender, receiver, bytes);
+            }
+        }
+    } break;
+    case CommunicationMatrixFormat::SPARSE:
+    {
+        for (unsigned int sender = 0; sender < nb_res; ++sender)
+        {
+            for (unsigned int k = com_row_offsets[sender]; k < com_row_offsets[sender + 1]; ++k)
+                f(sender, com_columns[k], com_values[k]);
+        }
+    } break;
+    case CommunicationMatrixFormat::RING:
+    {
+        if (nb_res < 2)
+            return;
+
+        for (unsigned int sender = 0; sender < nb_res; ++sender)
+        {
+            f(sender, (sender + 1) % nb_res, com_bytes);
+
+            // With 2 executors, the predecessor is also the successor
+            if (com_bidirectional && nb_res > 2)
+                f(sender, (sender + nb_res - 1) % nb_res, com_bytes);
+        }
+    } break;
+    case CommunicationMatrixFormat::STENCIL:
+    {
+        for (unsigned int sender = 0; sender < nb_res; ++sender)
+        {
+            // The stride of a dimension is the product of the sizes of the following dimensions
+            unsigned int stride = 1;
+            for (size_t d = com_dims.size(); d-- > 0; )
+            {
+                const unsigned int dim = com_dims[d];
+                const unsigned int coordinate = (sender / stride) % dim;
+
+                if (coordinate + 1 < dim)
+                    f(sender, sender + stride, com_bytes);
+                else if (com_periodic && dim > 2) // with 2 elements, the wrapped-around neighbour is also the previous one
+                    f(sender, sender - coordinate * stride, com_bytes);
+
+                if (coordinate > 0)
+                    f(sender, sender - stride, com_bytes);
+                else if (com_periodic && dim > 2)
+                    f(sender, sender + (dim - 1) * stride, com_bytes);
+
+                stride *= dim;
+            }
+        }
+    } break;
+    case CommunicationMatrixFormat::ALL_TO_ONE:
+    {
+        for (unsigned int sender = 0; sender < nb_res; ++sender)
+        {
+            if (sender != com_root)
+                f(sender, com_root, com_bytes);
+        }
+    } break;
+    case CommunicationMatrixFormat::BLOCK_DIAGONAL:
+    {
+        for (unsigned int sender = 0; sender < nb_res; ++sender)
+        {
+            const unsigned int block_begin = (sender / com_block_size) * com_block_size;
+            const unsigned int block_end = std::min(block_begin + com_block_size, nb_res);
+            for (unsigned int receiver = block_begin; receiver < block_end; ++receiver)
+            {
+                if (receiver != sender)
+                    f(sender, receiver, com_bytes);
+            }
+        }
+    } break;
+    }
+}
+
+void ParallelProfileData::fill_communication_matrix(std::vector<double> & matrix) const
+{
+    const size_t nb_values = static_cast<size_t>(nb_res) * nb_res;
+    if (com_format == CommunicationMatrixFormat::DENSE && com != nullptr)
+    {
+        matrix.assign(com, com + nb_values);
+        return;
+    }
+
+    matrix.assign(nb_values, 0.0);
+    for_each_transfer([&matrix, this](unsigned int sender, unsigned int receiver, double bytes)
+    {
+        // Transfers given several times are summed
+        matrix[static_cast<size_t>(sender) * nb_res + receiver] += bytes;
+    });
+}
+
+void ParallelProfileData::compress_communication_matrix()
+{
+    if (com_format != CommunicationMatrixFormat::DENSE || com == nullptr)
+        return;
+
+    const size_t nb_values = static_cast<size_t>(nb_res) * nb_res;
+    const size_t nb_non_zero = static_cast<size_t>(std::count_if(com, com + nb_values, [](double bytes) { return bytes != 0; }));
+    if (nb_non_zero > nb_values / 4)
+        return;
+
+    com_row_offsets.reserve(nb_res + 1);
+    com_columns.reserve(nb_non_zero);
+    com_values.reserve(nb_non_zero);
+
+    com_row_offsets.push_back(0);
+    for (unsigned int sender = 0; sender < nb_res; ++sender)
+    {
+        for (unsigned int receiver = 0; receiver < nb_res; ++receiver)
+        {
+            const double bytes = com[static_cast<size_t>(sender) * nb_res + receiver];
+            if (bytes != 0)
+            {
+                com_columns.push_back(receiver);
+                com_values.push_back(bytes);
+            }
+        }
+        com_row_offsets.push_back(static_cast<unsigned int>(com_columns.size()));
+    }
+
+    delete[] com;
+    com = nullptr;
+    com_format = CommunicationMatrixFormat::SPARSE;
+}
+
+/**
+ * @brief Deletes the data of a profile according to its type
+ * @param[in] type The type of the profile
+ * @param[in] data The data of the profile
+ */
+static void delete_profile_data(ProfileType type, void * data)
 {
-    XBT_INFO("Profile '%s' is being deleted (workload %s).", name.c_str(), workload->name.c_str());
     if (type == ProfileType::DELAY)
     {
         auto * d = static_cast<DelayProfileData *>(data);
@@ -225,6 +485,24 @@ Profile::~Profile()
             d = nullptr;
         }
     }
+    else if (type == ProfileType::FORKJOIN_COMPOSITION)
+    {
+        auto * d = static_cast<ForkJoinCompositionProfileData *>(data);
+        if (d != nullptr)
+        {
+            delete d;
+            d = nullptr;
+        }
+    }
+    else if (type == ProfileType::PTASK_MERGE_COMPOSITION)
+    {
+        auto * d = static_cast<ParallelTaskMergeCompositionProfileData *>(data);
+        if (d != nullptr)
+        {
+            delete d;
+            d = nullptr;
+        }
+    }
     else if (type == ProfileType::PTASK_ON_STORAGE_HOMOGENEOUS)
     {
         auto * d = static_cast<ParallelTaskOnStorageHomogeneousProfileData *>(data);
@@ -249,6 +527,473 @@ Profile::~Profile()
     }
 }
 
+Profile::~Profile()
+{
+    XBT_INFO("Profile '%s' is being deleted (workload %s).", name.c_str(), workload->name.c_str());
+
+    // Interned data is deleted with the last profile that shares it
+    if (shared_data == nullptr)
+    {
+        delete_profile_data(type, data);
+    }
+}
+
+/**
+ * @brief Combines a value into a hash
+ * @param[in,out] h The hash
+ * @param[in] value The hash of the value to combine
+ */
+static void hash_combine(size_t & h, size_t value)
+{
+    h ^= value + 0x9e3779b9 + (h << 6) + (h >> 2);
+}
+
+/**
+ * @brief Returns whether the data of profiles of a given type can be interned (shared by all the profiles with the same content)
+ * @details Composition profiles resolve their sub-profiles after loading, and trace replay profiles already share their traces.
+ * @param[in] type The type of the profiles
+ * @return Whether the data of profiles of this type can be interned
+ */
+static bool profile_data_is_internable(ProfileType type)
+{
+    return type == ProfileType::DELAY ||
+           type == ProfileType::PTASK ||
+           type == ProfileType::PTASK_HOMOGENEOUS ||
+           type == ProfileType::PTASK_ON_STORAGE_HOMOGENEOUS ||
+           type == ProfileType::PTASK_DATA_STAGING_BETWEEN_STORAGES;
+}
+
+/**
+ * @brief Computes the hash of the content of an internable profile data
+ * @param[in] type The type of the profile
+ * @param[in] data The data of the profile
+ * @return The hash of the data content
+ */
+static size_t profile_data_hash(ProfileType type, const void * data)
+{
+    size_t h = hash<int>()(static_cast<int>(type));
+    switch (type)
+    {
+    case ProfileType::DELAY: {
+        hash_combine(h, hash<double>()(static_cast<const DelayProfileData *>(data)->delay));
+    } break;
+    case ProfileType::PTASK: {
+        auto * d = static_cast<const ParallelProfileData *>(data);
+        hash_combine(h, hash<unsigned int>()(d->nb_res));
+        hash_combine(h, hash<int>()(static_cast<int>(d->com_format)));
+        if (d->cpu != nullptr)
+        {
+            for (unsigned int i = 0; i < d->nb_res; ++i)
+                hash_combine(h, hash<double>()(d->cpu[i]));
+        }
+        d->for_each_transfer([&h](unsigned int sender, unsigned int receiver, double bytes)
+        {
+            hash_combine(h, hash<unsigned int>()(sender));
+            hash_combine(h, hash<unsigned int>()(receiver));
+            hash_combine(h, hash<double>()(bytes));
+        });
+    } break;
+    case ProfileType::PTASK_HOMOGENEOUS: {
+        auto * d = static_cast<const ParallelHomogeneousProfileData *>(data);
+        hash_combine(h, hash<double>()(d->cpu));
+        hash_combine(h, hash<double>()(d->com));
+        hash_combine(h, hash<int>()(static_cast<int>(d->strategy)));
+    } break;
+    case ProfileType::PTASK_ON_STORAGE_HOMOGENEOUS: {
+        auto * d = static_cast<const ParallelTaskOnStorageHomogeneousProfileData *>(data);
+        hash_combine(h, hash<double>()(d->bytes_to_read));
+        hash_combine(h, hash<double>()(d->bytes_to_write));
+        hash_combine(h, hash<string>()(d->storage_label));
+        hash_combine(h, hash<int>()(static_cast<int>(d->strategy)));
+    } break;
+    case ProfileType::PTASK_DATA_STAGING_BETWEEN_STORAGES: {
+        auto * d = static_cast<const DataStagingProfileData *>(data);
+        hash_combine(h, hash<double>()(d->nb_bytes));
+        hash_combine(h, hash<string>()(d->from_storage_label));
+        hash_combine(h, hash<string>()(d->to_storage_label));
+    } break;
+    default:
+        xbt_die("Internal error: profiles of type %s cannot be interned", profile_type_to_string(type).c_str());
+    }
+    return h;
+}
+
+/**
+ * @brief Returns whether two internable profile data have the same content
+ * @param[in] type The type of the profiles
+ * @param[in] data1 The data of the first profile
+ * @param[in] data2 The data of the second profile
+ * @return Whether the two data have the same content
+ */
+static bool profile_data_equal(ProfileType type, const void * data1, const void * data2)
+{
+    switch (type)
+    {
+    case ProfileType::DELAY: {
+        return static_cast<const DelayProfileData *>(data1)->delay == static_cast<const DelayProfileData *>(data2)->delay;
+    }
+    case ProfileType::PTASK: {
+        auto * d1 = static_cast<const ParallelProfileData *>(data1);
+        auto * d2 = static_cast<const ParallelProfileData *>(data2);
+        if (d1->nb_res != d2->nb_res || d1->com_format != d2->com_format ||
+            (d1->cpu == nullptr) != (d2->cpu == nullptr) || d1->has_communications() != d2->has_communications())
+            return false;
+        if (d1->cpu != nullptr && !std::equal(d1->cpu, d1->cpu + d1->nb_res, d2->cpu))
+            return false;
+
+        // Compact formats are compared on their parameters, dense ones on their values
+        switch (d1->com_format)
+        {
+        case CommunicationMatrixFormat::DENSE:
+            return d1->com == nullptr ||
+                   std::equal(d1->com, d1->com + static_cast<size_t>(d1->nb_res) * d1->nb_res, d2->com);
+        case CommunicationMatrixFormat::SPARSE:
+            return d1->com_row_offsets == d2->com_row_offsets && d1->com_columns == d2->com_columns && d1->com_values == d2->com_values;
+        default:
+            return d1->com_bytes == d2->com_bytes && d1->com_bidirectional == d2->com_bidirectional &&
+                   d1->com_dims == d2->com_dims && d1->com_periodic == d2->com_periodic &&
+                   d1->com_root == d2->com_root && d1->com_block_size == d2->com_block_size;
+        }
+    }
+    case ProfileType::PTASK_HOMOGENEOUS: {
+        auto * d1 = static_cast<const ParallelHomogeneousProfileData *>(data1);
+        auto * d2 = static_cast<const ParallelHomogeneousProfileData *>(data2);
+        return d1->cpu == d2->cpu && d1->com == d2->com && d1->strategy == d2->strategy;
+    }
+    case ProfileType::PTASK_ON_STORAGE_HOMOGENEOUS: {
+        auto * d1 = static_cast<const ParallelTaskOnStorageHomogeneousProfileData *>(data1);
+        auto * d2 = static_cast<const ParallelTaskOnStorageHomogeneousProfileData *>(data2);
+        return d1->bytes_to_read == d2->bytes_to_read && d1->bytes_to_write == d2->bytes_to_write &&
+               d1->storage_label == d2->storage_label && d1->strategy == d2->strategy;
+    }
+    case ProfileType::PTASK_DATA_STAGING_BETWEEN_STORAGES: {
+        auto * d1 = static_cast<const DataStagingProfileData *>(data1);
+        auto * d2 = static_cast<const DataStagingProfileData *>(data2);
+        return d1->nb_bytes == d2->nb_bytes && d1->from_storage_label == d2->from_storage_label &&
+               d1->to_storage_label == d2->to_storage_label;
+    }
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief An interned profile data
+ */
+struct InternedProfileData
+{
+    ProfileType type; //!< The type of the profiles that share the data
+    std::weak_ptr<void> data; //!< The shared data. Expires when the last profile that shares it is deleted.
+};
+
+static std::unordered_multimap<size_t, InternedProfileData> interned_profile_data; //!< The interned profile data, indexed by the hash of their content
+static uint64_t nb_deduplicated_profiles = 0; //!< The number of profiles whose data has been replaced by an interned one
+
+void intern_profile_data(const ProfilePtr & profile)
+{
+    if (!profile_data_is_internable(profile->type) || profile->data == nullptr || profile->shared_data != nullptr)
+    {
+        return;
+    }
+
+    const size_t h = profile_data_hash(profile->type, profile->data);
+    auto range = interned_profile_data.equal_range(h);
+    for (auto it = range.first; it != range.second; )
+    {
+        auto shared_data = it->second.data.lock();
+        if (shared_data == nullptr)
+        {
+            it = interned_profile_data.erase(it);
+            continue;
+        }
+
+        if (it->second.type == profile->type && profile_data_equal(profile->type, shared_data.get(), profile->data))
+        {
+            delete_profile_data(profile->type, profile->data);
+            profile->data = shared_data.get();
+            profile->shared_data = std::move(shared_data);
+            ++nb_deduplicated_profiles;
+            return;
+        }
+        ++it;
+    }
+
+    // First profile with this content: its data becomes the interned one
+    const ProfileType type = profile->type;
+    profile->shared_data = std::shared_ptr<void>(profile->data, [type](void * data) { delete_profile_data(type, data); });
+    interned_profile_data.insert({h, InternedProfileData{type, profile->shared_data}});
+}
+
+uint64_t deduplicated_profiles_count()
+{
+    return nb_deduplicated_profiles;
+}
+
+/**
+ * @brief Reads the 'profiles' field of a composition profile
+ * @param[in] json_desc The JSON description of the profile
+ * @param[in] workload The workload the profile belongs to
+ * @param[in] profile_name The name of the profile
+ * @param[in] error_prefix The prefix to display when an error occurs
+ * @return The names of the sub-profiles, prefixed by their workload name
+ */
+static vector<string> read_sub_profile_names(const Value & json_desc, const Workload * workload,
+                                             const string & profile_name, const string & error_prefix)
+{
+    (void) error_prefix; // Avoids a warning if assertions are ignored
+    xbt_assert(json_desc.HasMember("profiles"), "%s: profile '%s' has no 'profiles' field",
+               error_prefix.c_str(), profile_name.c_str());
+    xbt_assert(json_desc["profiles"].IsArray(), "%s: profile '%s' has a non-array 'profiles' field",
+               error_prefix.c_str(), profile_name.c_str());
+    const Value & profiles = json_desc["profiles"];
+    xbt_assert(profiles.Size() > 0, "%s: profile '%s' has an invalid array 'profiles': its size must be "
+               "strictly positive", error_prefix.c_str(), profile_name.c_str());
+
+    vector<string> profile_names;
+    profile_names.reserve(profiles.Size());
+    for (unsigned int i = 0; i < profiles.Size(); ++i)
+    {
+        xbt_assert(profiles[i].IsString(), "%s: profile '%s' has an invalid array 'profiles': all elements must be strings",
+                   error_prefix.c_str(), profile_name.c_str());
+        string sub_profile_name = profiles[i].GetString();
+        if (sub_profile_name.find(workload->name) == string::npos)
+        {
+            // the workload name is not present in the profile name
+            sub_profile_name = workload->name + "!" + sub_profile_name;
+        }
+        profile_names.push_back(sub_profile_name);
+    }
+    return profile_names;
+}
+
+/**
+ * @brief Reads an array of non-negative integers from a JSON object field
+ * @param[in] object The JSON object
+ * @param[in] field The name of the field
+ * @param[in] profile_name The name of the profile the object belongs to
+ * @param[in] error_prefix The prefix to display when an error occurs
+ * @return The integers of the array
+ */
+static vector<unsigned int> read_uint_array(const Value & object, const char * field,
+                                            const string & profile_name, const string & error_prefix)
+{
+    (void) error_prefix; // Avoids a warning if assertions are ignored
+    xbt_assert(object.HasMember(field) && object[field].IsArray(), "%s: profile '%s' has a 'com' object without a '%s' array",
+               error_prefix.c_str(), profile_name.c_str(), field);
+
+    const Value & array = object[field];
+    vector<unsigned int> values;
+    values.reserve(array.Size());
+    for (unsigned int i = 0; i < array.Size(); ++i)
+    {
+        xbt_assert(array[i].IsUint(), "%s: profile '%s' has an invalid 'com' object: all elements of '%s' must be non-negative integers",
+                   error_prefix.c_str(), profile_name.c_str(), field);
+        values.push_back(array[i].GetUint());
+    }
+    return values;
+}
+
+/**
+ * @brief Reads an array of non-negative numbers from a JSON object field
+ * @param[in] object The JSON object
+ * @param[in] field The name of the field
+ * @param[in] profile_name The name of the profile the object belongs to
+ * @param[in] error_prefix The prefix to display when an error occurs
+ * @return The numbers of the array
+ */
+static vector<double> read_positive_double_array(const Value & object, const char * field,
+                                                 const string & profile_name, const string & error_prefix)
+{
+    (void) error_prefix; // Avoids a warning if assertions are ignored
+    xbt_assert(object.HasMember(field) && object[field].IsArray(), "%s: profile '%s' has a 'com' object without a '%s' array",
+               error_prefix.c_str(), profile_name.c_str(), field);
+
+    const Value & array = object[field];
+    vector<double> values;
+    values.reserve(array.Size());
+    for (unsigned int i = 0; i < array.Size(); ++i)
+    {
+        xbt_assert(array[i].IsNumber() && array[i].GetDouble() >= 0, "%s: profile '%s' has an invalid 'com' object: all elements of '%s' must be positive numbers",
+                   error_prefix.c_str(), profile_name.c_str(), field);
+        values.push_back(array[i].GetDouble());
+    }
+    return values;
+}
+
+/**
+ * @brief Parses the communication matrix of a ParallelTask profile given as a JSON object (sparse or structured format)
+ * @param[in] com The JSON object
+ * @param[in,out] data The profile data. Its nb_res is set from the matrix if there is no computation vector.
+ * @param[in] profile_name The name of the profile
+ * @param[in] error_prefix The prefix to display when an error occurs
+ */
+static void parse_communication_matrix_object(const Value & com, ParallelProfileData * data,
+                                              const string & profile_name, const string & error_prefix)
+{
+    (void) error_prefix; // Avoids a warning if assertions are ignored
+    xbt_assert(com.HasMember("format") && com["format"].IsString(), "%s: profile '%s' has a 'com' object without a string 'format' field",
+               error_prefix.c_str(), profile_name.c_str());
+    const string format = com["format"].GetString();
+
+    // The number of executors is given by the computation vector, by the 'nb_res' field, or by the matrix itself (csr, stencil)
+    auto set_nb_res = [&](unsigned int nb_res)
+    {
+        xbt_assert(data->nb_res == 0 || data->nb_res == nb_res, "%s: profile '%s' is incoherent: "
+                   "its communication matrix is for %u executors whereas its computation vector is for %u executors",
+                   error_prefix.c_str(), profile_name.c_str(), nb_res, data->nb_res);
+        data->nb_res = nb_res;
+    };
+    if (com.HasMember("nb_res"))
+    {
+        xbt_assert(com["nb_res"].IsUint() && com["nb_res"].GetUint() > 0, "%s: profile '%s' has a 'com' object with an invalid 'nb_res' field: must be a strictly positive integer",
+                   error_prefix.c_str(), profile_name.c_str());
+        set_nb_res(com["nb_res"].GetUint());
+    }
+
+    if (format == "coo" || format == "csr")
+    {
+        data->com_format = CommunicationMatrixFormat::SPARSE;
+        vector<unsigned int> columns = read_uint_array(com, "cols", profile_name, error_prefix);
+        vector<double> values = read_positive_double_array(com, "values", profile_name, error_prefix);
+        xbt_assert(columns.size() == values.size(), "%s: profile '%s' has an invalid 'com' object: 'cols' and 'values' have different sizes (%zu, %zu)",
+                   error_prefix.c_str(), profile_name.c_str(), columns.size(), values.size());
+
+        // Both formats are first read as (sender, receiver, bytes) transfers
+        vector<unsigned int> rows;
+        if (format == "csr")
+        {
+            vector<unsigned int> row_offsets = read_uint_array(com, "row_offsets", profile_name, error_prefix);
+            xbt_assert(row_offsets.size() >= 2 && row_offsets.front() == 0 && row_offsets.back() == columns.size() &&
+                       std::is_sorted(row_offsets.begin(), row_offsets.end()),
+                       "%s: profile '%s' has an invalid 'com' object: 'row_offsets' must be a non-decreasing array that starts with 0 and ends with the number of values",
+                       error_prefix.c_str(), profile_name.c_str());
+            set_nb_res(static_cast<unsigned int>(row_offsets.size() - 1));
+
+            rows.reserve(columns.size());
+            for (unsigned int row = 0; row + 1 < row_offsets.size(); ++row)
+                rows.insert(rows.end(), row_offsets[row + 1] - row_offsets[row], row);
+        }
+        else
+        {
+            xbt_assert(data->nb_res > 0, "%s: profile '%s' has a 'coo' communication matrix but no computation vector nor 'nb_res' field",
+                       error_prefix.c_str(), profile_name.c_str());
+            rows = read_uint_array(com, "rows", profile_name, error_prefix);
+            xbt_assert(rows.size() == values.size(), "%s: profile '%s' has an invalid 'com' object: 'rows' and 'values' have different sizes (%zu, %zu)",
+                       error_prefix.c_str(), profile_name.c_str(), rows.size(), values.size());
+        }
+
+        // Sort the transfers by sender then receiver, so that they can be stored row by row
+        vector<size_t> order(rows.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+        {
+            return std::make_pair(rows[a], columns[a]) < std::make_pair(rows[b], columns[b]);
+        });
+
+        // Count the transfers of each row, then accumulate the counts into offsets
+        data->com_row_offsets.assign(data->nb_res + 1, 0);
+        size_t previous = order.size();
+        for (size_t i : order)
+        {
+            xbt_assert(rows[i] < data->nb_res, "%s: profile '%s' has an invalid 'com' object: row %u is out of bounds (%u executors)",
+                       error_prefix.c_str(), profile_name.c_str(), rows[i], data->nb_res);
+            if (values[i] == 0)
+                continue;
+
+            // Transfers given several times are summed
+            if (previous != order.size() && rows[previous] == rows[i] && columns[previous] == columns[i])
+            {
+                data->com_values.back() += values[i];
+                continue;
+            }
+
+            data->com_columns.push_back(columns[i]);
+            data->com_values.push_back(values[i]);
+            ++data->com_row_offsets[rows[i] + 1];
+            previous = i;
+        }
+
+        for (unsigned int row = 1; row <= data->nb_res; ++row)
+            data->com_row_offsets[row] += data->com_row_offsets[row - 1];
+
+        for (unsigned int column : data->com_columns)
+        {
+            xbt_assert(column < data->nb_res, "%s: profile '%s' has an invalid 'com' object: column %u is out of bounds (%u executors)",
+                       error_prefix.c_str(), profile_name.c_str(), column, data->nb_res);
+        }
+        return;
+    }
+
+    // Structured patterns send the same amount of bytes in each transfer
+    xbt_assert(com.HasMember("bytes") && com["bytes"].IsNumber() && com["bytes"].GetDouble() >= 0,
+               "%s: profile '%s' has a '%s' communication matrix without a positive number 'bytes' field",
+               error_prefix.c_str(), profile_name.c_str(), format.c_str());
+    data->com_bytes = com["bytes"].GetDouble();
+
+    if (format == "stencil")
+    {
+        data->com_format = CommunicationMatrixFormat::STENCIL;
+        data->com_dims = read_uint_array(com, "dims", profile_name, error_prefix);
+        xbt_assert(!data->com_dims.empty(), "%s: profile '%s' has a stencil communication matrix with an empty 'dims' array",
+                   error_prefix.c_str(), profile_name.c_str());
+
+        unsigned int nb_res = 1;
+        for (unsigned int dim : data->com_dims)
+        {
+            xbt_assert(dim > 0, "%s: profile '%s' has a stencil communication matrix with an empty dimension",
+                       error_prefix.c_str(), profile_name.c_str());
+            nb_res *= dim;
+        }
+        set_nb_res(nb_res);
+
+        if (com.HasMember("periodic"))
+        {
+            xbt_assert(com["periodic"].IsBool(), "%s: profile '%s' has a non-boolean 'periodic' field",
+                       error_prefix.c_str(), profile_name.c_str());
+            data->com_periodic = com["periodic"].GetBool();
+        }
+        return;
+    }
+
+    xbt_assert(data->nb_res > 0, "%s: profile '%s' has a '%s' communication matrix but no computation vector nor 'nb_res' field",
+               error_prefix.c_str(), profile_name.c_str(), format.c_str());
+
+    if (format == "ring")
+    {
+        data->com_format = CommunicationMatrixFormat::RING;
+        if (com.HasMember("bidirectional"))
+        {
+            xbt_assert(com["bidirectional"].IsBool(), "%s: profile '%s' has a non-boolean 'bidirectional' field",
+                       error_prefix.c_str(), profile_name.c_str());
+            data->com_bidirectional = com["bidirectional"].GetBool();
+        }
+    }
+    else if (format == "all_to_one")
+    {
+        data->com_format = CommunicationMatrixFormat::ALL_TO_ONE;
+        if (com.HasMember("root"))
+        {
+            xbt_assert(com["root"].IsUint() && com["root"].GetUint() < data->nb_res, "%s: profile '%s' has an invalid 'root' field: must be an executor index lower than %u",
+                       error_prefix.c_str(), profile_name.c_str(), data->nb_res);
+            data->com_root = com["root"].GetUint();
+        }
+    }
+    else if (format == "block_diagonal")
+    {
+        data->com_format = CommunicationMatrixFormat::BLOCK_DIAGONAL;
+        xbt_assert(com.HasMember("block_size") && com["block_size"].IsUint() && com["block_size"].GetUint() > 0,
+                   "%s: profile '%s' has a block_diagonal communication matrix without a strictly positive integer 'block_size' field",
+                   error_prefix.c_str(), profile_name.c_str());
+        data->com_block_size = com["block_size"].GetUint();
+    }
+    else
+    {
+        xbt_die("%s: profile '%s' has a 'com' object of unknown format '%s' (expected one of coo, csr, ring, stencil, all_to_one, block_diagonal)",
+                error_prefix.c_str(), profile_name.c_str(), format.c_str());
+    }
+}
+
 // Do NOT remove namespaces in the arguments (to avoid doxygen warnings)
 ProfilePtr Profile::from_json(const std::string & profile_name,
                               const rapidjson::Value & json_desc,
@@ -320,11 +1065,16 @@ ProfilePtr Profile::from_json(const std::string & profile_name,
             }
         }
 
-        if (json_desc.HasMember("com"))
+        if (json_desc.HasMember("com") && json_desc["com"].IsObject())
+        {
+            // sparse or structured communication matrix
+            parse_communication_matrix_object(json_desc["com"], data, profile_name, error_prefix);
+        }
+        else if (json_desc.HasMember("com"))
         {
             // get and check Comm vector
             const Value & com = json_desc["com"];
-            xbt_assert(com.IsArray(), "%s: profile '%s' has a non-array 'com' field",
+            xbt_assert(com.IsArray(), "%s: profile '%s' has a 'com' field that is neither an array nor an object",
                        error_prefix.c_str(), profile_name.c_str());
 
             if (data->nb_res != 0)
@@ -352,6 +1102,8 @@ ProfilePtr Profile::from_json(const std::string & profile_name,
                 xbt_assert(data->com[i] >= 0, "%s: profile '%s' communication array is invalid: all "
                                               "elements must be positive", error_prefix.c_str(), profile_name.c_str());
             }
+
+            data->compress_communication_matrix();
         }
 
         profile->data = data;
@@ -518,11 +1270,19 @@ ProfilePtr Profile::from_json(const std::string & profile_name,
     }
     else if (profile_type == "ForkJoinCompositionProfile")
     {
-        xbt_die("Handling of profile ForkJoin Composition not implemented yet");
+        profile->type = ProfileType::FORKJOIN_COMPOSITION;
+        ForkJoinCompositionProfileData * data = new ForkJoinCompositionProfileData;
+        data->profile_names = read_sub_profile_names(json_desc, workload, profile_name, error_prefix);
+
+        profile->data = data;
     }
     else if (profile_type == "ParallelTaskMergeCompositionProfile")
     {
-        xbt_die("Handling of profile Parallel Task Merge Composition not implemented yet");
+        profile->type = ProfileType::PTASK_MERGE_COMPOSITION;
+        ParallelTaskMergeCompositionProfileData * data = new ParallelTaskMergeCompositionProfileData;
+        data->profile_names = read_sub_profile_names(json_desc, workload, profile_name, error_prefix);
+
+        profile->data = data;
     }
     else if (profile_type == "TraceReplayProfile")
     {
@@ -571,6 +1331,7 @@ ProfilePtr Profile::from_json(const std::string & profile_name,
         else if (trace_type == "FractionalComputation")
         {
             profile->type = ProfileType::REPLAY_USAGE;
+            data->load_usage_traces();
         }
         else
         {
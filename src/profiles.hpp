@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -13,6 +14,7 @@
 #include <batprotocol.hpp>
 #include <rapidjson/document.h>
 
+#include "instance_counter.hpp"
 #include "pointers.hpp"
 
 class Workload;
@@ -27,8 +29,8 @@ enum class ProfileType
     ,PTASK                                     //!< composed of a computation vector and a communication matrix. Its data is of type ParallelProfileData
     ,PTASK_HOMOGENEOUS                         //!< a homogeneous parallel task that executes the given amounts of computation and communication on every node. Its data is of type ParallelHomogeneousProfileData
     ,SEQUENTIAL_COMPOSITION                    //!< non-atomic: it is composed of a sequence of other profiles
-    ,FORKJOIN_COMPOSITION                      //!< a profile of type Fork-Join
-    ,PTASK_MERGE_COMPOSITION
+    ,FORKJOIN_COMPOSITION                      //!< non-atomic: it is composed of other profiles that are executed concurrently. Its data is of type ForkJoinCompositionProfileData
+    ,PTASK_MERGE_COMPOSITION                   //!< composed of parallel task profiles that are merged into a single parallel task. Its data is of type ParallelTaskMergeCompositionProfileData
     ,PTASK_ON_STORAGE_HOMOGENEOUS              //!< Read and writes data to a PFS storage nodes. data type ParallelHomogeneousPFSProfileData
     ,PTASK_DATA_STAGING_BETWEEN_STORAGES       //!< for moving data between the pfs hosts. Its data is of type DataStagingProfileData
     //,TRACE_REPLAY
@@ -47,15 +49,19 @@ struct Profile
 
     /**
      * @brief Destroys a Profile, deleting its data from memory according to the profile type
+     * @details Interned data is only deleted when the last profile that shares it is destroyed.
      */
     ~Profile();
 
     ProfileType type; //!< The type of the profile
     void * data; //!< The associated data
+    std::shared_ptr<void> shared_data = nullptr; //!< Owns data if it is interned (shared by all the profiles with the same content), nullptr otherwise
+    unsigned int nb_referencing_jobs = 0; //!< The number of jobs in memory that directly use this profile
     std::string name; //!< the profile unique name
     Workload * workload = nullptr; //!< The workload the profile belongs to
     int return_code = 0;  //!< The return code of this profile's execution (SUCCESS == 0)
     std::string extra_data = ""; //!< User-given extra data. Not used by Batsim at all but forwarded to EDCs.
+    InstanceCounter<Profile> instance_counter; //!< Counts Profile instances (for real execution statistics)
 
     /**
      * @brief Creates a new-allocated Profile from a JSON description
@@ -101,8 +107,22 @@ struct DelayProfileData
     double delay; //!< The time amount, in seconds, that the job is supposed to take
 };
 
+/**
+ * @brief Enumerates how the communication matrix of a ParallelTask profile is stored
+ */
+enum class CommunicationMatrixFormat
+{
+    DENSE                                      //!< all the nb_res*nb_res values, row by row (the sender is the row, the receiver is the column)
+    ,SPARSE                                    //!< only the non-zero values, in compressed sparse row (CSR) format
+    ,RING                                      //!< executor i sends to executor i+1 (and to executor i-1 if bidirectional)
+    ,STENCIL                                   //!< executors are laid out on a grid, and send to their direct neighbours in each dimension
+    ,ALL_TO_ONE                                //!< all executors send to a root executor
+    ,BLOCK_DIAGONAL                            //!< executors are grouped into consecutive blocks, and send to all the other executors of their block
+};
+
 /**
  * @brief The data associated to ParallelTask profiles
+ * @details The communication matrix is only expanded into a dense matrix when the profile is executed (or forwarded to the EDC).
  */
 struct ParallelProfileData
 {
@@ -114,9 +134,43 @@ struct ParallelProfileData
      */
     ~ParallelProfileData();
 
+    /**
+     * @brief Returns whether the profile has a communication matrix
+     * @return Whether the profile has a communication matrix
+     */
+    bool has_communications() const;
+
+    /**
+     * @brief Calls a function on each non-zero transfer of the communication matrix
+     * @param[in] f The function to call with the sender, the receiver and the amount of bytes of each transfer
+     */
+    void for_each_transfer(const std::function<void(unsigned int, unsigned int, double)> & f) const;
+
+    /**
+     * @brief Expands the communication matrix into a dense matrix
+     * @param[out] matrix The dense matrix, of size nb_res*nb_res
+     */
+    void fill_communication_matrix(std::vector<double> & matrix) const;
+
+    /**
+     * @brief Converts a DENSE communication matrix into the SPARSE format if most of its values are zeros
+     */
+    void compress_communication_matrix();
+
     unsigned int nb_res;    //!< The number of resources
     double * cpu = nullptr; //!< The computation vector
-    double * com = nullptr; //!< The communication matrix
+    double * com = nullptr; //!< The communication matrix (DENSE format only)
+
+    CommunicationMatrixFormat com_format = CommunicationMatrixFormat::DENSE; //!< How the communication matrix is stored
+    std::vector<unsigned int> com_row_offsets;  //!< SPARSE format: where the transfers of each sender start in com_columns and com_values (size nb_res+1)
+    std::vector<unsigned int> com_columns;      //!< SPARSE format: the receiver of each non-zero transfer
+    std::vector<double> com_values;             //!< SPARSE format: the amount of bytes of each non-zero transfer
+    double com_bytes = 0;                       //!< Structured formats: the amount of bytes of each transfer
+    bool com_bidirectional = false;             //!< RING format: whether executors also send to their predecessor
+    std::vector<unsigned int> com_dims;         //!< STENCIL format: the size of each dimension of the grid, whose product is nb_res. The last dimension varies the fastest.
+    bool com_periodic = false;                  //!< STENCIL format: whether the grid wraps around in each dimension
+    unsigned int com_root = 0;                  //!< ALL_TO_ONE format: the executor that receives the data
+    unsigned int com_block_size = 0;            //!< BLOCK_DIAGONAL format: the number of executors in each block (the last block can be smaller)
 };
 
 /**
@@ -144,8 +198,8 @@ struct SequenceProfileData
  */
 struct ForkJoinCompositionProfileData
 {
-    // TODO
     std::vector<std::string> profile_names; //!< The profile names
+    std::vector<ProfilePtr> profiles; //!< The profiles, executed concurrently
 };
 
 /**
@@ -153,8 +207,8 @@ struct ForkJoinCompositionProfileData
  */
 struct ParallelTaskMergeCompositionProfileData
 {
-    //TODO
     std::vector<std::string> profile_names; //!< The profile names
+    std::vector<ProfilePtr> profiles; //!< The parallel task profiles, merged into a single parallel task
 };
 
 
@@ -179,6 +233,24 @@ struct DataStagingProfileData
     std::string to_storage_label ;    //!< The storage label where data goes to
 };
 
+/**
+ * @brief A pre-parsed usage over time trace, as replayed by REPLAY_USAGE profiles
+ * @details Phase i uses usages[i] (in [0,1]) of the cores of its host to compute flops[i] floating-point operations on each used core.
+ */
+struct UsageTrace
+{
+    std::vector<double> usages; //!< The fraction of the host cores used by each phase
+    std::vector<double> flops;  //!< The amount of floating-point operations computed by each used core in each phase
+};
+
+/**
+ * @brief Parses a usage over time trace file, or returns it from a cache if it has already been parsed
+ * @details Traces are shared by all the profiles that use them, and are freed when no profile uses them anymore.
+ * @param[in] filename The name of the trace file
+ * @return The parsed trace
+ */
+std::shared_ptr<const UsageTrace> load_usage_trace(const std::string & filename);
+
 /**
  * @brief The data associated to TraceReplay profiles
  */
@@ -186,6 +258,12 @@ struct TraceReplayProfileData
 {
     std::string filename; //!< The filename where to find all trace files (used in profile forwarding to EDC)
     std::vector<std::string> trace_filenames; //!< all defined tracefiles
+    std::vector<std::shared_ptr<const UsageTrace> > usage_traces; //!< The parsed trace of each rank (REPLAY_USAGE profiles only)
+
+    /**
+     * @brief Parses (or retrieves from the cache) the usage trace of each rank
+     */
+    void load_usage_traces();
 };
 
 
@@ -256,11 +334,19 @@ public:
      */
     bool exists(const std::string & profile_name) const;
 
+    /**
+     * @brief Checks whether a profile exists and has not been removed
+     * @param[in] profile_name The name of the profile
+     * @return True if and only if a profile whose name is profile_name is in the Profiles and has not been removed (e.g., garbage collected)
+     */
+    bool is_alive(const std::string & profile_name) const;
+
     /**
      * @brief Adds a Profile into a Profiles instance
+     * @details A profile that has been removed can be added again (streamed workloads create their profiles again when needed).
      * @param[in] profile_name The name of the profile to name
      * @param[in] profile The profile to add
-     * @pre No profile with the same name exists in the Profiles instance
+     * @pre No alive profile with the same name exists in the Profiles instance
      */
     void add_profile(const std::string & profile_name, ProfilePtr & profile);
 
@@ -280,10 +366,10 @@ public:
     void set_workload(Workload *workload);
 
     /**
-     * @brief Returns a copy of the internal std::map used in the Profiles
-     * @return A copy of the internal std::map used in the Profiles
+     * @brief Returns the internal std::map used in the Profiles
+     * @return The internal std::map used in the Profiles
      */
-    const std::unordered_map<std::string, ProfilePtr> profiles() const;
+    const std::unordered_map<std::string, ProfilePtr> & profiles() const;
 
     /**
      * @brief Returns the number of profiles of the Profiles instance
@@ -291,8 +377,22 @@ public:
      */
     int nb_profiles() const;
 
+    /**
+     * @brief Returns whether an SMPI trace replay profile has been added to the Profiles instance
+     * @return True if an SMPI trace replay profile has been added, even if it has been removed since then
+     */
+    bool contains_smpi_profile() const;
+
+private:
+    /**
+     * @brief Removes a sub-profile of a removed composition profile, unless jobs in memory still use it directly
+     * @param[in] subprofile The sub-profile
+     */
+    void remove_subprofile(const ProfilePtr & subprofile);
+
 private:
     std::unordered_map<std::string, ProfilePtr> _profiles; //!< Stores all the profiles, indexed by their names. Value can be nullptr, meaning that the profile is no longer in memory but existed in the past.
+    bool _contains_smpi_profile = false; //!< Whether an SMPI trace replay profile has been added
     Workload * _workload = nullptr; //!< The Workload the profiles belong to
 };
 
@@ -302,3 +402,16 @@ private:
  * @return A std::string corresponding to a given ProfileType
  */
 std::string profile_type_to_string(const ProfileType & type);
+
+/**
+ * @brief Makes a profile share its data with the previously interned profiles of the same content, or interns its data otherwise
+ * @details Only the data of delay and parallel task profiles is interned. Profile names are kept untouched.
+ * @param[in] profile The profile
+ */
+void intern_profile_data(const ProfilePtr & profile);
+
+/**
+ * @brief Returns the number of profiles whose data has been replaced by the data of an identical profile
+ * @return The number of deduplicated profiles
+ */
+uint64_t deduplicated_profiles_count();
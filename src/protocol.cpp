@@ -1,5 +1,6 @@
 #include "protocol.hpp"
 
+#include <chrono>
 #include <regex>
 #include <filesystem>
 
@@ -12,6 +13,7 @@
 
 #include "batsim.hpp"
 #include "context.hpp"
+#include "internal_tracing.hpp"
 
 using namespace rapidjson;
 using namespace std;
@@ -45,6 +47,7 @@ std::shared_ptr<batprotocol::KillProgress> battask_to_kill_progress(const BatTas
         case ProfileType::PTASK_HOMOGENEOUS:
         case ProfileType::PTASK_ON_STORAGE_HOMOGENEOUS:
         case ProfileType::PTASK_DATA_STAGING_BETWEEN_STORAGES:
+        case ProfileType::PTASK_MERGE_COMPOSITION: // merged into a single parallel task
         { // Profile is a parallel task.
             double task_progress_ratio = 0;
             if (t->ptask != nullptr) // The parallel task has already started
@@ -53,6 +56,8 @@ std::shared_ptr<batprotocol::KillProgress> battask_to_kill_progress(const BatTas
                 // from 1 (not started yet) to 0 (completely finished)
                 task_progress_ratio = 1 - t->ptask->get_remaining_ratio();
             }
+            // A resumed task only has the remaining part of its work to do
+            task_progress_ratio = 1 - t->remaining_work_ratio * (1 - task_progress_ratio);
             kp->add_atomic(t->unique_name(), t->profile->name, task_progress_ratio);
         } break;
         case ProfileType::DELAY:
@@ -62,7 +67,7 @@ std::shared_ptr<batprotocol::KillProgress> battask_to_kill_progress(const BatTas
             {
                 xbt_assert(t->delay_task_start != -1, "Internal error");
                 double runtime = simgrid::s4u::Engine::get_clock() - t->delay_task_start;
-                task_progress_ratio = runtime / t->delay_task_required;
+                task_progress_ratio = 1 - t->remaining_work_ratio * (1 - runtime / t->delay_task_required);
             }
 
             kp->add_atomic(t->unique_name(), t->profile->name, task_progress_ratio);
@@ -78,6 +83,18 @@ std::shared_ptr<batprotocol::KillProgress> battask_to_kill_progress(const BatTas
 
             kp->add_sequential(t->unique_name(), t->profile->name, t->current_repetition, t->current_task_index, sub_task->unique_name());
         } break;
+        case ProfileType::FORKJOIN_COMPOSITION: {
+            std::vector<std::string> sub_task_names;
+            sub_task_names.reserve(t->sub_tasks.size());
+            for (const auto * sub_task : t->sub_tasks)
+            {
+                xbt_assert(sub_task != nullptr, "Internal error");
+                tasks.push(sub_task);
+                sub_task_names.push_back(sub_task->unique_name());
+            }
+
+            kp->add_forkjoin(t->unique_name(), t->profile->name, sub_task_names);
+        } break;
         default:
             xbt_die("Unimplemented kill progress of profile type %d", (int)task->profile->type);
         }
@@ -130,12 +147,12 @@ std::shared_ptr<batprotocol::Profile> to_profile(const Profile & profile)
             cpu_vector->assign(data->cpu, data->cpu+data->nb_res);
         }
 
+        // batprotocol only knows dense communication matrices
         std::shared_ptr<std::vector<double>> comm_vector = nullptr;
-        if (data->com != nullptr)
+        if (data->has_communications())
         {
             comm_vector = make_shared<vector<double>>(vector<double>());
-            comm_vector->reserve(data->nb_res*data->nb_res);
-            comm_vector->assign(data->com, data->com+data->nb_res*data->nb_res);
+            data->fill_communication_matrix(*comm_vector);
         }
 
         p = batprotocol::Profile::make_parallel_task(cpu_vector, comm_vector);
@@ -633,33 +650,31 @@ StopProbeMessage * from_stop_probe(const batprotocol::fb::StopProbeEvent * stop_
 }
 
 
-JobRegisteredByEDCMessage * from_register_job(const batprotocol::fb::RegisterJobEvent * register_job, BatsimContext * context)
+void from_register_job(const batprotocol::fb::RegisterJobEvent * register_job, JobsRegisteredByEDCMessage * msg, BatsimContext * context)
 {
-    auto msg = new JobRegisteredByEDCMessage;
-
     const batprotocol::fb::Job * proto_job = register_job->job();
 
-    msg->job = std::make_shared<Job>();
-    msg->job->id = JobIdentifier(register_job->job_id()->str());
-    msg->job->requested_nb_res = proto_job->resource_request();
+    auto job = std::make_shared<Job>();
+    job->id = JobIdentifier(register_job->job_id()->str());
+    job->requested_nb_res = proto_job->resource_request();
 
     if (proto_job->walltime() != flatbuffers::nullopt)
     {
-        msg->job->walltime = proto_job->walltime().value();
+        job->walltime = proto_job->walltime().value();
     }
     else
     {
         // The value -1 internal to Batsim means there is no walltime.
-        msg->job->walltime = -1;
+        job->walltime = -1;
     }
 
     if (proto_job->extra_data() != nullptr)
     {
-        msg->job->extra_data = proto_job->extra_data()->str();
+        job->extra_data = proto_job->extra_data()->str();
     }
-    msg->profile_id = proto_job->profile_id()->str();
 
-    return msg;
+    msg->jobs.push_back(job);
+    msg->profile_ids.push_back(proto_job->profile_id()->str());
 }
 
 
@@ -736,6 +751,8 @@ ProfileRegisteredByEDCMessage * from_register_profile(const batprotocol::fb::Reg
                 xbt_assert(data->com[i] >= 0, "Invalid registration of profile '%s': elements of 'communication_matrix' must be positive (%g)",
                         msg->profile_id.c_str(), data->com[i]);
             }
+
+            data->compress_communication_matrix();
         }
 
         profile->data = data;
@@ -780,26 +797,36 @@ ProfileRegisteredByEDCMessage * from_register_profile(const batprotocol::fb::Reg
     }
     case batprotocol::fb::Profile_ForkJoinCompositionProfile:
     {
-        // const batprotocol::fb::ForkJoinCompositionProfile * prof = proto_profile->profile_as_ForkJoinCompositionProfile();
-        // profile->type = ProfileType::FORKJOIN_COMPOSITION;
-        // ParallelProfileData * data = new ParallelProfileData;
+        const batprotocol::fb::ForkJoinCompositionProfile * prof = proto_profile->profile_as_ForkJoinCompositionProfile();
+        profile->type = ProfileType::FORKJOIN_COMPOSITION;
+        ForkJoinCompositionProfileData * data = new ForkJoinCompositionProfileData;
+
+        auto * ids_vector = prof->profile_ids();
+        data->profile_names.resize(ids_vector->size());
 
-        xbt_die("Handling of profile ForkJoin Composition is not implemented yet");
+        for (unsigned int i = 0; i < ids_vector->size(); ++i)
+        {
+            data->profile_names[i] = ids_vector->Get(i)->str();
+        }
 
-        //TODO
-        //profile->data = data;
+        profile->data = data;
         break;
     }
     case batprotocol::fb::Profile_ParallelTaskMergeCompositionProfile:
     {
-        // const batprotocol::fb::ParallelTaskMergeCompositionProfile * prof = proto_profile->profile_as_ParallelTaskMergeCompositionProfile();
-        // profile->type = ProfileType::PTASK_MERGE_COMPOSITION;
-        // ParallelProfileData * data = new ParallelProfileData;
+        const batprotocol::fb::ParallelTaskMergeCompositionProfile * prof = proto_profile->profile_as_ParallelTaskMergeCompositionProfile();
+        profile->type = ProfileType::PTASK_MERGE_COMPOSITION;
+        ParallelTaskMergeCompositionProfileData * data = new ParallelTaskMergeCompositionProfileData;
 
-        xbt_die("Handling of profile Parallel Task Merge Composition is not implemented yet");
+        auto * ids_vector = prof->profile_ids();
+        data->profile_names.resize(ids_vector->size());
 
-        //TODO
-        // profile->data = data;
+        for (unsigned int i = 0; i < ids_vector->size(); ++i)
+        {
+            data->profile_names[i] = ids_vector->Get(i)->str();
+        }
+
+        profile->data = data;
         break;
     }
     case batprotocol::fb::Profile_ParallelTaskOnStorageHomogeneousProfile:
@@ -874,6 +901,7 @@ ProfileRegisteredByEDCMessage * from_register_profile(const batprotocol::fb::Reg
         else if (prof->trace_type() == batprotocol::fb::TraceType_FractionalComputation)
         {
             profile->type = ProfileType::REPLAY_USAGE;
+            data->load_usage_traces();
         }
         else
         {
@@ -912,34 +940,52 @@ TurnOnOffHostsMessage * from_turn_onoff_hosts(const batprotocol::fb::TurnOnOffHo
 
 void parse_batprotocol_message(const uint8_t * buffer, uint32_t buffer_size, double & now, std::shared_ptr<std::vector<IPMessageWithTimestamp> > & messages, BatsimContext * context)
 {
-    (void) buffer_size;
+    BATSIM_TRACE_SPAN("protocol", "parse_batprotocol_message");
+    auto start = std::chrono::steady_clock::now();
+    context->nb_bytes_received_from_edc += buffer_size;
+
     auto parsed = batprotocol::deserialize_message(*context->proto_msg_builder, context->edc_json_format, buffer);
     now = parsed->now();
     messages->resize(parsed->events()->size());
+    context->nb_events_received_from_edc += parsed->events()->size();
 
     double preceding_event_timestamp = -1;
     if (parsed->events()->size() > 0)
         preceding_event_timestamp = parsed->events()->Get(0)->timestamp();
 
+    unsigned int nb_messages = 0;
     for (unsigned int i = 0; i < parsed->events()->size(); ++i)
     {
         auto event_timestamp = parsed->events()->Get(i);
-        auto ip_message = new IPMessage;
-
-        messages->at(i).timestamp = event_timestamp->timestamp();
-        messages->at(i).message = ip_message;
+        const double timestamp = event_timestamp->timestamp();
 
-        xbt_assert(messages->at(i).timestamp <= now,
+        xbt_assert(timestamp <= now,
             "invalid event %u (type='%s') in message: event timestamp (%g) is after message's now (%g)",
-            i, batprotocol::fb::EnumNamesEvent()[event_timestamp->event_type()], messages->at(i).timestamp, now
+            i, batprotocol::fb::EnumNamesEvent()[event_timestamp->event_type()], timestamp, now
         );
-        xbt_assert(messages->at(i).timestamp >= preceding_event_timestamp,
+        xbt_assert(timestamp >= preceding_event_timestamp,
             "invalid event %u (type='%s') in message: event timestamp (%g) is before preceding event's timestamp (%g) while events should be in chronological order",
-            i, batprotocol::fb::EnumNamesEvent()[event_timestamp->event_type()], messages->at(i).timestamp, preceding_event_timestamp
+            i, batprotocol::fb::EnumNamesEvent()[event_timestamp->event_type()], timestamp, preceding_event_timestamp
         );
 
-        XBT_INFO("Parsing an event of type=%s", batprotocol::fb::EnumNamesEvent()[event_timestamp->event_type()]);
         using namespace batprotocol::fb;
+
+        // Consecutive job registrations at the same time are grouped into a single inter-actor message
+        if (event_timestamp->event_type() == Event_RegisterJobEvent && nb_messages > 0 &&
+            messages->at(nb_messages - 1).timestamp == timestamp &&
+            messages->at(nb_messages - 1).message->type == IPMessageType::SCHED_JOB_REGISTERED)
+        {
+            auto * msg = static_cast<JobsRegisteredByEDCMessage *>(messages->at(nb_messages - 1).message->data);
+            from_register_job(event_timestamp->event_as_RegisterJobEvent(), msg, context);
+            continue;
+        }
+
+        auto ip_message = new IPMessage;
+        messages->at(nb_messages).timestamp = timestamp;
+        messages->at(nb_messages).message = ip_message;
+        ++nb_messages;
+
+        XBT_INFO("Parsing an event of type=%s", batprotocol::fb::EnumNamesEvent()[event_timestamp->event_type()]);
         switch (event_timestamp->event_type())
         {
         case Event_EDCHelloEvent: {
@@ -976,7 +1022,9 @@ void parse_batprotocol_message(const uint8_t * buffer, uint32_t buffer_size, dou
         } break;
         case Event_RegisterJobEvent: {
             ip_message->type = IPMessageType::SCHED_JOB_REGISTERED;
-            ip_message->data = static_cast<void *>(from_register_job(event_timestamp->event_as_RegisterJobEvent(), context));
+            auto * msg = new JobsRegisteredByEDCMessage;
+            from_register_job(event_timestamp->event_as_RegisterJobEvent(), msg, context);
+            ip_message->data = static_cast<void *>(msg);
         } break;
         case Event_RegisterProfileEvent: {
             ip_message->type = IPMessageType::SCHED_PROFILE_REGISTERED;
@@ -1006,6 +1054,10 @@ void parse_batprotocol_message(const uint8_t * buffer, uint32_t buffer_size, dou
         } break;
         }
     }
+    messages->resize(nb_messages);
+
+    auto end = std::chrono::steady_clock::now();
+    context->microseconds_used_by_deserialization += static_cast<long double>(std::chrono::duration <long double, std::micro> (end - start).count());
 }
 
 } // end of namespace protocol
@@ -38,7 +38,7 @@ StopCallMeLaterMessage * from_stop_call_me_later(const batprotocol::fb::StopCall
 CreateProbeMessage * from_create_probe(const batprotocol::fb::CreateProbeEvent * create_probe, BatsimContext * context);
 StopProbeMessage * from_stop_probe(const batprotocol::fb::StopProbeEvent * stop_probe, BatsimContext * context);
 
-JobRegisteredByEDCMessage * from_register_job(const batprotocol::fb::RegisterJobEvent * register_job, BatsimContext * context);
+void from_register_job(const batprotocol::fb::RegisterJobEvent * register_job, JobsRegisteredByEDCMessage * msg, BatsimContext * context);
 ProfileRegisteredByEDCMessage * from_register_profile(const batprotocol::fb::RegisterProfileEvent * register_profile, BatsimContext * context);
 
 ChangeHostsPStateMessage * from_change_hosts_pstate(const batprotocol::fb::ChangeHostsPStateEvent * change_hosts_pstate, BatsimContext * context);
@@ -39,8 +39,7 @@ void switch_on_machine_process(BatsimContext *context, int machine_id, unsigned
              machine->id, machine->name.c_str(), new_pstate);
     machine->host->set_pstate(new_pstate);
 
-    machine->update_machine_state(MachineState::IDLE);
-
+    // The machine state is updated by the server, as switching actors may run on several threads
     SwitchMessage * msg = new SwitchMessage;
     msg->machine_id = machine_id;
     msg->new_pstate = new_pstate;
@@ -71,8 +70,7 @@ void switch_off_machine_process(BatsimContext * context, int machine_id, unsigne
              machine->id, machine->name.c_str(), new_pstate);
     machine->host->set_pstate(new_pstate);
 
-    machine->update_machine_state(MachineState::SLEEPING);
-
+    // The machine state is updated by the server, as switching actors may run on several threads
     SwitchMessage * msg = new SwitchMessage;
     msg->machine_id = machine_id;
     msg->new_pstate = new_pstate;
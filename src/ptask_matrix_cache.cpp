@@ -0,0 +1,136 @@
+/**
+ * @file ptask_matrix_cache.cpp
+ * @brief Cache of the computation/communication matrices of generated parallel tasks
+ */
+
+#include "ptask_matrix_cache.hpp"
+
+#include <xbt.h>
+
+using namespace std;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(ptask_matrix_cache, "ptask_matrix_cache"); //!< Logging
+
+/**
+ * @brief Computes the amount of memory used by some matrices
+ * @param[in] matrices The matrices
+ * @return The amount of memory (in bytes) used by the matrices
+ */
+static size_t matrices_size(const PtaskMatrices & matrices)
+{
+    return sizeof(PtaskMatrices) +
+        sizeof(double) * (matrices.computation_vector.capacity() + matrices.communication_matrix.capacity());
+}
+
+bool PtaskMatrixKey::operator==(const PtaskMatrixKey & other) const
+{
+    return profile_type == other.profile_type &&
+        computation_amount == other.computation_amount &&
+        communication_amount == other.communication_amount &&
+        strategy == other.strategy &&
+        nb_executors == other.nb_executors;
+}
+
+size_t PtaskMatrixKeyHash::operator()(const PtaskMatrixKey & key) const
+{
+    size_t h = hash<int>()(static_cast<int>(key.profile_type));
+    for (size_t value : {hash<double>()(key.computation_amount), hash<double>()(key.communication_amount),
+                         hash<int>()(key.strategy), hash<unsigned int>()(key.nb_executors)})
+    {
+        h ^= value + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+PtaskMatrixCache::PtaskMatrixCache(size_t max_size) :
+    _max_size(max_size)
+{
+}
+
+void PtaskMatrixCache::set_max_size(size_t max_size)
+{
+    lock_guard<mutex> lock(_mutex);
+    _max_size = max_size;
+    evict();
+}
+
+PtaskMatricesPtr PtaskMatrixCache::get(const PtaskMatrixKey & key, const std::function<void(PtaskMatrices &)> & generator)
+{
+    unique_lock<mutex> lock(_mutex);
+    auto index_it = _index.find(key);
+    if (index_it != _index.end())
+    {
+        // Mark the matrices as the most recently used
+        _lru.splice(_lru.begin(), _lru, index_it->second);
+        ++_nb_hits;
+        return index_it->second->second;
+    }
+
+    ++_nb_misses;
+    lock.unlock();
+
+    // Large matrices are generated without blocking the other users of the cache
+    auto matrices = make_shared<PtaskMatrices>();
+    generator(*matrices);
+
+    lock.lock();
+    index_it = _index.find(key);
+    if (index_it != _index.end())
+    {
+        // Another thread has generated the same matrices in the meantime
+        _lru.splice(_lru.begin(), _lru, index_it->second);
+        return index_it->second->second;
+    }
+
+    const size_t size = matrices_size(*matrices);
+    if (size <= _max_size)
+    {
+        _lru.emplace_front(key, matrices);
+        _index[key] = _lru.begin();
+        _size += size;
+        evict();
+    }
+    else
+    {
+        XBT_DEBUG("Matrices of %u executors are too large to be cached (%zu bytes)", key.nb_executors, size);
+    }
+
+    return matrices;
+}
+
+uint64_t PtaskMatrixCache::nb_hits() const
+{
+    lock_guard<mutex> lock(_mutex);
+    return _nb_hits;
+}
+
+uint64_t PtaskMatrixCache::nb_misses() const
+{
+    lock_guard<mutex> lock(_mutex);
+    return _nb_misses;
+}
+
+uint64_t PtaskMatrixCache::nb_evictions() const
+{
+    lock_guard<mutex> lock(_mutex);
+    return _nb_evictions;
+}
+
+size_t PtaskMatrixCache::size() const
+{
+    lock_guard<mutex> lock(_mutex);
+    return _size;
+}
+
+void PtaskMatrixCache::evict()
+{
+    // Evicted matrices remain alive as long as some task uses them
+    while (_size > _max_size)
+    {
+        auto & lru_entry = _lru.back();
+        _size -= matrices_size(*lru_entry.second);
+        _index.erase(lru_entry.first);
+        _lru.pop_back();
+        ++_nb_evictions;
+    }
+}
@@ -0,0 +1,135 @@
+/**
+ * @file ptask_matrix_cache.hpp
+ * @brief Cache of the computation/communication matrices of generated parallel tasks
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "profiles.hpp"
+
+/**
+ * @brief The computation vector and communication matrix of a parallel task
+ */
+struct PtaskMatrices
+{
+    std::vector<double> computation_vector;     //!< The amount of computation of each executor. Can be empty.
+    std::vector<double> communication_matrix;   //!< The amount of communication between each pair of executors. Can be empty.
+};
+
+typedef std::shared_ptr<const PtaskMatrices> PtaskMatricesPtr; //!< Immutable matrices, shared by all the tasks that use them
+
+/**
+ * @brief Identifies the matrices generated from a homogeneous profile
+ * @details Two tasks with equal keys use the same matrices, even if they come from different profiles.
+ */
+struct PtaskMatrixKey
+{
+    ProfileType profile_type;           //!< The type of the profile the matrices are generated from
+    double computation_amount;          //!< The computation amount of the profile (or its amount of bytes to read for storage profiles)
+    double communication_amount;        //!< The communication amount of the profile (or its amount of bytes to write for storage profiles)
+    int strategy;                       //!< How the profile amounts are put into the matrices
+    unsigned int nb_executors;          //!< The number of executors of the task
+
+    /**
+     * @brief Returns whether two keys are equal
+     * @param[in] other The other key
+     * @return Whether the two keys are equal
+     */
+    bool operator==(const PtaskMatrixKey & other) const;
+};
+
+/**
+ * @brief Computes the hash of a PtaskMatrixKey
+ */
+struct PtaskMatrixKeyHash
+{
+    /**
+     * @brief Computes the hash of a PtaskMatrixKey
+     * @param[in] key The key
+     * @return The hash of the key
+     */
+    size_t operator()(const PtaskMatrixKey & key) const;
+};
+
+/**
+ * @brief Keeps the matrices of the most recently executed homogeneous parallel tasks, so that they are not generated again for each execution
+ * @details Cached matrices are immutable and shared by all the tasks that use them, which only access them by reference.
+ *          SimGrid still copies the amounts into each execution it creates: the cache saves their generation, not this copy.
+ *          The least recently used matrices are evicted when the cache exceeds its maximum size.
+ *          The cache can be used concurrently by job actors that run on different threads (SimGrid parallel contexts).
+ */
+class PtaskMatrixCache
+{
+public:
+    /**
+     * @brief Builds an empty PtaskMatrixCache
+     * @param[in] max_size The maximum amount of memory (in bytes) used by the cached matrices. 0 disables caching.
+     */
+    explicit PtaskMatrixCache(size_t max_size = 256*1024*1024);
+
+    /**
+     * @brief Sets the maximum amount of memory used by the cached matrices, evicting matrices if needed
+     * @param[in] max_size The maximum amount of memory (in bytes) used by the cached matrices. 0 disables caching.
+     */
+    void set_max_size(size_t max_size);
+
+    /**
+     * @brief Returns the matrices that correspond to a key, generating them if they are not in the cache
+     * @param[in] key The key of the matrices
+     * @param[in] generator The function that fills the matrices, only called if they are not in the cache
+     * @return The matrices
+     */
+    PtaskMatricesPtr get(const PtaskMatrixKey & key, const std::function<void(PtaskMatrices &)> & generator);
+
+    /**
+     * @brief Returns the number of calls to get that found their matrices in the cache
+     * @return The number of cache hits
+     */
+    uint64_t nb_hits() const;
+
+    /**
+     * @brief Returns the number of calls to get that had to generate their matrices
+     * @return The number of cache misses
+     */
+    uint64_t nb_misses() const;
+
+    /**
+     * @brief Returns the number of matrices that have been evicted from the cache
+     * @return The number of evictions
+     */
+    uint64_t nb_evictions() const;
+
+    /**
+     * @brief Returns the amount of memory currently used by the cached matrices
+     * @return The amount of memory (in bytes) currently used by the cached matrices
+     */
+    size_t size() const;
+
+private:
+    /**
+     * @brief Evicts the least recently used matrices until the cache fits in its maximum size
+     * @pre _mutex is held by the caller
+     */
+    void evict();
+
+private:
+    typedef std::list<std::pair<PtaskMatrixKey, PtaskMatricesPtr> > LruList; //!< Cached matrices, from the most to the least recently used
+
+    size_t _max_size;                   //!< The maximum amount of memory (in bytes) used by the cached matrices
+    size_t _size = 0;                   //!< The amount of memory (in bytes) currently used by the cached matrices
+    LruList _lru;                       //!< The cached matrices, from the most to the least recently used
+    std::unordered_map<PtaskMatrixKey, LruList::iterator, PtaskMatrixKeyHash> _index; //!< Where each key is in _lru
+    uint64_t _nb_hits = 0;              //!< The number of cache hits
+    uint64_t _nb_misses = 0;            //!< The number of cache misses
+    uint64_t _nb_evictions = 0;         //!< The number of evictions
+    mutable std::mutex _mutex;          //!< Protects all the other members
+};
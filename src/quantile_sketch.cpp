@@ -0,0 +1,157 @@
+/**
+ * @file quantile_sketch.cpp
+ * @brief Mergeable streaming quantile sketches
+ */
+
+#include "quantile_sketch.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <xbt.h>
+
+using namespace std;
+
+//! Values whose absolute value is below this threshold are counted as zeros
+static const double ZERO_THRESHOLD = 1e-9;
+
+QuantileSketch::QuantileSketch(double relative_accuracy) :
+    _relative_accuracy(relative_accuracy)
+{
+    xbt_assert(relative_accuracy > 0 && relative_accuracy < 1,
+               "Invalid quantile sketch relative accuracy (%g): must be in ]0,1[", relative_accuracy);
+    _gamma = (1 + relative_accuracy) / (1 - relative_accuracy);
+    _log_gamma = log(_gamma);
+}
+
+void QuantileSketch::add(double value)
+{
+    if (!std::isfinite(value))
+    {
+        // e.g., the slowdown of a job whose execution time is 0
+        return;
+    }
+
+    if (_count == 0)
+    {
+        _min = value;
+        _max = value;
+    }
+    else
+    {
+        _min = std::min(_min, value);
+        _max = std::max(_max, value);
+    }
+    ++_count;
+
+    if (value < ZERO_THRESHOLD)
+    {
+        ++_nb_zeros;
+    }
+    else
+    {
+        ++_buckets[bucket_index(value)];
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch & other)
+{
+    xbt_assert(_relative_accuracy == other._relative_accuracy,
+               "Cannot merge quantile sketches of different accuracies (%g and %g)",
+               _relative_accuracy, other._relative_accuracy);
+
+    if (other._count == 0)
+    {
+        return;
+    }
+
+    if (_count == 0)
+    {
+        _min = other._min;
+        _max = other._max;
+    }
+    else
+    {
+        _min = std::min(_min, other._min);
+        _max = std::max(_max, other._max);
+    }
+    _count += other._count;
+    _nb_zeros += other._nb_zeros;
+
+    for (const auto & bucket : other._buckets)
+    {
+        _buckets[bucket.first] += bucket.second;
+    }
+}
+
+double QuantileSketch::quantile(double q) const
+{
+    xbt_assert(q >= 0 && q <= 1, "Invalid quantile (%g): must be in [0,1]", q);
+    if (_count == 0)
+    {
+        return 0;
+    }
+
+    // Rank (0-based) of the value to find
+    const double rank = q * static_cast<double>(_count - 1);
+
+    uint64_t nb_seen = _nb_zeros;
+    if (static_cast<double>(nb_seen) > rank)
+    {
+        return std::max(_min, 0.0);
+    }
+
+    for (const auto & bucket : _buckets)
+    {
+        nb_seen += bucket.second;
+        if (static_cast<double>(nb_seen) > rank)
+        {
+            return std::clamp(bucket_value(bucket.first), _min, _max);
+        }
+    }
+
+    return _max;
+}
+
+uint64_t QuantileSketch::count() const
+{
+    return _count;
+}
+
+double QuantileSketch::min() const
+{
+    return _min;
+}
+
+double QuantileSketch::max() const
+{
+    return _max;
+}
+
+std::vector<std::pair<double, uint64_t> > QuantileSketch::log2_histogram() const
+{
+    map<double, uint64_t> bins;
+    if (_nb_zeros > 0)
+    {
+        bins[0] = _nb_zeros;
+    }
+
+    for (const auto & bucket : _buckets)
+    {
+        const double upper_bound = exp2(ceil(log2(bucket_value(bucket.first))));
+        bins[upper_bound] += bucket.second;
+    }
+
+    return vector<pair<double, uint64_t> >(bins.begin(), bins.end());
+}
+
+int QuantileSketch::bucket_index(double value) const
+{
+    return static_cast<int>(ceil(log(value) / _log_gamma));
+}
+
+double QuantileSketch::bucket_value(int index) const
+{
+    // Bucket i contains values in ]gamma^(i-1), gamma^i]
+    return 2 * pow(_gamma, index) / (_gamma + 1);
+}
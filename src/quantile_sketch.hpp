@@ -0,0 +1,98 @@
+/**
+ * @file quantile_sketch.hpp
+ * @brief Mergeable streaming quantile sketches
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Streaming quantile sketch with a bounded relative error
+ * @details Values are counted in logarithmically-sized buckets (as in DDSketch),
+ *          so that any quantile is estimated with a relative error lower than the accuracy given at construction.
+ *          Memory usage depends on the range of the values, not on their number.
+ *          Sketches with the same accuracy can be merged.
+ *          Values are expected to be non-negative, negative values are counted as zeros.
+ */
+class QuantileSketch
+{
+public:
+    /**
+     * @brief Builds an empty QuantileSketch
+     * @param[in] relative_accuracy The maximum relative error of the estimated quantiles. Must be in ]0,1[.
+     */
+    explicit QuantileSketch(double relative_accuracy = 0.01);
+
+    /**
+     * @brief Adds a value into the sketch
+     * @details Non-finite values are ignored.
+     * @param[in] value The value to add
+     */
+    void add(double value);
+
+    /**
+     * @brief Merges another sketch into this one
+     * @param[in] other The sketch to merge. Its accuracy must be the same as this one's.
+     */
+    void merge(const QuantileSketch & other);
+
+    /**
+     * @brief Estimates a quantile of the values added so far
+     * @param[in] q The quantile to estimate, in [0,1] (e.g., 0.95 for the 95th percentile)
+     * @return The estimated quantile, or 0 if the sketch is empty
+     */
+    double quantile(double q) const;
+
+    /**
+     * @brief Returns the number of values added so far
+     * @return The number of values added so far
+     */
+    uint64_t count() const;
+
+    /**
+     * @brief Returns the minimum value added so far
+     * @return The minimum value added so far, or 0 if the sketch is empty
+     */
+    double min() const;
+
+    /**
+     * @brief Returns the maximum value added so far
+     * @return The maximum value added so far, or 0 if the sketch is empty
+     */
+    double max() const;
+
+    /**
+     * @brief Computes a coarse histogram of the values added so far, with power-of-two bins
+     * @return The non-empty bins as (upper bound, count) pairs, sorted by increasing upper bound. Zeros are counted in the bin whose upper bound is 0.
+     */
+    std::vector<std::pair<double, uint64_t> > log2_histogram() const;
+
+private:
+    /**
+     * @brief Computes the bucket into which a strictly positive value falls
+     * @param[in] value The value
+     * @return The bucket index
+     */
+    int bucket_index(double value) const;
+
+    /**
+     * @brief Computes the value that represents a bucket
+     * @param[in] index The bucket index
+     * @return The value that represents all values of the bucket
+     */
+    double bucket_value(int index) const;
+
+private:
+    double _relative_accuracy;          //!< The maximum relative error of estimated quantiles
+    double _gamma;                      //!< The ratio between the bounds of each bucket
+    double _log_gamma;                  //!< The natural logarithm of _gamma
+    std::map<int, uint64_t> _buckets;   //!< The number of values in each (non-empty) bucket
+    uint64_t _nb_zeros = 0;             //!< The number of values too close to zero to be put in a bucket
+    uint64_t _count = 0;                //!< The number of values added so far
+    double _min = 0;                    //!< The minimum value added so far
+    double _max = 0;                    //!< The maximum value added so far
+};
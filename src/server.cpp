@@ -16,6 +16,7 @@
 #include <simgrid/s4u.hpp>
 
 #include "context.hpp"
+#include "internal_tracing.hpp"
 #include "ipp.hpp"
 #include "jobs_execution.hpp"
 #include "periodic.hpp"
@@ -30,6 +31,13 @@ void server_process(BatsimContext * context)
     data->context = context;
     data->sched_ready = true;
 
+    // Created before any job runs, so that job actors never have to create them concurrently
+    if (context->fast_forward_sequences)
+    {
+        context->platform_change_cv = simgrid::s4u::ConditionVariable::create();
+        context->platform_change_mutex = simgrid::s4u::Mutex::create();
+    }
+
     // Init the EDC and retrieve its answer
     uint32_t flags;
     double now = -1;
@@ -76,6 +84,8 @@ void server_process(BatsimContext * context)
     handler_map[IPMessageType::SWITCHED_OFF] = server_on_switched;
     handler_map[IPMessageType::SCHED_END_DYNAMIC_REGISTRATION] = server_on_end_dynamic_registration;
     handler_map[IPMessageType::SCHED_FORCE_SIMULATION_STOP] = server_on_force_simulation_stop;
+    handler_map[IPMessageType::TIME_WINDOW_START] = server_on_time_window_start;
+    handler_map[IPMessageType::TIME_WINDOW_END] = server_on_time_window_end;
     handler_map[IPMessageType::EXTERNAL_EVENTS_OCCURRED] = server_on_external_events_occurred;
 
     /* Currently, there is one job submtiter per workload input file.
@@ -102,6 +112,13 @@ void server_process(BatsimContext * context)
             mailbox_empty("server")                  // The server mailbox must be empty
             )
         {
+            if (data->time_window_end_reached && !data->simulation_stop_asked && !data->end_of_simulation_sent)
+            {
+                // Stopped as if the EDC asked it, the EDC is then told that the simulation ends
+                XBT_INFO("The end of the time window has been reached, stopping the simulation.");
+                server_on_force_simulation_stop(data, nullptr);
+            }
+
             if (data->simulation_stop_asked)
             {
                 // To trigger the SIMULATION_ENDS event
@@ -145,7 +162,11 @@ void server_process(BatsimContext * context)
                    "The server does not know how to handle message type %s.",
                    ip_message_type_to_string(message->type).c_str());
         auto handler_function = handler_map[message->type];
-        handler_function(data, message);
+        {
+            BATSIM_TRACE_SPAN("server", "server_on_" + ip_message_type_to_string(message->type));
+            handler_function(data, message);
+        }
+        ++context->nb_server_messages_handled;
 
         // Delete the message
         delete message;
@@ -184,7 +205,14 @@ void finish_message_and_call_edc(ServerData * data)
 
     uint8_t * what_happened_buffer = nullptr;
     uint32_t what_happened_buffer_size = 0u;
-    batprotocol::serialize_message(*context->proto_msg_builder, context->edc_json_format, (const uint8_t**)&what_happened_buffer, &what_happened_buffer_size);
+    {
+        BATSIM_TRACE_SPAN("protocol", "serialize_message");
+        auto start = chrono::steady_clock::now();
+        batprotocol::serialize_message(*context->proto_msg_builder, context->edc_json_format, (const uint8_t**)&what_happened_buffer, &what_happened_buffer_size);
+        auto end = chrono::steady_clock::now();
+        context->microseconds_used_by_serialization += static_cast<long double>(chrono::duration <long double, micro> (end - start).count());
+    }
+    context->nb_bytes_sent_to_edc += what_happened_buffer_size;
 
     // call the external decision component
     double now = -1;
@@ -193,11 +221,14 @@ void finish_message_and_call_edc(ServerData * data)
     {
         auto start = chrono::steady_clock::now();
 
+        BATSIM_TRACE_SPAN("edc", "take_decisions");
         context->edc->take_decisions(what_happened_buffer, what_happened_buffer_size, now, messages, context);
 
         auto end = chrono::steady_clock::now();
         long double elapsed_microseconds = static_cast<long double>(chrono::duration <long double, micro> (end - start).count());
         context->microseconds_used_by_scheduler += elapsed_microseconds;
+        context->nb_edc_calls++;
+        context->edc_call_latency_us.add(static_cast<double>(elapsed_microseconds));
     }
     catch(const std::runtime_error & error)
     {
@@ -208,6 +239,7 @@ void finish_message_and_call_edc(ServerData * data)
         data = nullptr;
 
         finalize_batsim_outputs(context);
+        internal_tracing::stop();
 
         XBT_INFO("Output files flushed. Aborting execution now.");
         throw runtime_error("Execution aborted (communication with external decision component failed)");
@@ -292,23 +324,81 @@ void server_on_submitter_bye(ServerData * data,
     }
 }
 
-void server_on_job_completed(ServerData * data,
-                             IPMessage * task_data)
+/**
+ * @brief Updates the machines, the consumed energy and the tracers when a job starts its execution
+ * @details This is done by the server rather than by job actors, which may run on several threads.
+ * @param[in,out] data The data associated with the server actor
+ * @param[in] job The job
+ */
+static void account_job_start(ServerData * data, const JobPtr & job)
 {
-    xbt_assert(task_data->data != nullptr, "inconsistency: task_data has null data");
-    auto * message = static_cast<JobCompletedMessage *>(task_data->data);
+    BatsimContext * context = data->context;
+    const IntervalSet & hosts = job->execution_request->job_allocation->hosts;
 
-    if (data->origin_of_jobs.count(message->job->id) == 1)
+    if (context->energy_used)
     {
-        // Let's call the submitter which submitted the job back
-        SubmitterJobCompletionCallbackMessage * msg = new SubmitterJobCompletionCallbackMessage;
-        msg->job_id = message->job->id;
+        // If energy is enabled, compute the energy used by the machines before running the job
+        job->consumed_energy = consumed_energy_on_machines(context, hosts);
 
-        ServerData::Submitter * submitter = data->origin_of_jobs.at(message->job->id);
-        send_message(submitter->mailbox, IPMessageType::SUBMITTER_CALLBACK, static_cast<void*>(msg));
+        // Trace the consumed energy
+        context->energy_tracer.add_job_start(simgrid::s4u::Engine::get_clock(), job->id);
+    }
+
+    context->machines.update_machines_on_job_run(job, hosts, context);
+}
+
+/**
+ * @brief Updates the machines, the consumed energy and the tracers when a job ends its execution (or is killed)
+ * @details This is done by the server rather than by job actors, which may run on several threads.
+ * @param[in,out] data The data associated with the server actor
+ * @param[in] job The job
+ */
+static void account_job_end(ServerData * data, const JobPtr & job)
+{
+    BatsimContext * context = data->context;
+    const IntervalSet & hosts = job->execution_request->job_allocation->hosts;
+
+    context->machines.update_machines_on_job_end(job, hosts, context);
+    job->execution_actors.take_all();
+
+    if (context->energy_used)
+    {
+        // The consumed energy is the difference (consumed_energy_after_job - consumed_energy_before_job)
+        long double consumed_energy_before = job->consumed_energy;
+        job->consumed_energy = consumed_energy_on_machines(context, hosts) - consumed_energy_before;
+
+        // Trace the consumed energy
+        context->energy_tracer.add_job_end(simgrid::s4u::Engine::get_clock(), job->id);
+    }
+}
+
+/**
+ * @brief Calls the submitter of a finished job back, if it asked for it
+ * @details The message is sent asynchronously, as the submitter may itself be sending jobs to the server.
+ * @param[in,out] data The data associated with the server actor
+ * @param[in] job The job, which has completed, been killed or been rejected
+ */
+static void call_job_submitter_back(ServerData * data, const JobPtr & job)
+{
+    auto origin_it = data->origin_of_jobs.find(job->id);
+    if (origin_it != data->origin_of_jobs.end())
+    {
+        SubmitterJobCompletionCallbackMessage * msg = new SubmitterJobCompletionCallbackMessage;
+        msg->job_id = job->id;
+        msg->job_state = job->state;
 
-        data->origin_of_jobs.erase(message->job->id);
+        dsend_message(origin_it->second->mailbox, IPMessageType::SUBMITTER_CALLBACK, static_cast<void*>(msg));
+        data->origin_of_jobs.erase(origin_it);
     }
+}
+
+void server_on_job_completed(ServerData * data,
+                             IPMessage * task_data)
+{
+    xbt_assert(task_data->data != nullptr, "inconsistency: task_data has null data");
+    auto * message = static_cast<JobCompletedMessage *>(task_data->data);
+    account_job_end(data, message->job);
+    call_job_submitter_back(data, message->job);
 
     data->nb_running_jobs--;
     xbt_assert(data->nb_running_jobs >= 0, "inconsistency: no jobs are running");
@@ -336,8 +426,26 @@ void server_on_job_submitted(ServerData * data,
     auto * message = static_cast<JobSubmittedMessage *>(task_data->data);
 
     ServerData::Submitter * submitter = data->submitters.at(message->submitter_name);
+
+    if (data->context->energy_first_job_submission < 0 && !message->jobs.empty())
+    {
+        data->context->energy_first_job_submission = data->context->machines.total_consumed_energy(data->context);
+    }
+
     for (JobPtr & job : message->jobs)
     {
+        // Streamed jobs are created by their submitter, but only the server modifies workloads
+        Workload * workload = job->workload;
+        if (!workload->jobs->exists(job->id))
+        {
+            // The profile of a streamed job may have been garbage collected with the previous jobs that used it
+            if (!workload->profiles->is_alive(job->profile->name))
+            {
+                workload->profiles->add_profile(job->profile->name, job->profile);
+            }
+            workload->jobs->add_job(job);
+        }
+
         if (submitter->should_be_called_back)
         {
             xbt_assert(data->origin_of_jobs.count(job->id) == 0, "inconsistency: submitter should be called back but job's submitter has not been tracked");
@@ -410,6 +518,7 @@ void server_on_change_hosts_pstate(ServerData * data,
         machine->host->set_pstate(message->new_pstate);
         xbt_assert(machine->host->get_pstate() == message->new_pstate, "pstate inconsistency: the desired pstate has not been set");
     }
+    data->context->notify_platform_change();
 
     data->context->proto_msg_builder->add_hosts_pstate_changed(message->machine_ids.to_string_hyphen(" ", "-"), message->new_pstate);
 }
@@ -523,9 +632,17 @@ void server_on_switched(ServerData * data,
     auto * message = static_cast<SwitchMessage *>(task_data->data);
     xbt_assert(data->context->machines.exists(message->machine_id), "machine %d does not exist", message->machine_id);
     Machine * machine = data->context->machines[message->machine_id];
-    (void) machine; // Avoids a warning if assertions are ignored
     xbt_assert(machine->host->get_pstate() == message->new_pstate, "pstate inconsistency: the desired pstate has not been set");
 
+    if (machine->pstates[message->new_pstate] == PStateType::COMPUTATION_PSTATE)
+    {
+        machine->update_machine_state(MachineState::IDLE);
+    }
+    else
+    {
+        machine->update_machine_state(MachineState::SLEEPING);
+    }
+
     IntervalSet all_switched_machines;
     // mark_switch_as_done returns true if all switches have finished
     if (data->context->current_switches.mark_switch_as_done(message->machine_id, message->new_pstate,
@@ -576,6 +693,12 @@ void server_on_periodic_trigger(ServerData * data,
         if (probe_data->is_last_periodic)
             --data->nb_probe_entities;
 
+        if (data->context->probe_tracing_strategy == ProbeTracingStrategy::ALWAYS) {
+            data->context->probe_data_tracer.add_probe_data(simgrid::s4u::Engine::get_clock(), *probe_data);
+            if (probe_data->is_last_periodic)
+                data->context->probe_data_tracer.close_series(probe_data->metadata->probe_id);
+        }
+
         std::shared_ptr<batprotocol::ProbeData> pdata;
         switch (probe_data->data_type) {
             case batprotocol::fb::ProbeData_VectorialProbeData: {
@@ -589,12 +712,13 @@ void server_on_periodic_trigger(ServerData * data,
             } break;
         }
 
-        switch(probe_data->resource_type) {
+        const auto & metadata = *probe_data->metadata;
+        switch(metadata.resource_type) {
             case batprotocol::fb::Resources_HostResources: {
-                pdata->set_resources_as_hosts(probe_data->hosts.to_string_hyphen(" ", "-"));
+                pdata->set_resources_as_hosts(metadata.hosts_str);
             } break;
             case batprotocol::fb::Resources_LinkResources: {
-                pdata->set_resources_as_links(std::make_shared<std::vector<std::string> >(std::move(probe_data->links)));
+                pdata->set_resources_as_links(metadata.links);
             } break;
             default: {
                 xbt_assert(false, "unimplemented probe resource type");
@@ -602,7 +726,7 @@ void server_on_periodic_trigger(ServerData * data,
         }
 
         data->context->proto_msg_builder->add_probe_data_emitted(
-            probe_data->probe_id, probe_data->metrics, pdata,
+            metadata.probe_id, metadata.metrics, pdata,
             probe_data->manually_triggered, probe_data->nb_emitted, probe_data->nb_triggered
         );
     }
@@ -614,8 +738,11 @@ void server_on_periodic_entity_stopped(ServerData * data,
     xbt_assert(task_data->data != nullptr, "inconsistency: task_data has null data");
     auto * message = static_cast<PeriodicEntityStoppedMessage *>(task_data->data);
 
-    if (message->is_probe)
+    if (message->is_probe) {
         --data->nb_probe_entities;
+        // The identifier of the probe can now be reused by a new probe, which gets its own output file
+        data->context->probe_data_tracer.close_series(message->entity_id);
+    }
     else if (message->is_call_me_later)
         --data->nb_callmelater_entities;
 }
@@ -649,6 +776,9 @@ void server_on_killing_done(ServerData * data,
         const auto job = data->context->workloads.job_at(job_id);
         if (job->state == JobState::JOB_STATE_COMPLETED_KILLED)
         {
+            account_job_end(data, job);
+            call_job_submitter_back(data, job);
+
             data->nb_running_jobs--;
             xbt_assert(data->nb_running_jobs >= 0, "inconsistency: no jobs are running");
             data->nb_completed_jobs++;
@@ -731,11 +861,10 @@ void server_on_force_simulation_stop(ServerData * data,
             bool cancelled_ptask = cancel_ptasks(job->task);
             if (!cancelled_ptask)
             {
-                for (simgrid::s4u::ActorPtr actor : job->execution_actors)
+                for (simgrid::s4u::ActorPtr actor : job->execution_actors.take_all())
                 {
                     actor->kill();
                 }
-                job->execution_actors.clear();
             }
         }
         machine->jobs_being_computed.clear();
@@ -748,8 +877,11 @@ void server_on_force_simulation_stop(ServerData * data,
     }
     data->switcher_actors.clear();
 
-    // Kill the scheduler REQ-REP actor
-    data->sched_req_rep_actor->kill();
+    // Kill the scheduler REQ-REP actor (it may not exist when the stop comes from the time window)
+    if (data->sched_req_rep_actor != nullptr)
+    {
+        data->sched_req_rep_actor->kill();
+    }
 
     // Clear the server mailbox (no need to handle next scheduling events)
     clear_mailbox("server");
@@ -759,20 +891,51 @@ void server_on_force_simulation_stop(ServerData * data,
     data->context->proto_msg_builder->clear(simgrid::s4u::Engine::get_clock());
 }
 
-void server_on_register_job(ServerData * data,
-                            IPMessage * task_data)
+void server_on_time_window_start(ServerData * data,
+                                 IPMessage * task_data)
 {
-    xbt_assert(task_data->data != nullptr, "inconsistency: task_data has null data");
-    auto * message = static_cast<JobRegisteredByEDCMessage *>(task_data->data);
-    JobPtr job = message->job;
-    JobIdentifier job_id = job->id;
+    (void) task_data;
 
-    // Retrieve the workload of the job (or create it)
+    // Energy consumed during the warm-up is not reported
+    XBT_DEBUG("Handling time window start");
+    data->context->energy_first_job_submission = data->context->machines.total_consumed_energy(data->context);
+}
+
+void server_on_time_window_end(ServerData * data,
+                               IPMessage * task_data)
+{
+    (void) task_data;
+
+    // The simulation is stopped once the EDC is not being called
+    XBT_DEBUG("Handling time window end");
+    data->time_window_end_reached = true;
+}
+
+void time_window_process(BatsimContext * context)
+{
+    const TimeWindow & window = context->time_window;
+
+    if (window.start > simgrid::s4u::Engine::get_clock())
+    {
+        simgrid::s4u::this_actor::sleep_until(window.start);
+    }
+    send_message("server", IPMessageType::TIME_WINDOW_START, nullptr);
+
+    simgrid::s4u::this_actor::sleep_until(window.end);
+    send_message("server", IPMessageType::TIME_WINDOW_END, nullptr);
+}
+
+/**
+ * @brief Retrieves the workload of a dynamically registered job, creating it if needed
+ * @param[in,out] data The data associated with the server actor
+ * @param[in] job_id The identifier of the job
+ * @return The workload of the job
+ */
+static Workload * retrieve_registered_job_workload(ServerData * data, const JobIdentifier & job_id)
+{
     Workload * workload;
     if (data->context->workloads.exists(job_id.workload_name()))
     {
-        xbt_assert(!data->context->workloads.job_is_registered(job_id),
-                   "Invalid new job registration: '%s' already exists in the workload.", job_id.to_cstring());
         workload = data->context->workloads.at(job_id.workload_name());
     }
     else
@@ -782,67 +945,122 @@ void server_on_register_job(ServerData * data,
         XBT_INFO("Created new dynamic workload %s", job_id.workload_name().c_str());
     }
 
-    // Retrieve the Profile
-    ProfilePtr profile;
+    return workload;
+}
 
+/**
+ * @brief Retrieves the profile of a dynamically registered job
+ * @param[in,out] data The data associated with the server actor
+ * @param[in] workload The workload of the job
+ * @param[in] job_id The identifier of the job
+ * @param[in] profile_id The profile id given by the EDC
+ * @return The profile of the job
+ */
+static ProfilePtr retrieve_registered_job_profile(ServerData * data, Workload * workload, const JobIdentifier & job_id, const std::string & profile_id)
+{
     // Expecting a "workload!name" syntax in profile_id, but "name" is also allowed (in this case, only profiles from the job's workload can be used)
-    auto tsplit = message->profile_id.find('!');
+    auto tsplit = profile_id.find('!');
     if (tsplit == std::string::npos)
     {
         // Profile_id does not contain a workload name, add the job's workload to it
-        std::string profile_name = workload->name + "!" + message->profile_id;
+        std::string profile_name = workload->name + "!" + profile_id;
 
         // check if profile is in the Job's workload
         xbt_assert(workload->profiles->exists(profile_name),
                     "Invalid new job registration for '%s': the associated profile '%s' does not exist",
                     job_id.to_cstring(), profile_name.c_str());
 
-        profile = workload->profiles->at(profile_name);
+        return workload->profiles->at(profile_name);
     }
-    else
-    {
-        // Profile_id contains the workload name
-        std::string profile_workload_str = message->profile_id.substr(0, tsplit);
-        xbt_assert(data->context->workloads.exists(profile_workload_str),
-                   "Invalid new job resgistration for '%s': the profile's workload does not exist (%s)",
-                   job_id.to_cstring(), profile_workload_str.c_str());
 
-        xbt_assert(data->context->workloads.profile_is_registered(message->profile_id, profile_workload_str),
-                   "Invalid new job registration for '%s': the profile does not exist (%s).",
-                   job_id.to_cstring(), message->profile_id.c_str());
+    // Profile_id contains the workload name
+    std::string profile_workload_str = profile_id.substr(0, tsplit);
+    xbt_assert(data->context->workloads.exists(profile_workload_str),
+               "Invalid new job resgistration for '%s': the profile's workload does not exist (%s)",
+               job_id.to_cstring(), profile_workload_str.c_str());
 
-        profile = data->context->workloads.at(profile_workload_str)->profiles->at(message->profile_id);
-    }
+    xbt_assert(data->context->workloads.profile_is_registered(profile_id, profile_workload_str),
+               "Invalid new job registration for '%s': the profile does not exist (%s).",
+               job_id.to_cstring(), profile_id.c_str());
 
-    // Let's update some global and job parameters
-    ++data->nb_submitted_jobs;
-
-    job->profile = profile;
-    job->workload = workload;
-    job->state = JobState::JOB_STATE_SUBMITTED;
-    job->submission_time = simgrid::s4u::Engine::get_clock();
-
-    workload->check_single_job_validity(message->job);
-    workload->jobs->add_job(message->job);
+    return data->context->workloads.at(profile_workload_str)->profiles->at(profile_id);
+}
 
-    XBT_INFO("Adding dynamically registered job '%s' to workload '%s'",
-             job_id.job_name().c_str(), job_id.workload_name().c_str());
+void server_on_register_job(ServerData * data,
+                            IPMessage * task_data)
+{
+    xbt_assert(task_data->data != nullptr, "inconsistency: task_data has null data");
+    auto * message = static_cast<JobsRegisteredByEDCMessage *>(task_data->data);
+    const double now = simgrid::s4u::Engine::get_clock();
+    const size_t nb_jobs = message->jobs.size();
 
     if (data->context->registration_sched_ack)
     {
         // TODO: handle the multi-EDC
+        data->context->proto_msg_builder->set_current_time(now);
+    }
 
-        data->context->proto_msg_builder->set_current_time(simgrid::s4u::Engine::get_clock());
+    // The jobs of a batch usually share their workload and profile: only look them up when they change
+    Workload * workload = nullptr;
+    Workload * profile_lookup_workload = nullptr;
+    const std::string * profile_id = nullptr;
+    ProfilePtr profile;
 
-        if (data->context->forward_profiles_on_job_submission)
+    for (size_t i = 0; i < nb_jobs; ++i)
+    {
+        JobPtr job = message->jobs[i];
+        const JobIdentifier & job_id = job->id;
+
+        if (workload == nullptr || workload->name != job_id.workload_name())
         {
-            data->context->proto_msg_builder->add_job_submitted(job->id.to_string(), protocol::to_job(*job), job->submission_time, job->profile->name, protocol::to_profile(*(job->profile)));
+            workload = retrieve_registered_job_workload(data, job_id);
+            workload->jobs->reserve(nb_jobs - i);
         }
-        else
+        xbt_assert(!workload->jobs->exists(job_id),
+                   "Invalid new job registration: '%s' already exists in the workload.", job_id.to_cstring());
+
+        if (profile_id == nullptr || *profile_id != message->profile_ids[i] || profile_lookup_workload != workload)
         {
-            data->context->proto_msg_builder->add_job_submitted(job->id.to_string(), protocol::to_job(*job), job->submission_time);
+            profile_id = &message->profile_ids[i];
+            profile_lookup_workload = workload;
+            profile = retrieve_registered_job_profile(data, workload, job_id, *profile_id);
+        }
+
+        // Let's update some global and job parameters
+        ++data->nb_submitted_jobs;
+
+        job->profile = profile;
+        job->workload = workload;
+        job->state = JobState::JOB_STATE_SUBMITTED;
+        job->submission_time = now;
+
+        workload->check_single_job_validity(job);
+        workload->jobs->add_job(job);
+
+        if (nb_jobs == 1)
+        {
+            XBT_INFO("Adding dynamically registered job '%s' to workload '%s'",
+                     job_id.job_name().c_str(), job_id.workload_name().c_str());
+        }
+
+        if (data->context->registration_sched_ack)
+        {
+            if (data->context->forward_profiles_on_job_submission)
+            {
+                data->context->proto_msg_builder->add_job_submitted(job->id.to_string(), protocol::to_job(*job), job->submission_time, job->profile->name, protocol::to_profile(*(job->profile)));
+            }
+            else
+            {
+                data->context->proto_msg_builder->add_job_submitted(job->id.to_string(), protocol::to_job(*job), job->submission_time);
+            }
         }
     }
+
+    if (nb_jobs > 1)
+    {
+        XBT_INFO("Added %zu dynamically registered jobs (from '%s' to '%s')",
+                 nb_jobs, message->jobs.front()->id.to_cstring(), message->jobs.back()->id.to_cstring());
+    }
 }
 
 void server_on_register_profile(ServerData * data,
@@ -898,6 +1116,7 @@ void server_on_reject_job(ServerData * data,
 
     job->state = JobState::JOB_STATE_REJECTED;
     data->nb_completed_jobs++;
+    call_job_submitter_back(data, job);
 
     XBT_INFO("Job '%s' has been rejected", job->id.to_cstring());
 
@@ -925,6 +1144,7 @@ void server_on_kill_jobs(ServerData * data, IPMessage * task_data)
 
             // Mark that the job kill has been requested
             job->kill_requested = true;
+            message->jobs.push_back(job);
 
             ++job_id_it;
         }
@@ -952,6 +1172,35 @@ void server_on_create_probe(ServerData * data,
     ++data->nb_probe_entities;
 
     xbt_assert(message->is_periodic, "non-periodic probes are not implemented");
+
+    // Everything that does not change during the life of the probe is computed once here
+    auto metadata = std::make_shared<ProbeMetadata>();
+    metadata->probe_id = message->probe_id;
+    metadata->metrics = message->metrics;
+    metadata->resource_type = message->resource_type;
+    if (message->resource_type == batprotocol::fb::Resources_HostResources)
+    {
+        metadata->hosts = message->hosts;
+        metadata->hosts_str = message->hosts.to_string_hyphen(" ", "-");
+
+        message->probed_hosts.reserve(message->hosts.size());
+        for (auto it = message->hosts.elements_begin(); it != message->hosts.elements_end(); ++it)
+        {
+            int machine_id = *it;
+            xbt_assert(data->context->machines.exists(machine_id),
+                       "invalid CreateProbe (probe_id='%s'): machine %d does not exist",
+                       message->probe_id.c_str(), machine_id);
+            message->probed_hosts.push_back(data->context->machines[machine_id]->host);
+        }
+        message->probed_values.resize(message->probed_hosts.size());
+    }
+    else
+    {
+        metadata->links = std::make_shared<std::vector<std::string>>(std::move(message->links));
+        message->links.clear();
+    }
+    message->metadata = std::move(metadata);
+
     send_message("periodic", IPMessageType::SCHED_CREATE_PROBE, task_data->data);
 }
 
@@ -1043,6 +1292,8 @@ void server_on_execute_job(ServerData * data,
                    machine->id, machine->name.c_str(), ps);
     }
 
+    account_job_start(data, job);
+
     string pname = "job_" + job->id.to_string();
     auto actor = simgrid::s4u::Engine::get_instance()->add_actor(pname.c_str(),
         data->context->machines[allocation->hosts.first_element()]->host,
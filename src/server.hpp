@@ -51,6 +51,7 @@ struct ServerData
     bool sched_said_hello = false; //!< Whether the scheduler said hello
 
     bool simulation_stop_asked = false;  //!< Whether a FORCE_SIMULATION_STOP event has been received
+    bool time_window_end_reached = false; //!< Whether the end of the simulated time window has been reached
     bool end_of_simulation_sent = false; //!< Whether the SIMULATION_ENDS event has been sent to the scheduler
     bool end_of_simulation_ack_received = false; //!< Whether the SIMULATION_ENDS acknowledgement (empty message) has been received
 
@@ -83,6 +84,12 @@ void finish_message_and_call_edc(ServerData * data);
  */
 void server_process(BatsimContext * context);
 
+/**
+ * @brief Process that tells the server when the start and the end of the simulated time window are reached
+ * @param[in] context The BatsimContext
+ */
+void time_window_process(BatsimContext * context);
+
 
 /**
  * @brief Server SUBMITTER_HELLO handler
@@ -206,6 +213,22 @@ void server_on_end_dynamic_registration(ServerData * data,
 void server_on_force_simulation_stop(ServerData * data,
                                      IPMessage * task_data);
 
+/**
+ * @brief Server TIME_WINDOW_START handler
+ * @param[in,out] data The data associated with the server_process
+ * @param[in,out] task_data The data associated with the message the server received
+ */
+void server_on_time_window_start(ServerData * data,
+                                 IPMessage * task_data);
+
+/**
+ * @brief Server TIME_WINDOW_END handler
+ * @param[in,out] data The data associated with the server_process
+ * @param[in,out] task_data The data associated with the message the server received
+ */
+void server_on_time_window_end(ServerData * data,
+                               IPMessage * task_data);
+
 /**
  * @brief Server SCHED_JOB_REGISTERED handler
  * @param[in,out] data The data associated with the server_process
@@ -0,0 +1,197 @@
+/**
+ * @file swf.cpp
+ * @brief Reading of workloads in the Standard Workload Format (SWF) of the Parallel Workloads Archive
+ */
+
+#include "swf.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <boost/algorithm/string.hpp>
+
+#include <xbt.h>
+
+#ifdef BATSIM_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(swf, "swf"); //!< Logging
+
+/**
+ * @brief The number of fields of each SWF job line
+ */
+static const int SWF_NB_FIELDS = 18;
+
+SwfReader::SwfReader(const string & filename) :
+    _filename(filename)
+{
+#ifdef BATSIM_WITH_ZLIB
+    // gzopen also reads uncompressed files
+    gzFile gzfile = gzopen(filename.c_str(), "rb");
+    xbt_assert(gzfile != nullptr, "Cannot read SWF file '%s': %s", filename.c_str(), strerror(errno));
+    gzbuffer(gzfile, 1 << 17);
+    _gzfile = gzfile;
+#else
+    xbt_assert(!boost::algorithm::ends_with(filename, ".gz"),
+               "Cannot read SWF file '%s': Batsim has been built without zlib", filename.c_str());
+    _file.open(filename);
+    xbt_assert(_file.is_open(), "Cannot read SWF file '%s': %s", filename.c_str(), strerror(errno));
+#endif
+
+    // The header is made of the comment lines at the beginning of the file
+    string line;
+    while (read_line(line))
+    {
+        boost::algorithm::trim(line);
+        if (line.empty())
+        {
+            continue;
+        }
+
+        if (line[0] == ';')
+        {
+            parse_header_line(line);
+        }
+        else
+        {
+            _pending_line = line;
+            _has_pending_line = true;
+            break;
+        }
+    }
+}
+
+SwfReader::~SwfReader()
+{
+#ifdef BATSIM_WITH_ZLIB
+    gzclose(static_cast<gzFile>(_gzfile));
+#endif
+}
+
+bool SwfReader::read_line(string & line)
+{
+    line.clear();
+
+#ifdef BATSIM_WITH_ZLIB
+    char buffer[4096];
+    gzFile gzfile = static_cast<gzFile>(_gzfile);
+    while (gzgets(gzfile, buffer, sizeof(buffer)) != nullptr)
+    {
+        line += buffer;
+        if (line.back() == '\n')
+        {
+            break;
+        }
+    }
+
+    int error;
+    const char * error_msg = gzerror(gzfile, &error);
+    xbt_assert(error == Z_OK || error == Z_BUF_ERROR,
+               "Cannot read SWF file '%s': %s", _filename.c_str(), error_msg);
+
+    if (line.empty())
+    {
+        return false;
+    }
+#else
+    if (!getline(_file, line))
+    {
+        return false;
+    }
+#endif
+
+    ++_line_number;
+    return true;
+}
+
+void SwfReader::parse_header_line(const string & line)
+{
+    // Header fields are written as "; Field: value"
+    auto colon_pos = line.find(':');
+    if (colon_pos == string::npos)
+    {
+        return;
+    }
+
+    string field = line.substr(1, colon_pos - 1);
+    boost::algorithm::trim(field);
+    const char * value = line.c_str() + colon_pos + 1;
+
+    if (field == "MaxProcs")
+    {
+        _max_nb_procs = atoi(value);
+    }
+    else if (field == "MaxNodes")
+    {
+        _max_nb_nodes = atoi(value);
+    }
+}
+
+bool SwfReader::read_job(SwfJob & job)
+{
+    string line;
+    for (;;)
+    {
+        if (_has_pending_line)
+        {
+            line = std::move(_pending_line);
+            _has_pending_line = false;
+        }
+        else if (!read_line(line))
+        {
+            return false;
+        }
+
+        boost::algorithm::trim(line);
+        if (line.empty() || line[0] == ';')
+        {
+            continue;
+        }
+
+        double fields[SWF_NB_FIELDS];
+        const char * cursor = line.c_str();
+        for (int i = 0; i < SWF_NB_FIELDS; ++i)
+        {
+            char * end;
+            fields[i] = strtod(cursor, &end);
+            xbt_assert(end != cursor, "Invalid SWF file '%s': line %u has %d fields instead of %d",
+                       _filename.c_str(), _line_number, i, SWF_NB_FIELDS);
+            cursor = end;
+        }
+
+        // Columns are numbered from 1 in the SWF specification
+        job.id = line.substr(0, line.find_first_of(" \t"));
+        job.submission_time = fields[1];
+        job.runtime = fields[3];
+        job.nb_res = static_cast<int>(fields[4]);
+        if (job.nb_res <= 0)
+        {
+            job.nb_res = static_cast<int>(fields[7]);
+        }
+        job.requested_time = fields[8];
+
+        if (job.nb_res <= 0 || job.runtime <= 0 || job.submission_time < 0)
+        {
+            XBT_DEBUG("Skipping SWF job '%s' (line %u): it cannot be simulated (nb_res=%d, runtime=%g, submission_time=%g)",
+                      job.id.c_str(), _line_number, job.nb_res, job.runtime, job.submission_time);
+            ++_nb_skipped_jobs;
+            continue;
+        }
+
+        return true;
+    }
+}
+
+int SwfReader::max_nb_procs() const
+{
+    return _max_nb_procs > 0 ? _max_nb_procs : _max_nb_nodes;
+}
+
+unsigned int SwfReader::nb_skipped_jobs() const
+{
+    return _nb_skipped_jobs;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file swf.hpp
+ * @brief Reading of workloads in the Standard Workload Format (SWF) of the Parallel Workloads Archive
+ */
+
+#pragma once
+
+#include <fstream>
+#include <string>
+
+/**
+ * @brief How the profile of the jobs of a SWF workload is built
+ */
+enum class SwfProfileMapping
+{
+    DELAY           //!< Jobs wait for their SWF runtime (as tools/swf_to_batsim_workload_delay.py)
+    ,PTASK          //!< Jobs compute runtime*speed flops on each of their machines, without communication (as tools/swf_to_batsim_workload_compute_only.py)
+};
+
+/**
+ * @brief How jobs are read from a SWF workload
+ */
+struct SwfWorkloadOptions
+{
+    SwfProfileMapping profile_mapping = SwfProfileMapping::DELAY; //!< How the profile of each job is built
+    double computation_speed = -1;  //!< The speed (in flop/s) used to convert runtimes into computation amounts. Only used by the PTASK mapping.
+    double walltime_factor = 2;     //!< The walltime of each job is max(requested time, walltime_factor * runtime)
+    int nb_res = -1;                //!< The number of machines the workload has been designed for. -1 means it is read from the SWF header.
+};
+
+/**
+ * @brief A job read from a SWF file
+ */
+struct SwfJob
+{
+    std::string id;             //!< The SWF job number
+    double submission_time;     //!< The submission time of the job, in seconds
+    double runtime;             //!< How long the job ran, in seconds
+    double requested_time;      //!< The runtime requested by the user, in seconds. Negative if unknown.
+    int nb_res;                 //!< The number of allocated processors (or requested ones if the allocation is unknown)
+};
+
+/**
+ * @brief Reads the jobs of a SWF file one by one, so that huge traces are never fully held in memory
+ * @details gzip-compressed files are read transparently if Batsim has been built with zlib.
+ *          Jobs that cannot be simulated (no processor, no runtime or negative submission time) are skipped.
+ */
+class SwfReader
+{
+public:
+    /**
+     * @brief Opens a SWF file and reads its header
+     * @param[in] filename The name of the SWF file
+     */
+    explicit SwfReader(const std::string & filename);
+
+    /**
+     * @brief Closes the SWF file
+     */
+    ~SwfReader();
+
+    SwfReader(const SwfReader &) = delete;              //!< SwfReader owns a file handle and cannot be copied
+    SwfReader & operator=(const SwfReader &) = delete;  //!< SwfReader owns a file handle and cannot be copied
+
+    /**
+     * @brief Reads the next valid job of the file
+     * @param[out] job The job read
+     * @return false if the end of the file has been reached, true otherwise
+     */
+    bool read_job(SwfJob & job);
+
+    /**
+     * @brief Returns the number of processors of the traced machine, as written in the SWF header
+     * @return The MaxProcs (or MaxNodes) header field, or -1 if the header does not have it
+     */
+    int max_nb_procs() const;
+
+    /**
+     * @brief Returns the number of jobs of the file that have been skipped so far
+     * @return The number of skipped jobs
+     */
+    unsigned int nb_skipped_jobs() const;
+
+private:
+    /**
+     * @brief Reads the next line of the file
+     * @param[out] line The line read, without its trailing newline
+     * @return false if the end of the file has been reached, true otherwise
+     */
+    bool read_line(std::string & line);
+
+    /**
+     * @brief Parses a header (comment) line, looking for the number of processors of the traced machine
+     * @param[in] line The comment line
+     */
+    void parse_header_line(const std::string & line);
+
+private:
+    std::string _filename;              //!< The name of the SWF file
+    void * _gzfile = nullptr;           //!< The zlib handle of the file, if Batsim has been built with zlib
+    std::ifstream _file;                //!< The file, if Batsim has been built without zlib
+    std::string _pending_line;          //!< The first job line of the file, read with the header
+    bool _has_pending_line = false;     //!< Whether _pending_line has not been parsed yet
+    unsigned int _line_number = 0;      //!< The number of lines read so far
+    int _max_nb_procs = -1;             //!< The MaxProcs header field, -1 if unknown
+    int _max_nb_nodes = -1;             //!< The MaxNodes header field, -1 if unknown
+    unsigned int _nb_skipped_jobs = 0;  //!< The number of jobs skipped so far
+};
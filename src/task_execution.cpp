@@ -5,6 +5,7 @@
 
 #include "task_execution.hpp"
 
+#include <unordered_map>
 #include <unordered_set>
 
 #include <simgrid/s4u.hpp>
@@ -44,29 +45,27 @@ void generate_parallel_task(
     computation_amount.resize(nb_executors, 0);
     communication_amount.resize(nb_executors*nb_executors, 0);
 
-    // Retrieve the matrices from the profile
+    // Retrieve the matrices from the profile. Sparse and structured communication matrices are expanded here.
     if (data->cpu != nullptr)
         memcpy(computation_amount.data(), data->cpu, sizeof(double) * nb_executors);
-    if (data->com != nullptr)
-        memcpy(communication_amount.data(), data->com, sizeof(double) * nb_executors * nb_executors);
+    if (data->has_communications())
+        data->fill_communication_matrix(communication_amount);
 }
 
 /**
  * @brief Generate the communication and computaion matrix for the
- *        parallel homogeneous task profile. Also set the prefix name of the task.
+ *        parallel homogeneous task profile.
  * @param[out] computation_amount the computation matrix to be simulated by the parallel task
  * @param[out] communication_amount the communication matrix to be simulated by the parallel task
  * @param[in] nb_res the number of resources the task have to run on
- * @param[in] profile_data the profile data
+ * @param[in] data the profile data
  */
-void generate_parallel_task_homogeneous(
+void generate_parallel_task_homogeneous_matrices(
     std::vector<double> & computation_amount,
     std::vector<double> & communication_amount,
     unsigned int nb_res,
-    void * profile_data)
+    const ParallelHomogeneousProfileData * data)
 {
-    auto * data = static_cast<ParallelHomogeneousProfileData*>(profile_data);
-
     // Determine how much computation/communication must be put into each matrix value.
     double cpu = data->cpu;
     double com = data->com;
@@ -106,45 +105,73 @@ void generate_parallel_task_homogeneous(
 
 /**
  * @brief Generate the communication and computaion matrix for the
- *        parallel homogeneous task profile with a Parallel File System.
- *
- * @param[out] computation_amount the computation matrix to be simulated by the parallel task
- * @param[out] communication_amount the communication matrix to be simulated by the parallel task
- * @param[in,out] hosts_to_use the list of host to be used by the task
- * @param[in] storage_mapping mapping from label given in the profile and machine id
+ *        parallel homogeneous task profile, or get them from the cache.
+ * @param[out] matrices the computation and communication matrices to be simulated by the parallel task
+ * @param[in] nb_res the number of resources the task have to run on
  * @param[in] profile_data the profile data
- * @param[in] context the batsim context
- *
- * @details Note that the number of resource is also altered because of the
- *          pfs node that is addded.
+ * @param[in,out] context the batsim context
  */
-void generate_parallel_task_on_storage_homogeneous(
-    std::vector<double> & computation_amount,
-    std::vector<double> & communication_amount,
-    std::vector<simgrid::s4u::Host*> & hosts_to_use,
-    const std::map<std::string, int> & storage_mapping,
+void generate_parallel_task_homogeneous(
+    PtaskMatricesPtr & matrices,
+    unsigned int nb_res,
     void * profile_data,
-    const BatsimContext * context)
+    BatsimContext * context)
 {
-    auto * data = static_cast<ParallelTaskOnStorageHomogeneousProfileData*>(profile_data);
+    auto * data = static_cast<ParallelHomogeneousProfileData*>(profile_data);
 
-    // Another host must be added to the lists of hosts to use (the storage to use).
-    auto * storage_machine = machine_from_storage_label(data->storage_label, storage_mapping, context);
+    PtaskMatrixKey key{ProfileType::PTASK_HOMOGENEOUS, data->cpu, data->com, static_cast<int>(data->strategy), nb_res};
+    matrices = context->ptask_matrix_cache.get(key, [data, nb_res](PtaskMatrices & generated)
+    {
+        generate_parallel_task_homogeneous_matrices(generated.computation_vector, generated.communication_matrix, nb_res, data);
+    });
+}
 
-    // Determine how much data should be read/written.
-    double bytes_to_read = data->bytes_to_read;
-    double bytes_to_write = data->bytes_to_read;
+/**
+ * @brief Computes how many bytes each allocated host reads from and writes to the storage in a
+ *        parallel homogeneous task profile with a Parallel File System.
+ * @param[in] data the profile data
+ * @param[in] nb_hosts the number of allocated hosts (storage excluded)
+ * @param[out] bytes_to_read the number of bytes each host reads from the storage
+ * @param[out] bytes_to_write the number of bytes each host writes to the storage
+ */
+static void storage_homogeneous_amounts_per_host(
+    const ParallelTaskOnStorageHomogeneousProfileData * data,
+    unsigned int nb_hosts,
+    double & bytes_to_read,
+    double & bytes_to_write)
+{
+    bytes_to_read = data->bytes_to_read;
+    bytes_to_write = data->bytes_to_write;
 
     if (data->strategy == batprotocol::fb::HomogeneousParallelTaskGenerationStrategy_DefinedAmountsSpreadUniformly)
     {
         // User-given values are fair-shared between the hosts already in the list.
-        bytes_to_read = data->bytes_to_read / hosts_to_use.size();
-        bytes_to_write = data->bytes_to_write / hosts_to_use.size();
+        bytes_to_read = data->bytes_to_read / nb_hosts;
+        bytes_to_write = data->bytes_to_write / nb_hosts;
     }
+}
 
-    const int storage_index = hosts_to_use.size(); // The index in hosts_to_use where the storage will be.
-    hosts_to_use.push_back(storage_machine->host);
-    const int nb_executors = hosts_to_use.size();
+/**
+ * @brief Generate the communication and computaion matrix for the
+ *        parallel homogeneous task profile with a Parallel File System.
+ *
+ * @param[out] computation_amount the computation matrix to be simulated by the parallel task
+ * @param[out] communication_amount the communication matrix to be simulated by the parallel task
+ * @param[in] storage_index the number of allocated hosts, which is also the index of the storage host in the list of hosts to use
+ * @param[in] data the profile data
+ */
+void generate_parallel_task_on_storage_homogeneous_matrices(
+    std::vector<double> & computation_amount,
+    std::vector<double> & communication_amount,
+    unsigned int storage_index,
+    const ParallelTaskOnStorageHomogeneousProfileData * data)
+{
+    // Determine how much data should be read/written.
+    double bytes_to_read = 0;
+    double bytes_to_write = 0;
+    storage_homogeneous_amounts_per_host(data, storage_index, bytes_to_read, bytes_to_write);
+
+    const unsigned int nb_executors = storage_index + 1;
 
     // This profile does not do any computation.
     computation_amount.clear();
@@ -166,7 +193,7 @@ void generate_parallel_task_on_storage_homogeneous(
          * r r r r 0
          */
         communication_amount = std::vector<double>(nb_executors*nb_executors, 0.0);
-        for (int host_index = 0; host_index < storage_index; ++host_index)
+        for (unsigned int host_index = 0; host_index < storage_index; ++host_index)
         {
             // The final row contains bytes_to_read, as the storage host will send this data to all other hosts.
             communication_amount[nb_executors*storage_index+host_index] = bytes_to_read;
@@ -177,6 +204,42 @@ void generate_parallel_task_on_storage_homogeneous(
     }
 }
 
+/**
+ * @brief Generate the communication and computaion matrix for the
+ *        parallel homogeneous task profile with a Parallel File System, or get them from the cache.
+ *
+ * @param[out] matrices the computation and communication matrices to be simulated by the parallel task
+ * @param[in,out] hosts_to_use the list of host to be used by the task
+ * @param[in] storage_mapping mapping from label given in the profile and machine id
+ * @param[in] profile_data the profile data
+ * @param[in,out] context the batsim context
+ *
+ * @details Note that the number of resource is also altered because of the
+ *          pfs node that is addded.
+ */
+void generate_parallel_task_on_storage_homogeneous(
+    PtaskMatricesPtr & matrices,
+    std::vector<simgrid::s4u::Host*> & hosts_to_use,
+    const std::map<std::string, int> & storage_mapping,
+    void * profile_data,
+    BatsimContext * context)
+{
+    auto * data = static_cast<ParallelTaskOnStorageHomogeneousProfileData*>(profile_data);
+
+    // Another host must be added to the lists of hosts to use (the storage to use).
+    auto * storage_machine = machine_from_storage_label(data->storage_label, storage_mapping, context);
+
+    const unsigned int storage_index = hosts_to_use.size(); // The index in hosts_to_use where the storage will be.
+    hosts_to_use.push_back(storage_machine->host);
+
+    // The matrices do not depend on which storage is used, as it is always at the end of the host list.
+    PtaskMatrixKey key{ProfileType::PTASK_ON_STORAGE_HOMOGENEOUS, data->bytes_to_read, data->bytes_to_write, static_cast<int>(data->strategy), storage_index};
+    matrices = context->ptask_matrix_cache.get(key, [data, storage_index](PtaskMatrices & generated)
+    {
+        generate_parallel_task_on_storage_homogeneous_matrices(generated.computation_vector, generated.communication_matrix, storage_index, data);
+    });
+}
+
 /**
  * @brief Generate the communication and computaion matrix for the
  *        data staging task profile.
@@ -222,7 +285,7 @@ void generate_parallel_task_data_staging_between_storages(
         /* 0 b
          * 0 0
          */
-        communication_amount = std::vector<double>(nb_executors, 0.0);
+        communication_amount = std::vector<double>(nb_executors*nb_executors, 0.0);
         communication_amount[1] = data->nb_bytes;
     }
 }
@@ -267,33 +330,86 @@ void debug_print_ptask(const std::vector<double>& computation_vector,
 }
 
 /**
- * @brief Execute a task that corresponds to a parallel task profile
+ * @brief Counts a running parallel task in BatsimContext::nb_running_activities while it exists
+ * @details The count is decremented even if the executing actor is killed.
+ */
+struct RunningActivity
+{
+    /**
+     * @brief Counts a new running activity and notifies the platform change
+     * @param[in,out] context The BatsimContext
+     */
+    explicit RunningActivity(BatsimContext * context) : context(context)
+    {
+        ++context->nb_running_activities;
+        context->notify_platform_change();
+    }
+
+    /**
+     * @brief Uncounts the activity and notifies the platform change
+     */
+    void finish()
+    {
+        if (!finished)
+        {
+            finished = true;
+            --context->nb_running_activities;
+            context->notify_platform_change();
+        }
+    }
+
+    /**
+     * @brief Uncounts the activity if it has not finished normally
+     */
+    ~RunningActivity()
+    {
+        if (!finished)
+        {
+            --context->nb_running_activities;
+        }
+    }
+
+    BatsimContext * context; //!< The BatsimContext
+    bool finished = false; //!< Whether the activity has already been uncounted
+};
+
+/**
+ * @brief Runs the SimGrid parallel task of a task whose hosts and matrices are known
  * @param[in,out] btask The task to execute. Progress information is stored within it.
- * @param[in] alloc_placement Where the task should be executed
+ * @param[in] hosts_to_use The hosts of the executors of the parallel task
+ * @param[in] matrices The computation vector and communication matrix of the parallel task
  * @param[in,out] remaining_time The remaining time of the current task. It will be automatically killed if 0 is reached.
- * @param[in] context The BatsimContext
+ * @param[in,out] context The BatsimContext
  * @return The profile return code on success, -1 on timeout (remaining time reached 0), -2 on task cancelled (issued by another SimGrid actor)
  */
-int execute_parallel_task(
+static int run_parallel_task(
     BatTask * btask,
-    const std::shared_ptr<AllocationPlacement> & alloc_placement,
+    const std::vector<simgrid::s4u::Host*> & hosts_to_use,
+    const PtaskMatricesPtr & matrices,
     double * remaining_time,
     BatsimContext * context)
 {
     auto profile = btask->profile;
 
-    std::vector<simgrid::s4u::Host*> hosts_to_use;
-    std::vector<Machine *> machines_to_use;
-    std::vector<double> computation_vector;
-    std::vector<double> communication_matrix;
-    prepare_ptask(context, btask, alloc_placement, computation_vector, communication_matrix, hosts_to_use, machines_to_use);
-
     // Create the parallel task
     string task_name = profile_type_to_string(profile->type) + '_' + static_cast<JobPtr>(btask->parent_job)->id.to_string() +
                        "_" + btask->profile->name;
     XBT_DEBUG("Creating parallel task '%s' on %zu resources", task_name.c_str(), hosts_to_use.size());
 
-    simgrid::s4u::ExecPtr ptask = simgrid::s4u::this_actor::exec_init(hosts_to_use, computation_vector, communication_matrix);
+    // A parallel task progresses at the same rate on all its resources: the remaining part of a task is the task with scaled amounts
+    PtaskMatricesPtr amounts = matrices;
+    if (btask->remaining_work_ratio < 1)
+    {
+        auto scaled = std::make_shared<PtaskMatrices>(*matrices);
+        for (double & amount : scaled->computation_vector)
+            amount *= btask->remaining_work_ratio;
+        for (double & amount : scaled->communication_matrix)
+            amount *= btask->remaining_work_ratio;
+        amounts = scaled;
+    }
+
+    // The (possibly cached) matrices are only given by reference: the copy that SimGrid keeps in the execution is the only one
+    simgrid::s4u::ExecPtr ptask = simgrid::s4u::this_actor::exec_init(hosts_to_use, amounts->computation_vector, amounts->communication_matrix);
     ptask->set_name(task_name.c_str());
 
     // Keep track of the task to get information on kill
@@ -302,6 +418,7 @@ int execute_parallel_task(
     // Execute the parallel task
     int ret = profile->return_code;
     double time_start = simgrid::s4u::Engine::get_clock();
+    RunningActivity running_activity(context);
     if (*remaining_time < 0)
     {
         XBT_DEBUG("Executing task '%s' without walltime", task_name.c_str());
@@ -339,28 +456,145 @@ int execute_parallel_task(
         *remaining_time = *remaining_time - (simgrid::s4u::Engine::get_clock() - time_before_execute);
     }
 
+    running_activity.finish();
     XBT_DEBUG("Task '%s' finished in %f", task_name.c_str(),
         simgrid::s4u::Engine::get_clock() - time_start);
 
     return ret;
 }
 
+/**
+ * @brief Execute a task that corresponds to a parallel task profile
+ * @param[in,out] btask The task to execute. Progress information is stored within it.
+ * @param[in] alloc_placement Where the task should be executed
+ * @param[in,out] remaining_time The remaining time of the current task. It will be automatically killed if 0 is reached.
+ * @param[in] context The BatsimContext
+ * @return The profile return code on success, -1 on timeout (remaining time reached 0), -2 on task cancelled (issued by another SimGrid actor)
+ */
+int execute_parallel_task(
+    BatTask * btask,
+    const std::shared_ptr<AllocationPlacement> & alloc_placement,
+    double * remaining_time,
+    BatsimContext * context)
+{
+    std::vector<simgrid::s4u::Host*> hosts_to_use;
+    std::vector<Machine *> machines_to_use;
+    PtaskMatricesPtr matrices;
+    prepare_ptask(context, btask, alloc_placement, matrices, hosts_to_use, machines_to_use);
+
+    return run_parallel_task(btask, hosts_to_use, matrices, remaining_time, context);
+}
+
+/**
+ * @brief Execute a task that corresponds to a parallel task merge composition profile
+ * @details The parallel tasks of the sub-profiles are merged into a single SimGrid parallel task,
+ *          so that their computations and communications share the resources as one activity.
+ *          The k-th executor a sub-profile places on a host is merged with the k-th executor
+ *          the other sub-profiles place on the same host.
+ * @param[in,out] btask The task to execute. Progress information is stored within it.
+ * @param[in] execute_job_msg The message that started the job, which may override the allocation of the sub-profiles
+ * @param[in] alloc_placement Where the task should be executed
+ * @param[in,out] remaining_time The remaining time of the current task. It will be automatically killed if 0 is reached.
+ * @param[in] context The BatsimContext
+ * @return The profile return code on success, -1 on timeout (remaining time reached 0), -2 on task cancelled (issued by another SimGrid actor)
+ */
+int execute_parallel_task_merge(
+    BatTask * btask,
+    const std::shared_ptr<ExecuteJobMessage> & execute_job_msg,
+    const std::shared_ptr<AllocationPlacement> & alloc_placement,
+    double * remaining_time,
+    BatsimContext * context)
+{
+    auto job = JobPtr(btask->parent_job);
+    auto * data = static_cast<ParallelTaskMergeCompositionProfileData *>(btask->profile->data);
+
+    // Executors of the merged task, and where each executor of each sub-task is merged
+    std::vector<simgrid::s4u::Host*> merged_hosts;
+    std::unordered_map<simgrid::s4u::Host*, std::vector<unsigned int> > merged_executors_on_host;
+    std::vector<std::vector<unsigned int> > sub_executor_to_merged(data->profiles.size());
+    std::vector<PtaskMatricesPtr> sub_matrices(data->profiles.size());
+
+    for (unsigned int sub_i = 0; sub_i < data->profiles.size(); ++sub_i)
+    {
+        const auto & sub_profile = data->profiles[sub_i];
+        std::shared_ptr<AllocationPlacement> sub_alloc_placement = alloc_placement;
+        auto alloc_placement_it = execute_job_msg->profile_allocation_override.find(sub_profile->name);
+        if (alloc_placement_it != execute_job_msg->profile_allocation_override.end())
+        {
+            sub_alloc_placement = alloc_placement_it->second;
+        }
+
+        BatTask sub_btask(job, sub_profile);
+        std::vector<simgrid::s4u::Host*> hosts_to_use;
+        std::vector<Machine *> machines_to_use;
+        prepare_ptask(context, &sub_btask, sub_alloc_placement, sub_matrices[sub_i], hosts_to_use, machines_to_use);
+
+        std::unordered_map<simgrid::s4u::Host*, unsigned int> nb_executors_on_host;
+        sub_executor_to_merged[sub_i].reserve(hosts_to_use.size());
+        for (auto * host : hosts_to_use)
+        {
+            const unsigned int rank_on_host = nb_executors_on_host[host]++;
+            auto & executors_on_host = merged_executors_on_host[host];
+            if (rank_on_host == executors_on_host.size())
+            {
+                executors_on_host.push_back(static_cast<unsigned int>(merged_hosts.size()));
+                merged_hosts.push_back(host);
+            }
+            sub_executor_to_merged[sub_i].push_back(executors_on_host[rank_on_host]);
+        }
+    }
+
+    // Sum the amounts of the sub-tasks into the merged matrices
+    const size_t nb_merged = merged_hosts.size();
+    auto merged = std::make_shared<PtaskMatrices>();
+    for (unsigned int sub_i = 0; sub_i < sub_matrices.size(); ++sub_i)
+    {
+        const auto & matrices = *sub_matrices[sub_i];
+        const auto & to_merged = sub_executor_to_merged[sub_i];
+        const size_t nb_sub = to_merged.size();
+
+        if (!matrices.computation_vector.empty())
+        {
+            merged->computation_vector.resize(nb_merged, 0);
+            for (size_t i = 0; i < nb_sub; ++i)
+            {
+                merged->computation_vector[to_merged[i]] += matrices.computation_vector[i];
+            }
+        }
+
+        if (!matrices.communication_matrix.empty())
+        {
+            merged->communication_matrix.resize(nb_merged * nb_merged, 0);
+            for (size_t i = 0; i < nb_sub; ++i)
+            {
+                for (size_t j = 0; j < nb_sub; ++j)
+                {
+                    merged->communication_matrix[to_merged[i] * nb_merged + to_merged[j]] += matrices.communication_matrix[i * nb_sub + j];
+                }
+            }
+        }
+    }
+
+    XBT_DEBUG("Merged %zu parallel tasks of job '%s' into one parallel task on %zu executors",
+              data->profiles.size(), job->id.to_cstring(), nb_merged);
+
+    return run_parallel_task(btask, merged_hosts, merged, remaining_time, context);
+}
+
 /**
  * @brief Prepare all data required to execute a ptask, in particular computation/communication matrices and hosts to use
  * @param[in] context The BatsimContext
  * @param[in] btask The task to execute
  * @param[in] alloc_placement The allocation/placement to use for the ptask
- * @param[out] computation_vector The computation vector of the ptask
- * @param[out] communication_matrix The communication matrix of the ptask
+ * @param[out] matrices The computation vector and communication matrix of the ptask
  * @param[out] hosts_to_use The hosts that will be used to execute the ptask
  * @param[out] machines_to_use The hosts that will be used to execute the ptask
  */
 void prepare_ptask(
-    const BatsimContext * context,
+    BatsimContext * context,
     const BatTask * btask,
     const std::shared_ptr<AllocationPlacement> & alloc_placement,
-    std::vector<double> & computation_vector,
-    std::vector<double> & communication_matrix,
+    PtaskMatricesPtr & matrices,
     std::vector<simgrid::s4u::Host *> & hosts_to_use,
     std::vector<Machine *> & machines_to_use)
 {
@@ -370,36 +604,39 @@ void prepare_ptask(
     switch(btask->profile->type)
     {
     case ProfileType::PTASK: {
+        auto generated = std::make_shared<PtaskMatrices>();
         generate_parallel_task(
-            computation_vector,
-            communication_matrix,
+            generated->computation_vector,
+            generated->communication_matrix,
             nb_executors,
             btask->profile->data);
+        matrices = generated;
     } break;
     case ProfileType::PTASK_HOMOGENEOUS: {
         generate_parallel_task_homogeneous(
-            computation_vector,
-            communication_matrix,
+            matrices,
             nb_executors,
-            btask->profile->data);
+            btask->profile->data,
+            context);
     } break;
     case ProfileType::PTASK_ON_STORAGE_HOMOGENEOUS: {
         generate_parallel_task_on_storage_homogeneous(
-            computation_vector,
-            communication_matrix,
+            matrices,
             hosts_to_use,
             static_cast<JobPtr>(btask->parent_job)->execution_request->storage_mapping,
             btask->profile->data,
             context);
     } break;
     case ProfileType::PTASK_DATA_STAGING_BETWEEN_STORAGES: {
+        auto generated = std::make_shared<PtaskMatrices>();
         generate_parallel_task_data_staging_between_storages(
-            computation_vector,
-            communication_matrix,
+            generated->computation_vector,
+            generated->communication_matrix,
             hosts_to_use,
             static_cast<JobPtr>(btask->parent_job)->execution_request->storage_mapping,
             btask->profile->data,
             context);
+        matrices = generated;
     } break;
     default: {
         xbt_die("Should not be reached.");
@@ -609,13 +846,13 @@ const Machine * machine_from_storage_label(
     return storage_machine;
 }
 
-void smpi_trace_replay_actor(JobPtr job, TraceReplayProfileData * profile_data, simgrid::s4u::SemaphorePtr sem_termination, std::list<unsigned int> * list_termination, int rank)
+void smpi_trace_replay_actor(JobPtr job, std::string instance_id, TraceReplayProfileData * profile_data, simgrid::s4u::SemaphorePtr sem_termination, std::list<unsigned int> * list_termination, int rank)
 {
     try
     {
         // Prepare data for smpi_replay_run
         char * str_instance_id = nullptr;
-        int ret = asprintf(&str_instance_id, "%s", job->id.to_cstring());
+        int ret = asprintf(&str_instance_id, "%s", instance_id.c_str());
         (void) ret; // Avoids a warning if assertions are ignored
         xbt_assert(ret != -1, "asprintf failed (not enough memory?)");
 
@@ -634,33 +871,7 @@ void smpi_trace_replay_actor(JobPtr job, TraceReplayProfileData * profile_data,
 }
 
 /**
- * @brief Replays a usage over time trace action (one line)
- * @param[in] action The action to replay
- */
-void usage_trace_replayer(simgrid::xbt::ReplayAction & action)
-{
-    double usage = std::stod(action[2]);
-    double flops = std::stod(action[3]);
-    xbt_assert(isfinite(usage) && usage >= 0.0 && usage <= 1.0, "invalid usage read: %g not in [0,1]", usage);
-    xbt_assert(isfinite(flops) && flops >= 0.0, "invalid flops read: %g not positive and finite", flops);
-
-    // compute how many cores should be used depending on usage and on which host is used
-    const double nb_cores = simgrid::s4u::this_actor::get_host()->get_core_count();
-    const int nb_cores_to_use = std::max(round(usage * nb_cores), 1.0); // use at least 1 core, otherwise using flops is impossible
-
-    // generate ptask
-    std::vector<simgrid::s4u::Host*> hosts_to_use(nb_cores_to_use, simgrid::s4u::this_actor::get_host());
-    std::vector<double> computation_vector(nb_cores_to_use, flops);
-    std::vector<double> communication_matrix;
-
-    // execute ptask
-    simgrid::s4u::ExecPtr ptask = simgrid::s4u::this_actor::exec_init(hosts_to_use, computation_vector, communication_matrix);
-    ptask->start();
-    ptask->wait();
-}
-
-/**
- * @brief The actor that replays a usage trace
+ * @brief The actor that replays a (pre-parsed) usage trace
  * @param[in] job The job whose trace is from
  * @param[in] data The profile data of the job
  * @param[in] rank The rank of the actor of the job
@@ -669,14 +880,24 @@ void usage_trace_replay_actor(JobPtr job, TraceReplayProfileData * data, simgrid
 {
     try
     {
-        // Prepare data for replay_runner
-        char * str_rank = nullptr;
-        int ret = asprintf(&str_rank, "%d", rank);
-        (void) ret; // Avoids a warning if assertions are ignored
-        xbt_assert(ret != -1, "asprintf failed (not enough memory?)");
+        const UsageTrace & trace = *data->usage_traces[static_cast<size_t>(rank)];
+        const double nb_cores = simgrid::s4u::this_actor::get_host()->get_core_count();
 
         XBT_INFO("Replaying rank %d of job %s (usage trace)", rank, job->id.to_cstring());
-        simgrid::xbt::replay_runner(str_rank, data->trace_filenames[static_cast<size_t>(rank)].c_str());
+        for (size_t phase = 0; phase < trace.usages.size(); ++phase)
+        {
+            // compute how many cores should be used depending on usage and on which host is used
+            const int nb_cores_to_use = static_cast<int>(std::max(round(trace.usages[phase] * nb_cores), 1.0)); // use at least 1 core, otherwise using flops is impossible
+
+            // generate and execute a ptask in which each used core computes the flops of the phase
+            std::vector<simgrid::s4u::Host*> hosts_to_use(static_cast<size_t>(nb_cores_to_use), simgrid::s4u::this_actor::get_host());
+            std::vector<double> computation_vector(static_cast<size_t>(nb_cores_to_use), trace.flops[phase]);
+            std::vector<double> communication_matrix;
+
+            simgrid::s4u::ExecPtr ptask = simgrid::s4u::this_actor::exec_init(hosts_to_use, computation_vector, communication_matrix);
+            ptask->start();
+            ptask->wait();
+        }
         XBT_INFO("Replaying rank %d of job %s (usage trace) done", rank, job->id.to_cstring());
 
         // Tell parent process that replay has finished for this rank.
@@ -690,6 +911,33 @@ void usage_trace_replay_actor(JobPtr job, TraceReplayProfileData * data, simgrid
 }
 
 
+/**
+ * @brief Counts a running trace replay in BatsimContext::nb_running_trace_replays while it exists
+ * @details The count is decremented even if the replaying actor is killed.
+ */
+struct RunningTraceReplay
+{
+    /**
+     * @brief Counts a new running trace replay
+     * @param[in,out] context The BatsimContext
+     */
+    explicit RunningTraceReplay(BatsimContext * context) : context(context)
+    {
+        ++context->nb_running_trace_replays;
+        context->notify_platform_change();
+    }
+
+    /**
+     * @brief Uncounts the trace replay
+     */
+    ~RunningTraceReplay()
+    {
+        --context->nb_running_trace_replays;
+    }
+
+    BatsimContext * context; //!< The BatsimContext
+};
+
 /**
  * @brief Execute a task that corresponds to a trace replay profile
  * @param[in,out] btask The task to execute. Progress information is stored within it.
@@ -725,6 +973,24 @@ int execute_trace_replay(
     simgrid::s4u::SemaphorePtr sem_termination = simgrid::s4u::Semaphore::create(0);
     std::list<unsigned int> list_termination;
 
+    // The resource sharing of trace replays is not tracked, they prevent sequence fast-forwards while they run
+    RunningTraceReplay running_trace_replay(context);
+
+    // SMPI application instances are registered on demand, SimGrid releases them when all their ranks have finished
+    std::string smpi_instance_id;
+    if (profile->type == ProfileType::REPLAY_SMPI)
+    {
+        xbt_assert(context->smpi_used,
+                   "Cannot execute job='%s': its profile '%s' is an SMPI trace replay, but SMPI has not been initialized "
+                   "as no SMPI trace replay profile was found in the workloads at startup",
+                   job->id.to_cstring(), profile->name.c_str());
+
+        // Several tasks of the same job may replay SMPI traces (compositions), which are told apart by their position in the job
+        smpi_instance_id = job->id.to_string() + btask->position_in_job;
+        XBT_INFO("Registering app. instance='%s', nb_process=%u", smpi_instance_id.c_str(), nb_replay_actors);
+        SMPI_app_instance_register(smpi_instance_id.c_str(), nullptr, static_cast<int>(nb_replay_actors));
+    }
+
     if (profile->type == ProfileType::REPLAY_USAGE)
     {
         std::unordered_set<simgrid::s4u::Host*> unique_hosts;
@@ -745,7 +1011,7 @@ int execute_trace_replay(
         if (profile->type == ProfileType::REPLAY_SMPI)
         {
             auto * data = static_cast<TraceReplayProfileData *>(profile->data);
-            actor = simgrid::s4u::Engine::get_instance()->add_actor(actor_name, host_to_use, smpi_trace_replay_actor, job, data, sem_termination, &list_termination, rank);
+            actor = simgrid::s4u::Engine::get_instance()->add_actor(actor_name, host_to_use, smpi_trace_replay_actor, job, smpi_instance_id, data, sem_termination, &list_termination, rank);
         }
         else if (profile->type == ProfileType::REPLAY_USAGE)
         {
@@ -1,12 +1,9 @@
 #pragma once
 
-#include <xbt/replay.hpp>
-
 #include "context.hpp"
 #include "ipp.hpp"
 #include "jobs.hpp"
-
-void usage_trace_replayer(simgrid::xbt::ReplayAction & action);
+#include "ptask_matrix_cache.hpp"
 
 int execute_parallel_task(
     BatTask * btask,
@@ -15,6 +12,14 @@ int execute_parallel_task(
     BatsimContext * context
 );
 
+int execute_parallel_task_merge(
+    BatTask * btask,
+    const std::shared_ptr<ExecuteJobMessage> & execute_job_msg,
+    const std::shared_ptr<AllocationPlacement> & alloc_placement,
+    double * remaining_time,
+    BatsimContext * context
+);
+
 int execute_trace_replay(
     BatTask * btask,
     const std::shared_ptr<AllocationPlacement> & allocation,
@@ -22,12 +27,25 @@ int execute_trace_replay(
     BatsimContext * context
 );
 
+void generate_parallel_task_homogeneous_matrices(
+    std::vector<double> & computation_amount,
+    std::vector<double> & communication_amount,
+    unsigned int nb_res,
+    const ParallelHomogeneousProfileData * data
+);
+
+void generate_parallel_task_homogeneous(
+    PtaskMatricesPtr & matrices,
+    unsigned int nb_res,
+    void * profile_data,
+    BatsimContext * context
+);
+
 void prepare_ptask(
-    const BatsimContext * context,
+    BatsimContext * context,
     const BatTask * btask,
     const std::shared_ptr<AllocationPlacement> & alloc_placement,
-    std::vector<double> & computation_vector,
-    std::vector<double> & communication_matrix,
+    PtaskMatricesPtr & matrices,
     std::vector<simgrid::s4u::Host *> & hosts_to_use,
     std::vector<Machine *> & machines_to_use
 );
@@ -2,6 +2,10 @@
 
 #include <stdio.h>
 
+#include <fstream>
+#include <sstream>
+#include <string>
+
 #include <intervalset.hpp>
 
 #include "../export.hpp"
@@ -37,6 +41,39 @@ TEST(buffered_outputting, write_buffer)
     EXPECT_EQ(remove_ret, 0) << "Could not remove file " << filename;
 }
 
+TEST(buffered_outputting, write_buffer_background_writer)
+{
+    const char * filename = "/tmp/test_wbuf_background";
+    WriteBufferOptions options;
+    options.buffer_size = 16;
+    options.nb_buffers = 3;
+
+    WriteBuffer * buf = new WriteBuffer(filename, options);
+    std::string expected_content;
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::string line = std::to_string(i) + (i % 10 == 0 ? ",bigger than the buffer size\n" : "\n");
+        expected_content += line;
+        buf->append_text(line.c_str());
+
+        if (i % 100 == 0)
+        {
+            buf->flush_buffer();
+        }
+    }
+
+    // Wait for the writer thread, close file and release memory
+    delete buf;
+
+    std::ifstream f(filename);
+    std::stringstream content;
+    content << f.rdbuf();
+    EXPECT_EQ(content.str(), expected_content);
+
+    // Remove temporary file
+    int remove_ret = remove(filename);
+    EXPECT_EQ(remove_ret, 0) << "Could not remove file " << filename;
+}
 
 TEST(buffered_outputting, pstate_writer)
 {
@@ -71,3 +108,11 @@ TEST(buffered_outputting, pstate_writer)
     int remove_ret = remove(filename);
     EXPECT_EQ(remove_ret, 0) << "Could not remove file " << filename;
 }
+
+TEST(buffered_outputting, json_escape)
+{
+    EXPECT_EQ(json_escape("w0"), "w0");
+    EXPECT_EQ(json_escape("a\"b"), "a\\\"b");
+    EXPECT_EQ(json_escape("a\\b"), "a\\\\b");
+    EXPECT_EQ(json_escape("a\nb\tc"), "a b c");
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "../probe_aggregation.hpp"
+
+TEST(probe_aggregation, sum_and_mean)
+{
+    EXPECT_EQ(probe_sum(nullptr, 0), 0);
+    EXPECT_EQ(probe_mean(nullptr, 0), 0);
+
+    // Sizes that are not multiples of the number of partial sums
+    for (size_t nb_values : {1, 3, 4, 7, 1000})
+    {
+        std::vector<double> values(nb_values);
+        std::iota(values.begin(), values.end(), 1.0);
+        const double expected_sum = static_cast<double>(nb_values * (nb_values + 1) / 2);
+        EXPECT_DOUBLE_EQ(probe_sum(values.data(), nb_values), expected_sum);
+        EXPECT_DOUBLE_EQ(probe_mean(values.data(), nb_values), expected_sum / nb_values);
+    }
+}
+
+TEST(probe_aggregation, quantile_interpolates)
+{
+    std::vector<double> values = {40, 10, 30, 20};
+    EXPECT_DOUBLE_EQ(probe_quantile(values.data(), values.size(), 0), 10);
+    EXPECT_DOUBLE_EQ(probe_quantile(values.data(), values.size(), 1), 40);
+    EXPECT_DOUBLE_EQ(probe_quantile(values.data(), values.size(), 0.5), 25);
+    EXPECT_DOUBLE_EQ(probe_quantile(values.data(), values.size(), 1.0 / 3), 20);
+
+    std::vector<double> single = {7};
+    EXPECT_DOUBLE_EQ(probe_quantile(single.data(), 1, 0.9), 7);
+    EXPECT_EQ(probe_quantile(nullptr, 0, 0.5), 0);
+}
+
+TEST(probe_aggregation, quantile_matches_sort)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> distribution(0, 1000);
+    std::vector<double> values(1001);
+    for (double & value : values)
+    {
+        value = distribution(rng);
+    }
+
+    std::vector<double> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    for (double threshold : {0.0, 0.1, 0.5, 0.99, 1.0})
+    {
+        std::vector<double> scratch = values;
+        EXPECT_DOUBLE_EQ(probe_quantile(scratch.data(), scratch.size(), threshold), sorted[static_cast<size_t>(threshold * 1000)]);
+    }
+}
@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../jobs.hpp"
+#include "../profiles.hpp"
+#include "../workload.hpp"
+
+class profiles : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        workload = Workload::new_dynamic_workload("w");
+    }
+
+    void TearDown() override
+    {
+        delete workload;
+    }
+
+    // Parses a ParallelTask profile and expands its communication matrix
+    std::vector<double> communication_matrix(const std::string & json_desc)
+    {
+        auto profile = Profile::from_json("w!ptask", json_desc, workload);
+        EXPECT_EQ(profile->type, ProfileType::PTASK);
+        auto * data = static_cast<ParallelProfileData *>(profile->data);
+
+        std::vector<double> matrix;
+        data->fill_communication_matrix(matrix);
+        EXPECT_EQ(matrix.size(), static_cast<size_t>(data->nb_res) * data->nb_res);
+        return matrix;
+    }
+
+    // Parses a profile and adds it to the workload, which interns its data
+    ProfilePtr add_profile(const std::string & name, const std::string & json_desc)
+    {
+        auto profile = Profile::from_json("w!" + name, json_desc, workload);
+        workload->profiles->add_profile(profile->name, profile);
+        return profile;
+    }
+
+    // Parses a job and adds it to the workload
+    JobIdentifier add_job(const std::string & name, const std::string & profile_name)
+    {
+        auto job = Job::from_json(R"({"id": ")" + name + R"(", "subtime": 0, "walltime": 10, "res": 1, "profile": ")" + profile_name + R"("})", workload);
+        workload->jobs->add_job(job);
+        return job->id;
+    }
+
+    Workload * workload = nullptr;
+};
+
+TEST_F(profiles, com_coo)
+{
+    auto matrix = communication_matrix(R"({"type": "ParallelTaskProfile", "com": {"format": "coo", "nb_res": 3,
+        "rows": [2, 0, 2, 1], "cols": [0, 1, 0, 1], "values": [5, 1, 2, 0]}})");
+    std::vector<double> expected = {
+        0, 1, 0,
+        0, 0, 0,
+        7, 0, 0,
+    };
+    EXPECT_EQ(matrix, expected);
+}
+
+TEST_F(profiles, com_csr)
+{
+    // Row 2 gives its transfers in any order, and twice to host 0
+    auto matrix = communication_matrix(R"({"type": "ParallelTaskProfile", "cpu": [1, 1, 1], "com": {"format": "csr",
+        "row_offsets": [0, 1, 1, 4], "cols": [2, 1, 0, 0], "values": [3, 4, 5, 6]}})");
+    std::vector<double> expected = {
+        0, 0, 3,
+        0, 0, 0,
+        11, 4, 0,
+    };
+    EXPECT_EQ(matrix, expected);
+}
+
+TEST_F(profiles, com_ring)
+{
+    auto matrix = communication_matrix(R"({"type": "ParallelTaskProfile", "cpu": [1, 1, 1],
+        "com": {"format": "ring", "bytes": 2}})");
+    std::vector<double> expected = {
+        0, 2, 0,
+        0, 0, 2,
+        2, 0, 0,
+    };
+    EXPECT_EQ(matrix, expected);
+
+    matrix = communication_matrix(R"({"type": "ParallelTaskProfile", "cpu": [1, 1, 1],
+        "com": {"format": "ring", "bytes": 2, "bidirectional": true}})");
+    expected = {
+        0, 2, 2,
+        2, 0, 2,
+        2, 2, 0,
+    };
+    EXPECT_EQ(matrix, expected);
+
+    // With 2 executors, the predecessor is also the successor
+    matrix = communication_matrix(R"({"type": "ParallelTaskProfile", "cpu": [1, 1],
+        "com": {"format": "ring", "bytes": 2, "bidirectional": true}})");
+    expected = {
+        0, 2,
+        2, 0,
+    };
+    EXPECT_EQ(matrix, expected);
+}
+
+TEST_F(profiles, com_stencil)
+{
+    // 2x3 grid: executor 3*row + column
+    auto matrix = communication_matrix(R"({"type": "ParallelTaskProfile",
+        "com": {"format": "stencil", "bytes": 1, "dims": [2, 3]}})");
+    std::vector<double> expected = {
+        0, 1, 0, 1, 0, 0,
+        1, 0, 1, 0, 1, 0,
+        0, 1, 0, 0, 0, 1,
+        1, 0, 0, 0, 1, 0,
+        0, 1, 0, 1, 0, 1,
+        0, 0, 1, 0, 1, 0,
+    };
+    EXPECT_EQ(matrix, expected);
+
+    // Only the dimension of size 3 wraps around: with 2 elements, the wrapped-around neighbour is the other one
+    matrix = communication_matrix(R"({"type": "ParallelTaskProfile",
+        "com": {"format": "stencil", "bytes": 1, "dims": [2, 3], "periodic": true}})");
+    expected = {
+        0, 1, 1, 1, 0, 0,
+        1, 0, 1, 0, 1, 0,
+        1, 1, 0, 0, 0, 1,
+        1, 0, 0, 0, 1, 1,
+        0, 1, 0, 1, 0, 1,
+        0, 0, 1, 1, 1, 0,
+    };
+    EXPECT_EQ(matrix, expected);
+}
+
+TEST_F(profiles, com_all_to_one)
+{
+    auto matrix = communication_matrix(R"({"type": "ParallelTaskProfile", "cpu": [1, 1, 1],
+        "com": {"format": "all_to_one", "bytes": 4, "root": 1}})");
+    std::vector<double> expected = {
+        0, 4, 0,
+        0, 0, 0,
+        0, 4, 0,
+    };
+    EXPECT_EQ(matrix, expected);
+}
+
+TEST_F(profiles, com_block_diagonal)
+{
+    // The last block is smaller
+    auto matrix = communication_matrix(R"({"type": "ParallelTaskProfile", "cpu": [1, 1, 1, 1, 1],
+        "com": {"format": "block_diagonal", "bytes": 3, "block_size": 2}})");
+    std::vector<double> expected = {
+        0, 3, 0, 0, 0,
+        3, 0, 0, 0, 0,
+        0, 0, 0, 3, 0,
+        0, 0, 3, 0, 0,
+        0, 0, 0, 0, 0,
+    };
+    EXPECT_EQ(matrix, expected);
+}
+
+TEST_F(profiles, com_dense_compressed)
+{
+    // Mostly-zero dense matrices are stored in the sparse format when they are parsed, but are expanded back to the same matrix
+    std::vector<double> expected(25, 0);
+    expected[1 * 5 + 3] = 8;
+    expected[4 * 5 + 0] = 9;
+
+    auto profile = Profile::from_json("w!ptask", R"({"type": "ParallelTaskProfile", "cpu": [1, 1, 1, 1, 1],
+        "com": [0, 0, 0, 0, 0,  0, 0, 0, 8, 0,  0, 0, 0, 0, 0,  0, 0, 0, 0, 0,  9, 0, 0, 0, 0]})", workload);
+    auto * data = static_cast<ParallelProfileData *>(profile->data);
+    EXPECT_EQ(data->com_format, CommunicationMatrixFormat::SPARSE);
+
+    std::vector<double> matrix;
+    data->fill_communication_matrix(matrix);
+    EXPECT_EQ(matrix, expected);
+}
+
+TEST_F(profiles, interning_equal_profiles)
+{
+    const auto nb_deduplicated = deduplicated_profiles_count();
+
+    auto delay1 = add_profile("delay1", R"({"type": "DelayProfile", "delay": 12})");
+    auto delay2 = add_profile("delay2", R"({"type": "DelayProfile", "delay": 12})");
+    EXPECT_EQ(delay1->data, delay2->data);
+    EXPECT_EQ(delay1->shared_data, delay2->shared_data);
+
+    // The dense matrix is mostly zero, hence stored in the sparse format like the coo one
+    auto dense = add_profile("dense", R"({"type": "ParallelTaskProfile", "cpu": [1, 2, 3],
+        "com": [0, 0, 0,  0, 0, 4,  0, 0, 0]})");
+    auto coo = add_profile("coo", R"({"type": "ParallelTaskProfile", "cpu": [1, 2, 3],
+        "com": {"format": "coo", "nb_res": 3, "rows": [1], "cols": [2], "values": [4]}})");
+    EXPECT_EQ(dense->data, coo->data);
+
+    auto ring1 = add_profile("ring1", R"({"type": "ParallelTaskProfile", "cpu": [1, 1], "com": {"format": "ring", "bytes": 2}})");
+    auto ring2 = add_profile("ring2", R"({"type": "ParallelTaskProfile", "cpu": [1, 1], "com": {"format": "ring", "bytes": 2}})");
+    EXPECT_EQ(ring1->data, ring2->data);
+
+    // Profile names are kept
+    EXPECT_EQ(delay2->name, "w!delay2");
+    EXPECT_EQ(deduplicated_profiles_count(), nb_deduplicated + 3);
+}
+
+TEST_F(profiles, interning_different_profiles)
+{
+    const auto nb_deduplicated = deduplicated_profiles_count();
+
+    // The same amounts under different types
+    auto delay = add_profile("delay", R"({"type": "DelayProfile", "delay": 5})");
+    auto homogeneous = add_profile("homogeneous", R"({"type": "ParallelTaskHomogeneousProfile", "cpu": 5, "com": 0})");
+    EXPECT_NE(delay->data, homogeneous->data);
+
+    // The same matrix with a different computation vector
+    auto ptask1 = add_profile("ptask1", R"({"type": "ParallelTaskProfile", "cpu": [1, 1], "com": [1, 2, 3, 4]})");
+    auto ptask2 = add_profile("ptask2", R"({"type": "ParallelTaskProfile", "cpu": [1, 2], "com": [1, 2, 3, 4]})");
+    EXPECT_NE(ptask1->data, ptask2->data);
+
+    // The same matrix under a different format: compact formats are only compared on their parameters
+    auto dense = add_profile("dense", R"({"type": "ParallelTaskProfile", "cpu": [1, 1], "com": [0, 2, 2, 0]})");
+    auto ring = add_profile("ring", R"({"type": "ParallelTaskProfile", "cpu": [1, 1], "com": {"format": "ring", "bytes": 2}})");
+    EXPECT_NE(dense->data, ring->data);
+
+    EXPECT_EQ(deduplicated_profiles_count(), nb_deduplicated);
+}
+
+TEST_F(profiles, interning_data_lifetime)
+{
+    std::weak_ptr<void> shared_data;
+    {
+        auto profile1 = add_profile("p1", R"({"type": "DelayProfile", "delay": 42})");
+        auto profile2 = add_profile("p2", R"({"type": "DelayProfile", "delay": 42})");
+        ASSERT_EQ(profile1->shared_data, profile2->shared_data);
+        shared_data = profile1->shared_data;
+    }
+
+    auto job1 = add_job("j1", "p1");
+    auto job2 = add_job("j2", "p2");
+    auto job3 = add_job("j3", "p1");
+    EXPECT_EQ(workload->profiles->at("w!p1")->nb_referencing_jobs, 2u);
+
+    // p1 is still used by j3
+    workload->jobs->delete_job(job1, true);
+    EXPECT_TRUE(workload->profiles->is_alive("w!p1"));
+    EXPECT_FALSE(shared_data.expired());
+
+    // p2 is removed, but p1 still owns the data
+    workload->jobs->delete_job(job2, true);
+    EXPECT_FALSE(workload->profiles->is_alive("w!p2"));
+    EXPECT_FALSE(shared_data.expired());
+
+    // The last referencing job is gone
+    workload->jobs->delete_job(job3, true);
+    EXPECT_FALSE(workload->profiles->is_alive("w!p1"));
+    EXPECT_TRUE(shared_data.expired());
+}
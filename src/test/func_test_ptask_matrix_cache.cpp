@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "../ptask_matrix_cache.hpp"
+
+static PtaskMatrixKey make_key(unsigned int nb_executors, double com = 1e6)
+{
+    return PtaskMatrixKey{ProfileType::PTASK_HOMOGENEOUS, 1e9, com, 0, nb_executors};
+}
+
+static void fill(PtaskMatrices & matrices, unsigned int nb_executors)
+{
+    matrices.computation_vector = std::vector<double>(nb_executors, 1e9);
+    matrices.communication_matrix = std::vector<double>(nb_executors * nb_executors, 1e6);
+}
+
+TEST(ptask_matrix_cache, hits_share_matrices)
+{
+    PtaskMatrixCache cache;
+    int nb_generations = 0;
+    auto generator = [&nb_generations](PtaskMatrices & matrices) { ++nb_generations; fill(matrices, 4); };
+
+    auto first = cache.get(make_key(4), generator);
+    auto second = cache.get(make_key(4), generator);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(nb_generations, 1);
+    EXPECT_EQ(cache.nb_hits(), 1u);
+    EXPECT_EQ(cache.nb_misses(), 1u);
+    EXPECT_EQ(first->communication_matrix.size(), 16u);
+
+    auto other = cache.get(make_key(4, 2e6), generator);
+    EXPECT_NE(first, other);
+    EXPECT_EQ(nb_generations, 2);
+    EXPECT_EQ(cache.nb_misses(), 2u);
+}
+
+TEST(ptask_matrix_cache, lru_eviction)
+{
+    // Large enough for two 64-executor entries, not three
+    const size_t entry_size = sizeof(PtaskMatrices) + sizeof(double) * (64 + 64 * 64);
+    PtaskMatrixCache cache(2 * entry_size + entry_size / 2);
+    auto generator = [](PtaskMatrices & matrices) { fill(matrices, 64); };
+
+    auto a = cache.get(make_key(64, 1), generator);
+    cache.get(make_key(64, 2), generator);
+    cache.get(make_key(64, 1), generator); // a is now the most recently used
+    cache.get(make_key(64, 3), generator); // evicts 2
+    EXPECT_EQ(cache.nb_evictions(), 1u);
+    EXPECT_LE(cache.size(), 2 * entry_size + entry_size / 2);
+
+    cache.get(make_key(64, 1), generator);
+    EXPECT_EQ(cache.nb_hits(), 2u);
+    cache.get(make_key(64, 2), generator);
+    EXPECT_EQ(cache.nb_misses(), 4u);
+
+    // Evicted matrices remain valid while they are used
+    EXPECT_EQ(a->computation_vector.size(), 64u);
+}
+
+TEST(ptask_matrix_cache, disabled)
+{
+    PtaskMatrixCache cache(0);
+    auto generator = [](PtaskMatrices & matrices) { fill(matrices, 2); };
+
+    auto first = cache.get(make_key(2), generator);
+    auto second = cache.get(make_key(2), generator);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(cache.nb_misses(), 2u);
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(ptask_matrix_cache, concurrent_gets)
+{
+    // As with job actors on several threads (SimGrid parallel contexts)
+    PtaskMatrixCache cache;
+    const unsigned int nb_threads = 8;
+    const unsigned int nb_gets = 1000;
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < nb_threads; ++t)
+    {
+        threads.emplace_back([&cache]() {
+            for (unsigned int i = 0; i < nb_gets; ++i)
+            {
+                const unsigned int nb_executors = 1 + i % 16;
+                auto matrices = cache.get(make_key(nb_executors), [nb_executors](PtaskMatrices & generated) { fill(generated, nb_executors); });
+                EXPECT_EQ(matrices->computation_vector.size(), nb_executors);
+            }
+        });
+    }
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(cache.nb_hits() + cache.nb_misses(), static_cast<uint64_t>(nb_threads) * nb_gets);
+    EXPECT_GE(cache.nb_misses(), 16u);
+}
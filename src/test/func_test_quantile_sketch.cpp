@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../quantile_sketch.hpp"
+
+static double exact_quantile(std::vector<double> values, double q)
+{
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(q * (values.size() - 1))];
+}
+
+TEST(quantile_sketch, empty)
+{
+    QuantileSketch sketch;
+    EXPECT_EQ(sketch.count(), 0u);
+    EXPECT_EQ(sketch.quantile(0.5), 0);
+    EXPECT_TRUE(sketch.log2_histogram().empty());
+}
+
+TEST(quantile_sketch, relative_accuracy)
+{
+    const double accuracy = 0.01;
+    QuantileSketch sketch(accuracy);
+    std::vector<double> values;
+
+    std::mt19937 gen(42);
+    std::lognormal_distribution<double> distribution(3, 2);
+    for (int i = 0; i < 100000; ++i)
+    {
+        double value = distribution(gen);
+        values.push_back(value);
+        sketch.add(value);
+    }
+
+    EXPECT_EQ(sketch.count(), values.size());
+    EXPECT_EQ(sketch.min(), *std::min_element(values.begin(), values.end()));
+    EXPECT_EQ(sketch.max(), *std::max_element(values.begin(), values.end()));
+
+    for (double q : {0.0, 0.1, 0.5, 0.95, 0.99, 1.0})
+    {
+        double expected = exact_quantile(values, q);
+        EXPECT_NEAR(sketch.quantile(q), expected, expected * accuracy) << "q=" << q;
+    }
+}
+
+TEST(quantile_sketch, zeros_and_merge)
+{
+    QuantileSketch a, b, all;
+    for (int i = 0; i < 1000; ++i)
+    {
+        double value = (i % 4 == 0) ? 0 : i;
+        ((i % 2 == 0) ? a : b).add(value);
+        all.add(value);
+    }
+
+    a.merge(b);
+    EXPECT_EQ(a.count(), all.count());
+    EXPECT_EQ(a.min(), 0);
+    EXPECT_EQ(a.quantile(0), 0);
+    for (double q : {0.1, 0.5, 0.99})
+    {
+        EXPECT_EQ(a.quantile(q), all.quantile(q)) << "q=" << q;
+    }
+
+    uint64_t nb_in_histogram = 0;
+    for (const auto & bin : a.log2_histogram())
+    {
+        nb_in_histogram += bin.second;
+    }
+    EXPECT_EQ(nb_in_histogram, a.count());
+    EXPECT_EQ(a.log2_histogram().front().first, 0);
+    EXPECT_EQ(a.log2_histogram().front().second, 250u);
+}
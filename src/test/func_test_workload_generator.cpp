@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "../workload_generator.hpp"
+
+static std::vector<SwfJob> generate(const GeneratorWorkloadOptions & options, int nb_res)
+{
+    WorkloadGenerator generator(options, nb_res);
+    std::vector<SwfJob> jobs;
+    SwfJob job;
+    while (generator.next_job(job))
+    {
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+TEST(workload_generator, same_seed_same_jobs)
+{
+    GeneratorWorkloadOptions options;
+    options.seed = 3;
+    options.nb_jobs = 500;
+
+    auto jobs = generate(options, 64);
+    auto again = generate(options, 64);
+    ASSERT_EQ(jobs.size(), 500u);
+    ASSERT_EQ(again.size(), jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        EXPECT_EQ(jobs[i].id, again[i].id);
+        EXPECT_EQ(jobs[i].submission_time, again[i].submission_time);
+        EXPECT_EQ(jobs[i].nb_res, again[i].nb_res);
+        EXPECT_EQ(jobs[i].runtime, again[i].runtime);
+    }
+
+    options.seed = 4;
+    auto other = generate(options, 64);
+    bool differ = false;
+    for (size_t i = 0; i < jobs.size() && !differ; ++i)
+    {
+        differ = jobs[i].submission_time != other[i].submission_time || jobs[i].nb_res != other[i].nb_res || jobs[i].runtime != other[i].runtime;
+    }
+    EXPECT_TRUE(differ);
+}
+
+TEST(workload_generator, jobs_are_valid)
+{
+    GeneratorWorkloadOptions options;
+    options.seed = 7;
+    options.nb_jobs = 1000;
+    options.max_runtime = 3600;
+
+    auto jobs = generate(options, 32);
+    ASSERT_EQ(jobs.size(), 1000u);
+    EXPECT_EQ(jobs[0].submission_time, 0);
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        EXPECT_GE(jobs[i].nb_res, 1);
+        EXPECT_LE(jobs[i].nb_res, 32);
+        EXPECT_GE(jobs[i].runtime, 1);
+        EXPECT_LE(jobs[i].runtime, 3600);
+        if (i > 0)
+        {
+            EXPECT_GE(jobs[i].submission_time, jobs[i-1].submission_time);
+        }
+    }
+}
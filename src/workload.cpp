@@ -5,6 +5,7 @@
 
 #include "workload.hpp"
 
+#include <cstdio>
 #include <fstream>
 #include <streambuf>
 
@@ -16,6 +17,7 @@
 #include <smpi/smpi.h>
 
 #include "context.hpp"
+#include "dax.hpp"
 #include "jobs.hpp"
 #include "profiles.hpp"
 #include "jobs_execution.hpp"
@@ -61,7 +63,7 @@ Workload::~Workload()
     profiles = nullptr;
 }
 
-void Workload::load_from_json(const std::string &json_filename, int &nb_machines)
+void Workload::load_from_json(const std::string &json_filename, int &nb_machines, const TimeWindow & time_window)
 {
     XBT_INFO("Loading JSON workload '%s'...", json_filename.c_str());
     // Let the file content be placed in a string
@@ -94,33 +96,63 @@ void Workload::load_from_json(const std::string &json_filename, int &nb_machines
                json_filename.c_str(), nb_machines);
 
     profiles->load_from_json(doc, json_filename);
-    jobs->load_from_json(doc, json_filename);
+    jobs->load_from_json(doc, json_filename, time_window);
 
     XBT_INFO("JSON workload parsed sucessfully. Read %d jobs and %d profiles.",
              jobs->nb_jobs(), profiles->nb_profiles());
 }
 
-void Workload::register_smpi_applications()
+void Workload::load_from_dax(const std::string & dax_filename,
+                             const SwfWorkloadOptions & options,
+                             const TimeWindow & time_window)
 {
-    XBT_INFO("Registering SMPI applications of workload '%s'...", name.c_str());
+    XBT_INFO("Loading DAX workload '%s'...", dax_filename.c_str());
+    vector<DaxTask> tasks = read_dax(dax_filename);
 
-    for (auto & mit : jobs->jobs())
+    // Every job is submitted at time 0: the whole workflow is skipped if the time window starts later
+    if (time_window.skips(0))
     {
-        auto job = mit.second;
+        XBT_INFO("The jobs of file '%s' are outside of the time window and have been skipped.", dax_filename.c_str());
+        return;
+    }
 
-        if (job->profile->type == ProfileType::REPLAY_SMPI)
+    jobs->reserve(tasks.size());
+    for (const DaxTask & task : tasks)
+    {
+        const string profile_name = runtime_profile_name(name, task.runtime, options);
+        if (!profiles->exists(profile_name))
         {
-            auto * data = static_cast<TraceReplayProfileData *>(job->profile->data);
+            ProfilePtr profile = new_runtime_profile(profile_name, task.runtime, options);
+            profiles->add_profile(profile_name, profile);
+        }
 
-            XBT_INFO("Registering app. instance='%s', nb_process=%lu",
-                     job->id.to_cstring(), data->trace_filenames.size());
-            SMPI_app_instance_register(job->id.to_cstring(), nullptr, static_cast<int>(data->trace_filenames.size()));
+        auto job = std::make_shared<Job>();
+        job->workload = this;
+        job->id = JobIdentifier(name, task.id);
+        job->id.check_lexically_valid();
+        job->starting_time = -1;
+        job->runtime = -1;
+        job->state = JobState::JOB_STATE_NOT_SUBMITTED;
+        job->consumed_energy = -1;
+        job->submission_time = 0;
+        job->walltime = static_cast<long double>(options.walltime_factor * task.runtime);
+        job->requested_nb_res = 1;
+        job->profile = profiles->at(profile_name);
+
+        job->dependencies.reserve(task.parents.size());
+        for (const string & parent : task.parents)
+        {
+            job->dependencies.push_back(JobIdentifier(name, parent));
         }
+
+        jobs->add_job(job);
     }
 
-    XBT_INFO("SMPI applications of workload '%s' have been registered.", name.c_str());
-}
+    jobs->check_dependencies(dax_filename, time_window);
 
+    XBT_INFO("DAX workload parsed sucessfully. Read %d jobs and %d profiles.",
+             jobs->nb_jobs(), profiles->nb_profiles());
+}
 
 void Workload::check_single_job_validity(const JobPtr job)
 {
@@ -233,12 +265,12 @@ bool Workloads::exists(const std::string &workload_name) const
     return _workloads.count(workload_name) == 1;
 }
 
-bool Workloads::contains_smpi_job() const
+bool Workloads::contains_smpi_profile() const
 {
     for (auto mit : _workloads)
     {
         Workload * workload = mit.second;
-        if (workload->jobs->contains_smpi_job())
+        if (workload->profiles->contains_smpi_profile())
         {
             return true;
         }
@@ -247,15 +279,6 @@ bool Workloads::contains_smpi_job() const
     return false;
 }
 
-void Workloads::register_smpi_applications()
-{
-    for (auto mit : _workloads)
-    {
-        Workload * workload = mit.second;
-        workload->register_smpi_applications();
-    }
-}
-
 bool Workloads::job_is_registered(const JobIdentifier &job_id)
 {
     return at(job_id.workload_name())->jobs->exists(job_id);
@@ -271,12 +294,10 @@ void Workloads::check_single_profile_validity(const ProfilePtr profile)
 {
     // Check that every composition profile points to existing profiles
     // And update the refcounting of these profiles
-    // TODO: do the same for other composition profiles
-    if (profile->type == ProfileType::SEQUENTIAL_COMPOSITION)
+    auto resolve_sub_profiles = [this, &profile](const std::vector<std::string> & sub_profile_names, std::vector<ProfilePtr> & sub_profiles)
     {
-        auto * data = static_cast<SequenceProfileData *>(profile->data);
-        data->profile_sequence.reserve(data->sequence_names.size());
-        for (const auto & sub_profile_name : data->sequence_names)
+        sub_profiles.reserve(sub_profile_names.size());
+        for (const auto & sub_profile_name : sub_profile_names)
         {
             // Retrieve workload name from sub_profile_name
             vector<string> name_parts;
@@ -288,7 +309,34 @@ void Workloads::check_single_profile_validity(const ProfilePtr profile)
                        "Invalid composed profile '%s': the used profile '%s' does not exist",
                        profile->name.c_str(), sub_profile_name.c_str());
             // Adds one to the refcounting for the profile 'prof'
-            data->profile_sequence.push_back(at(workload_name)->profiles->at(sub_profile_name));
+            sub_profiles.push_back(at(workload_name)->profiles->at(sub_profile_name));
+        }
+    };
+
+    if (profile->type == ProfileType::SEQUENTIAL_COMPOSITION)
+    {
+        auto * data = static_cast<SequenceProfileData *>(profile->data);
+        resolve_sub_profiles(data->sequence_names, data->profile_sequence);
+    }
+    else if (profile->type == ProfileType::FORKJOIN_COMPOSITION)
+    {
+        auto * data = static_cast<ForkJoinCompositionProfileData *>(profile->data);
+        resolve_sub_profiles(data->profile_names, data->profiles);
+    }
+    else if (profile->type == ProfileType::PTASK_MERGE_COMPOSITION)
+    {
+        auto * data = static_cast<ParallelTaskMergeCompositionProfileData *>(profile->data);
+        resolve_sub_profiles(data->profile_names, data->profiles);
+
+        // Only parallel tasks can be merged into a single parallel task
+        for (const auto & sub_profile : data->profiles)
+        {
+            xbt_assert(sub_profile->type == ProfileType::PTASK ||
+                       sub_profile->type == ProfileType::PTASK_HOMOGENEOUS ||
+                       sub_profile->type == ProfileType::PTASK_ON_STORAGE_HOMOGENEOUS ||
+                       sub_profile->type == ProfileType::PTASK_DATA_STAGING_BETWEEN_STORAGES,
+                       "Invalid composed profile '%s': the merged profile '%s' is not a parallel task (type=%s)",
+                       profile->name.c_str(), sub_profile->name.c_str(), profile_type_to_string(sub_profile->type).c_str());
         }
     }
 
@@ -308,7 +356,7 @@ void Workloads::check_validity()
 
         // Let's check that every Composition-typed profile points to existing profiles
         // And update the refcounting of these profiles
-        for (auto mit : wl->profiles->profiles())
+        for (const auto & mit : wl->profiles->profiles())
         {
             check_single_profile_validity(mit.second);
         }
@@ -347,3 +395,38 @@ string Workloads::to_string()
     }
     return str;
 }
+
+std::string runtime_profile_name(const std::string & workload_name,
+                                 double runtime,
+                                 const SwfWorkloadOptions & options)
+{
+    char runtime_str[32];
+    snprintf(runtime_str, sizeof(runtime_str), "%.15g", runtime);
+    const bool is_delay = options.profile_mapping == SwfProfileMapping::DELAY;
+    return workload_name + "!" + (is_delay ? "delay" : "ptask") + runtime_str;
+}
+
+ProfilePtr new_runtime_profile(const std::string & profile_name,
+                               double runtime,
+                               const SwfWorkloadOptions & options)
+{
+    auto profile = std::make_shared<Profile>();
+    profile->name = profile_name;
+    if (options.profile_mapping == SwfProfileMapping::DELAY)
+    {
+        auto * data = new DelayProfileData;
+        data->delay = runtime;
+        profile->type = ProfileType::DELAY;
+        profile->data = data;
+    }
+    else
+    {
+        auto * data = new ParallelHomogeneousProfileData;
+        data->cpu = runtime * options.computation_speed;
+        data->com = 0;
+        profile->type = ProfileType::PTASK_HOMOGENEOUS;
+        profile->data = data;
+    }
+
+    return profile;
+}
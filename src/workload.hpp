@@ -10,6 +10,7 @@
 #include <map>
 #include <memory>
 
+#include "cli.hpp"
 #include "pointers.hpp"
 
 class Jobs;
@@ -63,14 +64,22 @@ public:
      * @brief Loads a static workload from a JSON filename
      * @param[in] json_filename The name of the JSON file
      * @param[out] nb_machines The number of machines described in the JSON file
+     * @param[in] time_window The simulated time window. Jobs outside of it are not loaded.
      */
     void load_from_json(const std::string & json_filename,
-                        int & nb_machines);
+                        int & nb_machines,
+                        const TimeWindow & time_window = TimeWindow());
 
     /**
-     * @brief Registers SMPI applications
+     * @brief Loads a static workload from a DAX (Pegasus workflow) file
+     * @details Each DAX job becomes a single-resource job submitted at time 0, which depends on the jobs of its parents.
+     * @param[in] dax_filename The name of the DAX file
+     * @param[in] options How DAX jobs are mapped to profiles and walltimes
+     * @param[in] time_window The simulated time window. Jobs outside of it are not loaded.
      */
-    void register_smpi_applications();
+    void load_from_dax(const std::string & dax_filename,
+                       const SwfWorkloadOptions & options,
+                       const TimeWindow & time_window = TimeWindow());
 
     /**
      * @brief Checks whether a single job is valid
@@ -235,15 +244,10 @@ public:
     bool exists(const std::string & workload_name) const;
 
     /**
-     * @brief Returns whether the Workload contains SMPI jobs.
-     * @return true if and only if the number of SMPI jobs in the Workload is greater than 0.
+     * @brief Returns whether the Workloads contain SMPI trace replay profiles.
+     * @return true if and only if an SMPI trace replay profile has been added to any Workload.
      */
-    bool contains_smpi_job() const;
-
-    /**
-     * @brief Registers SMPI applications
-     */
-    void register_smpi_applications();
+    bool contains_smpi_profile() const;
 
     /**
      * @brief Gets the internal map
@@ -267,3 +271,25 @@ public:
 private:
     std::map<std::string, Workload*> _workloads; //!< Associates Workloads with their names
 };
+
+/**
+ * @brief Returns the name of the profile of a job only described by its runtime (SWF, generated or DAX jobs)
+ * @param[in] workload_name The name of the workload of the job
+ * @param[in] runtime The runtime of the job, in seconds
+ * @param[in] options How the job is mapped to a profile
+ * @return The profile name. Jobs with the same runtime share it.
+ */
+std::string runtime_profile_name(const std::string & workload_name,
+                                 double runtime,
+                                 const SwfWorkloadOptions & options);
+
+/**
+ * @brief Creates the profile of a job only described by its runtime (SWF, generated or DAX jobs)
+ * @param[in] profile_name The name of the profile, as returned by runtime_profile_name
+ * @param[in] runtime The runtime of the job, in seconds
+ * @param[in] options How the job is mapped to a profile
+ * @return The newly created profile
+ */
+ProfilePtr new_runtime_profile(const std::string & profile_name,
+                               double runtime,
+                               const SwfWorkloadOptions & options);
@@ -0,0 +1,203 @@
+/**
+ * @file workload_generator.cpp
+ * @brief Generation of synthetic workloads from statistical models
+ */
+
+#include "workload_generator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <xbt.h>
+
+using namespace std;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(workload_generator, "workload_generator"); //!< Logging
+
+// Parameters of the batch jobs model of Lublin & Feitelson (2003), "The workload on parallel supercomputers:
+// modeling the characteristics of rigid jobs", as in their reference implementation (lublin99.c).
+static const double LUBLIN_SERIAL_PROB = 0.244; //!< The probability of a job to be serial
+static const double LUBLIN_POW2_PROB = 0.576;   //!< The probability of a parallel job size to be a power of two
+static const double LUBLIN_ULOW = 0.8;          //!< The lowest log2 size of parallel jobs
+static const double LUBLIN_UMED_OFFSET = 2.5;   //!< The distance between the highest and the middle log2 sizes
+static const double LUBLIN_UPROB = 0.86;        //!< The probability of a log2 size to be in the lower stage
+static const double LUBLIN_A1 = 4.2;            //!< The shape of the first gamma of the log-runtime
+static const double LUBLIN_B1 = 0.94;           //!< The scale of the first gamma of the log-runtime
+static const double LUBLIN_A2 = 312;            //!< The shape of the second gamma of the log-runtime
+static const double LUBLIN_B2 = 0.03;           //!< The scale of the second gamma of the log-runtime
+static const double LUBLIN_PA = -0.0054;        //!< The slope of the first gamma probability, as a function of the size
+static const double LUBLIN_PB = 0.78;           //!< The intercept of the first gamma probability, as a function of the size
+
+//! The number of jobs drawn to estimate the mean work of a job, from which the inter-arrival time is computed
+static const int CALIBRATION_NB_JOBS = 100000;
+
+WorkloadGenerator::WorkloadGenerator(const GeneratorWorkloadOptions & options, int nb_res) :
+    _options(options),
+    _nb_res(nb_res)
+{
+    xbt_assert(_nb_res > 0, "Cannot generate a workload for %d resources", _nb_res);
+    xbt_assert(_options.load > 0, "Cannot generate a workload with a non-positive load (%g)", _options.load);
+
+    // Estimate the mean work of a job on a distinct random stream, then start the real one
+    _rng.seed(_options.seed ^ 0x9e3779b97f4a7c15ULL);
+    double total_work = 0;
+    for (int i = 0; i < CALIBRATION_NB_JOBS; ++i)
+    {
+        int size = draw_size();
+        total_work += size * draw_runtime(size);
+    }
+    const double mean_work = total_work / CALIBRATION_NB_JOBS;
+    _mean_inter_arrival_time = mean_work / (_options.load * _nb_res);
+
+    _rng.seed(_options.seed);
+    _has_spare_normal = false;
+
+    XBT_INFO("Generating %lu jobs with model '%s' (seed=%lu, load=%g, nb_res=%d): mean job work is %g resource-seconds, mean inter-arrival time is %g s",
+             static_cast<unsigned long>(_options.nb_jobs), _options.model.c_str(), static_cast<unsigned long>(_options.seed),
+             _options.load, _nb_res, mean_work, _mean_inter_arrival_time);
+}
+
+bool WorkloadGenerator::next_job(SwfJob & job)
+{
+    if (_nb_generated_jobs >= _options.nb_jobs)
+    {
+        return false;
+    }
+
+    // The first job is submitted at time 0
+    if (_nb_generated_jobs > 0)
+    {
+        switch (_options.arrival)
+        {
+        case GeneratorArrivalDistribution::POISSON:
+            _submission_time += -_mean_inter_arrival_time * log(1 - uniform());
+            break;
+        case GeneratorArrivalDistribution::FIXED:
+            _submission_time += _mean_inter_arrival_time;
+            break;
+        }
+    }
+
+    job.id = to_string(_nb_generated_jobs);
+    job.submission_time = _submission_time;
+    job.nb_res = draw_size();
+    job.runtime = draw_runtime(job.nb_res);
+    job.requested_time = -1;
+
+    ++_nb_generated_jobs;
+    return true;
+}
+
+int WorkloadGenerator::draw_size()
+{
+    switch (_options.size)
+    {
+    case GeneratorSizeDistribution::UNIFORM:
+        return 1 + std::min(static_cast<int>(uniform() * _nb_res), _nb_res - 1);
+    case GeneratorSizeDistribution::LUBLIN:
+        break;
+    }
+
+    if (uniform() < LUBLIN_SERIAL_PROB || _nb_res == 1)
+    {
+        return 1;
+    }
+
+    // Two-stage uniform log2 size, truncated to the machine size
+    const double uhi = std::max(log2(static_cast<double>(_nb_res)), LUBLIN_ULOW);
+    const double umed = std::max(uhi - LUBLIN_UMED_OFFSET, LUBLIN_ULOW);
+    double log_size;
+    if (uniform() < LUBLIN_UPROB)
+    {
+        log_size = LUBLIN_ULOW + uniform() * (umed - LUBLIN_ULOW);
+    }
+    else
+    {
+        log_size = umed + uniform() * (uhi - umed);
+    }
+
+    if (uniform() < LUBLIN_POW2_PROB)
+    {
+        log_size = round(log_size);
+    }
+
+    int size = static_cast<int>(round(pow(2, log_size)));
+    return std::clamp(size, 1, _nb_res);
+}
+
+double WorkloadGenerator::draw_runtime(int size)
+{
+    double runtime = 0;
+    switch (_options.runtime)
+    {
+    case GeneratorRuntimeDistribution::EXPONENTIAL:
+        runtime = -_options.mean_runtime * log(1 - uniform());
+        break;
+    case GeneratorRuntimeDistribution::LUBLIN:
+    {
+        // Hyper-gamma log-runtime: large jobs are more likely to be long
+        const double p = std::clamp(LUBLIN_PA * size + LUBLIN_PB, 0.0, 1.0);
+        if (uniform() < p)
+        {
+            runtime = exp(gamma(LUBLIN_A1, LUBLIN_B1));
+        }
+        else
+        {
+            runtime = exp(gamma(LUBLIN_A2, LUBLIN_B2));
+        }
+    } break;
+    }
+
+    // Whole seconds, as in SWF traces
+    return std::clamp(round(runtime), 1.0, std::max(1.0, round(_options.max_runtime)));
+}
+
+double WorkloadGenerator::uniform()
+{
+    // The 53 upper bits make a double in [0,1)
+    return static_cast<double>(_rng() >> 11) * 0x1.0p-53;
+}
+
+double WorkloadGenerator::normal()
+{
+    if (_has_spare_normal)
+    {
+        _has_spare_normal = false;
+        return _spare_normal;
+    }
+
+    const double u1 = 1 - uniform(); // in (0,1]
+    const double u2 = uniform();
+    const double radius = sqrt(-2 * log(u1));
+    _spare_normal = radius * sin(2 * M_PI * u2);
+    _has_spare_normal = true;
+    return radius * cos(2 * M_PI * u2);
+}
+
+double WorkloadGenerator::gamma(double shape, double scale)
+{
+    if (shape < 1)
+    {
+        // Gamma(a) = Gamma(a+1) * U^(1/a)
+        return gamma(shape + 1, scale) * pow(1 - uniform(), 1 / shape);
+    }
+
+    const double d = shape - 1.0 / 3;
+    const double c = 1 / sqrt(9 * d);
+    for (;;)
+    {
+        double x, v;
+        do
+        {
+            x = normal();
+            v = 1 + c * x;
+        } while (v <= 0);
+
+        v = v * v * v;
+        const double u = 1 - uniform(); // in (0,1]
+        if (log(u) < 0.5 * x * x + d - d * v + d * log(v))
+        {
+            return d * v * scale;
+        }
+    }
+}
@@ -0,0 +1,123 @@
+/**
+ * @file workload_generator.hpp
+ * @brief Generation of synthetic workloads from statistical models
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "swf.hpp"
+
+/**
+ * @brief How the submission times of generated jobs are distributed
+ */
+enum class GeneratorArrivalDistribution
+{
+    POISSON         //!< Exponentially distributed inter-arrival times
+    ,FIXED          //!< Constant inter-arrival times
+};
+
+/**
+ * @brief How the number of resources of generated jobs is distributed
+ */
+enum class GeneratorSizeDistribution
+{
+    LUBLIN          //!< Serial jobs or two-stage log-uniform sizes favoring powers of two (Lublin & Feitelson, 2003)
+    ,UNIFORM        //!< Uniform in [1, nb_res]
+};
+
+/**
+ * @brief How the runtime of generated jobs is distributed
+ */
+enum class GeneratorRuntimeDistribution
+{
+    LUBLIN          //!< Hyper-gamma log-runtimes, correlated with job sizes (Lublin & Feitelson, 2003)
+    ,EXPONENTIAL    //!< Exponential of mean mean_runtime
+};
+
+/**
+ * @brief How a synthetic workload is generated
+ */
+struct GeneratorWorkloadOptions
+{
+    std::string model = "lublin";   //!< The name of the model, which sets the default distributions
+    uint64_t seed = 0;              //!< The seed of the random number generator. The same seed always gives the same workload.
+    uint64_t nb_jobs = 1000;        //!< The number of jobs to generate
+    double load = 0.8;              //!< The target offered load: the generated work divided by the work the machines can do over the workload duration
+    GeneratorArrivalDistribution arrival = GeneratorArrivalDistribution::POISSON; //!< How submission times are distributed
+    GeneratorSizeDistribution size = GeneratorSizeDistribution::LUBLIN; //!< How numbers of resources are distributed
+    GeneratorRuntimeDistribution runtime = GeneratorRuntimeDistribution::LUBLIN; //!< How runtimes are distributed
+    double mean_runtime = 3600;     //!< The mean runtime (in seconds) of the EXPONENTIAL runtime distribution
+    double max_runtime = 172800;    //!< Runtimes are truncated to this value (in seconds). Without it, LUBLIN runtimes have a heavy tail that makes the load unpredictable.
+};
+
+/**
+ * @brief Generates the jobs of a synthetic workload one by one, in the same form as the jobs of a SWF trace
+ * @details Random bits come from std::mt19937_64 (whose output is fixed by the standard) and are turned into samples
+ *          by this class rather than by the standard library distributions (whose output depends on the implementation),
+ *          so that a seed always gives the same workload. Runtimes are rounded to whole seconds, as in SWF traces, so that jobs share profiles.
+ */
+class WorkloadGenerator
+{
+public:
+    /**
+     * @brief Builds a WorkloadGenerator
+     * @param[in] options How the workload is generated
+     * @param[in] nb_res The maximum number of resources of each job
+     */
+    WorkloadGenerator(const GeneratorWorkloadOptions & options, int nb_res);
+
+    /**
+     * @brief Generates the next job of the workload
+     * @param[out] job The generated job
+     * @return false if all the jobs have been generated, true otherwise
+     */
+    bool next_job(SwfJob & job);
+
+private:
+    /**
+     * @brief Draws a number of resources
+     * @return The number of resources, in [1, nb_res]
+     */
+    int draw_size();
+
+    /**
+     * @brief Draws a runtime
+     * @param[in] size The number of resources of the job
+     * @return The runtime (in seconds)
+     */
+    double draw_runtime(int size);
+
+    /**
+     * @brief Draws a number uniformly distributed in [0,1)
+     * @return The number
+     */
+    double uniform();
+
+    /**
+     * @brief Draws a standard normal number (Box-Muller transform)
+     * @return The number
+     */
+    double normal();
+
+    /**
+     * @brief Draws a gamma-distributed number (Marsaglia & Tsang method)
+     * @param[in] shape The shape of the distribution
+     * @param[in] scale The scale of the distribution
+     * @return The number
+     */
+    double gamma(double shape, double scale);
+
+private:
+    GeneratorWorkloadOptions _options;  //!< How the workload is generated
+    int _nb_res;                        //!< The maximum number of resources of each job
+    std::mt19937_64 _rng;               //!< The random number generator
+    double _mean_inter_arrival_time;    //!< The mean inter-arrival time that reaches the target load
+    double _submission_time = 0;        //!< The submission time of the next job
+    uint64_t _nb_generated_jobs = 0;    //!< The number of jobs generated so far
+    bool _has_spare_normal = false;     //!< Whether _spare_normal has not been used yet
+    double _spare_normal = 0;           //!< The second number of the last Box-Muller transform
+};
@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+'''End-to-end scalability benchmarks of Batsim.
+
+Generates synthetic platforms and workloads, runs them against the schedulers of test/edc-lib
+(as libraries and as a process) then reports the performance metrics of each run as JSON.
+Most metrics come from the real_exec_info.json file written by Batsim.
+
+The EDC libraries are located with the EDC_LD_LIBRARY_PATH environment variable, as in integration tests.
+Runs with the process EDC are skipped if it cannot be found.
+'''
+import argparse
+import json
+import os
+import random
+import shlex
+import shutil
+import subprocess
+import sys
+import time
+
+# (nb_hosts, nb_jobs, workload mix) of each preset. Each instance is run with every EDC of the preset.
+PRESETS = {
+    'small': {
+        'instances': [
+            (1000, 10000, 'delay'),
+            (1000, 10000, 'ptask'),
+            (1000, 10000, 'mixed'),
+        ],
+        'edcs': [('fcfs', 'lib'), ('easy', 'lib'), ('do-nothing', 'lib'), ('fcfs', 'process')],
+    },
+    'full': {
+        'instances': [(nb_hosts, nb_jobs, 'mixed')
+                      for nb_hosts in [1000, 10000, 100000]
+                      for nb_jobs in [10000, 100000, 1000000, 10000000]] + [
+            (1000, 100000, 'delay'),
+            (1000, 100000, 'ptask'),
+        ],
+        'edcs': [('fcfs', 'lib'), ('easy', 'lib'), ('do-nothing', 'lib'), ('fcfs', 'process')],
+    },
+}
+
+def generate_platform(filename: str, nb_hosts: int):
+    '''Writes a homogeneous cluster of nb_hosts computation hosts and a master host.'''
+    with open(filename, 'w') as f:
+        f.write(f'''<?xml version='1.0'?>
+<!DOCTYPE platform SYSTEM "http://simgrid.gforge.inria.fr/simgrid/simgrid.dtd">
+<platform version="4.1">
+  <zone id="AS0" routing="Full">
+    <cluster id="A" prefix="a" suffix="" radical="0-{nb_hosts-1}" speed="1Gf" bw="1GBps" lat="5us" bb_bw="3GBps" bb_lat="3us"/>
+    <cluster id="M" prefix="m" suffix="" radical="0-0" speed="1Gf" bw="1GBps" lat="5us" bb_bw="3GBps" bb_lat="3us">
+      <prop id="role" value="master" />
+    </cluster>
+    <link id="backbone" bandwidth="5GBps" latency="2us" />
+    <zoneRoute src="A" dst="M" gw_src="aA_router" gw_dst="mM_router">
+      <link_ctn id="backbone" />
+    </zoneRoute>
+  </zone>
+</platform>
+''')
+
+def generate_profiles(mix: str):
+    '''Returns the profiles of a workload mix, indexed by their names.'''
+    delays = {f'delay{d}': {'type': 'DelayProfile', 'delay': d} for d in [10, 60, 300, 1800]}
+    ptasks = {f'ptask{c}': {'type': 'ParallelTaskHomogeneousProfile', 'cpu': c * 1e9, 'com': 1e6} for c in [10, 60, 300]}
+    sequences = {
+        'seq-short': {'type': 'SequentialCompositionProfile', 'repeat': 10, 'seq': ['delay10', 'ptask10']},
+        'seq-long': {'type': 'SequentialCompositionProfile', 'repeat': 4, 'seq': ['ptask60', 'delay60']},
+    }
+
+    if mix == 'delay':
+        return delays
+    if mix == 'ptask':
+        return ptasks
+
+    assert mix == 'mixed', f'unknown workload mix {mix}'
+    return {**delays, **ptasks, **sequences}
+
+def generate_workload(filename: str, nb_hosts: int, nb_jobs: int, mix: str, seed: int):
+    '''Writes a workload of nb_jobs jobs submitted with exponentially distributed inter-arrival times.
+
+    Jobs are written one by one so that huge workloads can be generated without holding them in memory.
+    '''
+    rng = random.Random(seed)
+    profiles = generate_profiles(mix)
+    names = list(profiles.keys())
+    max_res_exponent = min(64, nb_hosts).bit_length() - 1
+
+    # Keep the platform busy without making the queue grow forever
+    mean_inter_arrival = 300 * (2 ** max_res_exponent / 4) / nb_hosts
+
+    with open(filename, 'w') as f:
+        f.write(f'{{\n  "nb_res": {nb_hosts},\n  "jobs": [\n')
+        subtime = 0.0
+        for i in range(nb_jobs):
+            subtime += rng.expovariate(1 / mean_inter_arrival)
+            res = 2 ** rng.randint(0, max_res_exponent)
+            profile = rng.choice(names)
+            separator = ',' if i + 1 < nb_jobs else ''
+            f.write(f'    {{"id": "{i}", "subtime": {subtime:.3f}, "walltime": 86400, "res": {res}, "profile": "{profile}"}}{separator}\n')
+        f.write('  ],\n  "profiles": ')
+        json.dump(profiles, f, indent=2)
+        f.write('\n}\n')
+
+def run_instance(args, output_dir: str, platform_file: str, workload_file: str, edc: str, mode: str):
+    '''Runs Batsim on an instance and returns its metrics.'''
+    os.makedirs(output_dir, exist_ok=True)
+
+    edc_init_filename = f'{output_dir}/edc-init'
+    with open(edc_init_filename, 'w') as f:
+        f.write(json.dumps({}))
+
+    batsim_cmd = [
+        args.batsim,
+        '--export', f'{output_dir}/batout/',
+        '--platform', platform_file,
+        '--workload', workload_file,
+        '--verbosity', 'quiet',
+    ]
+
+    edc_cmd = None
+    socket_path = f'{os.path.abspath(output_dir)}/sock'
+    if mode == 'lib':
+        batsim_cmd += ['--edc-library-file', f'{args.edc_dir}/lib{edc}.so', edc_init_filename]
+    else:
+        assert edc == 'fcfs', 'process mode is only available with the fcfs EDC (process-edc)'
+        batsim_cmd += ['--edc-socket-file', f'ipc://{socket_path}', edc_init_filename]
+        edc_cmd = [args.process_edc, '--socket-endpoint', f'ipc://{socket_path}']
+
+    with open(f'{output_dir}/batsim.sh', 'w') as f:
+        f.write(shlex.join(batsim_cmd) + '\n')
+
+    with open(f'{output_dir}/batsim.stdout', 'w') as out, open(f'{output_dir}/batsim.stderr', 'w') as err:
+        start = time.monotonic()
+        batsim = subprocess.Popen(batsim_cmd, stdout=out, stderr=err)
+        edc_process = None
+        if edc_cmd is not None:
+            edc_process = subprocess.Popen(edc_cmd, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+        try:
+            returncode = batsim.wait(timeout=args.timeout)
+        except subprocess.TimeoutExpired:
+            batsim.kill()
+            returncode = None
+        wall_seconds = time.monotonic() - start
+
+        if edc_process is not None:
+            try:
+                edc_process.wait(timeout=5)
+            except subprocess.TimeoutExpired:
+                edc_process.kill()
+            try:
+                os.remove(socket_path)
+            except OSError:
+                pass
+
+    metrics = {
+        'returncode': returncode,
+        'wall_seconds': wall_seconds,
+    }
+    if returncode != 0:
+        return metrics
+
+    with open(f'{output_dir}/batout/real_exec_info.json') as f:
+        info = json.load(f)
+
+    loop_seconds = info['time_phase_simulation_loop_seconds']
+    metrics.update({
+        'events_per_second': info['events_per_second'],
+        'edc_calls_per_second': info['nb_edc_calls'] / loop_seconds if loop_seconds > 0 else 0,
+        'peak_rss_kB': info['memory_VmHWM_kB'],
+        'startup_seconds': info['time_phase_loading_seconds'] + info['time_phase_platform_creation_seconds'],
+        'simulation_loop_seconds': loop_seconds,
+        'nb_edc_calls': info['nb_edc_calls'],
+        'nb_server_messages_handled': info['nb_server_messages_handled'],
+    })
+    return metrics
+
+def find_process_edc(edc_dir: str):
+    '''Returns the path of process-edc, installed next to the EDC libraries or in the PATH, or None.'''
+    installed = os.path.join(edc_dir, os.pardir, 'bin', 'process-edc')
+    if os.access(installed, os.X_OK):
+        return os.path.normpath(installed)
+    return shutil.which('process-edc')
+
+def batsim_version(batsim: str):
+    p = subprocess.run([batsim, '--version'], capture_output=True, text=True)
+    return p.stdout.strip()
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--batsim', default='batsim', help='the batsim executable to benchmark')
+    parser.add_argument('--process-edc', default=None, help='the process EDC of test/edc-lib (default: the one installed with the EDC libraries, or process-edc in the PATH)')
+    parser.add_argument('--edc-dir', default=os.getenv('EDC_LD_LIBRARY_PATH'), help='where the EDC libraries of test/edc-lib are (default: $EDC_LD_LIBRARY_PATH)')
+    parser.add_argument('--preset', default=os.getenv('BATSIM_BENCH_PRESET', 'small'), choices=PRESETS.keys(), help='which instances are run (default: $BATSIM_BENCH_PRESET or small)')
+    parser.add_argument('--work-dir', default='/tmp/batsim-bench', help='where generated inputs and Batsim outputs are put')
+    parser.add_argument('--output', default='-', help='the JSON file the results are written to (default: stdout)')
+    parser.add_argument('--timeout', type=float, default=3600, help='the maximum duration (in seconds) of each run')
+    parser.add_argument('--seed', type=int, default=1, help='the seed of workload generation')
+    args = parser.parse_args()
+
+    if args.edc_dir is None:
+        parser.error('the EDC libraries directory must be given (--edc-dir or EDC_LD_LIBRARY_PATH)')
+    if args.process_edc is None:
+        args.process_edc = find_process_edc(args.edc_dir)
+        if args.process_edc is None:
+            print('process-edc not found (use --process-edc or put it in the PATH): runs with the process EDC are skipped', file=sys.stderr)
+
+    preset = PRESETS[args.preset]
+    results = {
+        'batsim_version': batsim_version(args.batsim),
+        'preset': args.preset,
+        'seed': args.seed,
+        'runs': [],
+    }
+
+    for nb_hosts, nb_jobs, mix in preset['instances']:
+        instance_name = f'{mix}-{nb_hosts}h-{nb_jobs}j'
+        instance_dir = f'{args.work_dir}/{instance_name}'
+        os.makedirs(instance_dir, exist_ok=True)
+
+        platform_file = f'{instance_dir}/platform.xml'
+        workload_file = f'{instance_dir}/workload.json'
+        generate_platform(platform_file, nb_hosts)
+        generate_workload(workload_file, nb_hosts, nb_jobs, mix, args.seed)
+
+        for edc, mode in preset['edcs']:
+            if mode == 'process' and args.process_edc is None:
+                continue
+            print(f'running {instance_name} with {edc} ({mode})...', file=sys.stderr, flush=True)
+            metrics = run_instance(args, f'{instance_dir}/{edc}-{mode}', platform_file, workload_file, edc, mode)
+            results['runs'].append({
+                'nb_hosts': nb_hosts,
+                'nb_jobs': nb_jobs,
+                'mix': mix,
+                'edc': edc,
+                'edc_mode': mode,
+                **metrics,
+            })
+
+    if args.output == '-':
+        json.dump(results, sys.stdout, indent=2)
+        print()
+    else:
+        with open(args.output, 'w') as f:
+            json.dump(results, f, indent=2)
+            f.write('\n')
+
+    failed_runs = [run for run in results['runs'] if run['returncode'] != 0]
+    return 1 if failed_runs else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -3,6 +3,7 @@
 #include <list>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <batprotocol.hpp>
@@ -162,6 +163,30 @@ void do_registration_ok(std::string first_profile_id)
 
 }
 
+void do_grouped_registration(std::string first_profile_id, bool identical_job_names)
+{
+    auto p = batprotocol::Profile::make_delay(3);
+    mb->add_register_profile("dyn!delay3", p);
+
+    // Consecutive registrations, whose workload and profile change from one job to the next
+    const std::vector<std::pair<std::string, std::string>> jobs_to_register = {
+        {"dyn!g0", "dyn!delay3"},
+        {identical_job_names ? "dyn!g0" : "dyn!g1", "dyn!delay3"},
+        {"w0!g2", first_profile_id},
+        {"dyn!g3", "dyn!delay3"},
+    };
+    for (const auto & [job_id, profile_id] : jobs_to_register)
+    {
+        auto job = batprotocol::Job::make();
+        job->set_resource_number(1);
+        job->set_walltime(20);
+        job->set_profile(profile_id);
+        mb->add_register_job(job_id, job);
+    }
+
+    mb->add_reject_job(first_job->id);
+}
+
 uint8_t batsim_edc_take_decisions(
     const uint8_t * what_happened,
     uint32_t what_happened_size,
@@ -258,6 +283,10 @@ uint8_t batsim_edc_take_decisions(
             j1->set_profile(first_profile_id);
             mb->add_register_job("dyn!j1", j1);
         }
+        else if ((init_string == "grouped_jobs_ok") or (init_string == "grouped_identical_job_names_fail"))
+        {
+            do_grouped_registration(first_profile_id, init_string == "grouped_identical_job_names_fail");
+        }
         else
         {
             do_registration_ok(first_profile_id);
@@ -31,6 +31,8 @@ double epsilon = 1e-3;
 double inter_stop_probe_delay = 0.0;
 double probe_deadline = 500.0;
 std::string behavior = "unset";
+bool reuse_probe_ids = false;
+bool probe_id_reused = false;
 
 double all_hosts_energy = 0.0;
 std::vector<double> host_energy;
@@ -42,6 +44,7 @@ uint8_t batsim_edc_init(const uint8_t *init_data, uint32_t init_size, uint32_t *
         auto init_json = json::parse(init_string);
         behavior = init_json["behavior"];
         inter_stop_probe_delay = init_json["inter_stop_probe_delay"];
+        reuse_probe_ids = init_json.value("reuse_probe_ids", false);
     } catch (const json::exception & e) {
         throw std::runtime_error("scheduler called with bad init string: " + std::string(e.what()));
     }
@@ -111,6 +114,19 @@ uint8_t batsim_edc_take_decisions(
             cp->set_resource_aggregation_as_sum();
             mb->add_create_probe("hosts-agg", batprotocol::fb::Metrics_Power, cp);
 
+            // Two more probes whose identifiers only differ by characters that are not safe in filenames
+            if (reuse_probe_ids) {
+                auto cp_slash = batprotocol::CreateProbe::make_temporal_triggerred(when);
+                cp_slash->set_resources_as_hosts("0-1");
+                cp_slash->enable_accumulation_no_reset();
+                mb->add_create_probe("hosts/vec", batprotocol::fb::Metrics_Power, cp_slash);
+
+                auto cp_underscore = batprotocol::CreateProbe::make_temporal_triggerred(when);
+                cp_underscore->set_resources_as_hosts("0-3");
+                cp_underscore->enable_accumulation_no_reset();
+                mb->add_create_probe("hosts_vec", batprotocol::fb::Metrics_Power, cp_underscore);
+            }
+
             probes_running = true;
         } break;
         case fb::Event_JobSubmittedEvent: {
@@ -166,6 +182,15 @@ uint8_t batsim_edc_take_decisions(
                 }
             } else if (e->probe_id()->str() == "hosts-agg") {
                 all_hosts_energy = e->data_as_AggregatedProbeData()->data();
+            } else if (e->probe_id()->str() == "hosts/vec" && !probe_id_reused && event->timestamp() >= 10) {
+                // Replace the probe by one with the same identifier on a different number of hosts
+                mb->add_stop_probe("hosts/vec");
+                auto when = TemporalTrigger::make_periodic(1);
+                auto cp = batprotocol::CreateProbe::make_temporal_triggerred(when);
+                cp->set_resources_as_hosts("0-2");
+                cp->enable_accumulation_no_reset();
+                mb->add_create_probe("hosts/vec", batprotocol::fb::Metrics_Power, cp);
+                probe_id_reused = true;
             }
 
             new_probe_call_time = event->timestamp();
@@ -220,6 +245,10 @@ uint8_t batsim_edc_take_decisions(
         msg_date += inter_stop_probe_delay;
         mb->set_current_time(msg_date);
         mb->add_stop_probe("hosts-agg");
+        if (reuse_probe_ids) {
+            mb->add_stop_probe("hosts/vec");
+            mb->add_stop_probe("hosts_vec");
+        }
         probes_running = false;
     }
 
@@ -6,6 +6,7 @@ These tests run batsim with various dynamic registration of job/profile scenario
 import inspect
 import os
 import subprocess
+import pandas as pd
 import pytest
 
 from helper import prepare_instance, run_batsim
@@ -19,6 +20,8 @@ MOD_NAME = __name__.replace('test_', '', 1)
     ("identical_profile_names_fail", -6),
     ("profile_reuse_fail", -6),
     ("profile_reuse_ok", 0),
+    ("grouped_jobs_ok", 0),
+    ("grouped_identical_job_names_fail", -6),
 ])
 def parameters(request):
     return request.param
@@ -36,3 +39,27 @@ def test_dyn_register(test_root_dir, parameters):
     batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, platform, 'dyn-register', workload, edc_init_content=edc_init_args)
     p = run_batsim(batcmd, outdir)
     assert p.returncode == expected_ret_code
+
+def test_dyn_register_grouped(test_root_dir):
+    edc_init_args = {"option": "grouped_jobs_ok"}
+
+    platform = 'small_platform'
+    workload = 'test_one_delay_job'
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, platform, 'dyn-register', workload, edc_init_content=edc_init_args)
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode == 0
+
+    # The jobs registered in one message are added as a single block
+    with open(f'{outdir}/batsim.stderr') as f:
+        assert "Added 4 dynamically registered jobs (from 'dyn!g0' to 'dyn!g3')" in f.read()
+
+    jobs = pd.read_csv(f'{outdir}/batout/jobs.csv')
+    registered = jobs[jobs['job_id'].isin(['g0', 'g1', 'g2', 'g3'])].set_index('job_id').sort_index()
+    assert list(registered.index) == ['g0', 'g1', 'g2', 'g3']
+    assert list(registered['workload_name']) == ['dyn', 'dyn', 'w0', 'dyn']
+    assert list(registered['profile']) == ['dyn!delay3', 'dyn!delay3', 'w0!delay10', 'dyn!delay3']
+    assert (registered['final_state'] == 'COMPLETED_SUCCESSFULLY').all()
+    assert registered['submission_time'].nunique() == 1
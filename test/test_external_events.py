@@ -16,6 +16,8 @@ MOD_NAME = __name__.replace('test_', '', 1)
     ("e1", ["test_generic_events"]),
     ("e2", ["test_generic_events2"]),
     ("e1e2", ["test_generic_events", "test_generic_events2"]),
+    ("unsorted", ["test_generic_events_unsorted"]),
+    ("e1unsorted", ["test_generic_events", "test_generic_events_unsorted"]),
 ])
 def parameters(request):
     return request.param
@@ -21,7 +21,7 @@ def use_json(request):
 def kill_delay(request):
     return request.param
 
-@pytest.fixture(scope="module", params=['test_delays', 'test_ptasks', 'test_homo_ptasks', 'test_compo_sequence_delay', 'test_compo_sequence_ptaskcomp'])
+@pytest.fixture(scope="module", params=['test_delays', 'test_ptasks', 'test_homo_ptasks', 'test_compo_sequence_delay', 'test_compo_sequence_ptaskcomp', 'test_compo_forkjoin'])
 def workload(request):
     return request.param
 
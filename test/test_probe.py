@@ -9,9 +9,13 @@ import subprocess
 import pytest
 import pandas as pd
 import random
+import sys
 
 from helper import prepare_instance, run_batsim
 
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'tools'))
+from read_probe_data import read_probe_data
+
 MOD_NAME = __name__.replace('test_', '', 1)
 
 @pytest.fixture(scope="module", params=['wload', 'deadline'])
@@ -37,3 +41,65 @@ def test_energy(test_root_dir, behavior, inter_stop_probe_delay):
     batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, platform, 'probe-energy', workload, edc_init_content=edc_init_args, batsim_extra_args=batargs)
     p = run_batsim(batcmd, outdir)
     assert p.returncode == 0
+
+def test_trace_probe_data(test_root_dir):
+    platform = 'cluster_energy_128'
+    workload = 'test_homo_ptasks'
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    edc_init_args = {
+        'behavior': 'wload',
+        'inter_stop_probe_delay': 0.0,
+    }
+
+    batargs = ["--energy-host", "--trace-probe-data", "always"]
+    batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, platform, 'probe-energy', workload, edc_init_content=edc_init_args, batsim_extra_args=batargs)
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode == 0
+
+    vec_header, vec_dates, vec_values = read_probe_data(f'{outdir}/batout/probe_hosts-vec.bin')
+    agg_header, agg_dates, agg_values = read_probe_data(f'{outdir}/batout/probe_hosts-agg.bin')
+    assert vec_header['probe_id'] == 'hosts-vec' and vec_header['vectorial']
+    assert agg_header['probe_id'] == 'hosts-agg' and not agg_header['vectorial']
+    assert vec_header['nb_values'] == 128 and vec_header['resources'] == '0-127'
+    assert agg_header['nb_values'] == 1
+
+    # Both probes have a 1 s period and were created at the same time
+    assert len(vec_dates) > 1
+    assert vec_dates == agg_dates
+    for previous, current in zip(vec_dates, vec_dates[1:]):
+        assert abs(current - previous - 1) < 1e-6
+
+    for vec, (agg,) in zip(vec_values, agg_values):
+        assert abs(sum(vec) - agg) < 1e-3
+
+def test_trace_probe_data_reused_ids(test_root_dir):
+    platform = 'cluster_energy_128'
+    workload = 'test_homo_ptasks'
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    edc_init_args = {
+        'behavior': 'wload',
+        'inter_stop_probe_delay': 0.0,
+        'reuse_probe_ids': True,
+    }
+
+    batargs = ["--energy-host", "--trace-probe-data", "always"]
+    batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, platform, 'probe-energy', workload, edc_init_content=edc_init_args, batsim_extra_args=batargs)
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode == 0
+
+    # 'hosts/vec' and 'hosts_vec' have the same safe name, and 'hosts/vec' is recreated on 3 hosts at time 10
+    probes = dict()
+    for filename in ['probe_hosts_vec.bin', 'probe_hosts_vec_1.bin', 'probe_hosts_vec_2.bin']:
+        header, dates, _ = read_probe_data(f'{outdir}/batout/{filename}')
+        probes[filename] = (header['probe_id'], header['nb_values'], dates)
+
+    first_files = {probes[f][:2] for f in ['probe_hosts_vec.bin', 'probe_hosts_vec_1.bin']}
+    assert first_files == {('hosts/vec', 2), ('hosts_vec', 4)}
+
+    probe_id, nb_values, dates = probes['probe_hosts_vec_2.bin']
+    assert (probe_id, nb_values) == ('hosts/vec', 3)
+    assert len(dates) > 0 and dates[0] > 10
@@ -7,8 +7,9 @@ import inspect
 import os
 import subprocess
 import pytest
+import pandas as pd
 
-from helper import prepare_instance, run_batsim, run_instance_check_job_duration_and_state
+from helper import prepare_instance, run_batsim, run_instance_check_job_duration_and_state, check_job_duration_from_profile_expected_duration, check_job_duration_from_job_expected_duration
 
 MOD_NAME = __name__.replace('test_', '', 1)
 
@@ -87,3 +88,91 @@ def test_sequential_composition_ptaskcomp(test_root_dir):
     edc = 'exec1by1'
 
     run_instance_check_job_duration_and_state(test_root_dir, platform, workload, instance_name, edc)
+
+def test_forkjoin_composition(test_root_dir):
+    # Branches run concurrently, and the first failing or timed out branch stops the other ones
+    platform = 'cluster512'
+    workload = 'test_compo_forkjoin'
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    batcmd, outdir, workload_file, _ = prepare_instance(instance_name, test_root_dir, platform, 'exec1by1', workload)
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode == 0
+
+    check_job_duration_from_job_expected_duration(workload_file, outdir)
+
+def test_ptask_merge_composition(test_root_dir):
+    # Merged parts share the resources of a single parallel task instead of being executed one after the other
+    platform = 'cluster512'
+    workload = 'test_compo_ptask_merge'
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, platform, 'exec1by1', workload)
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode == 0
+
+    jobs = pd.read_csv(f'{outdir}/batout/jobs.csv').set_index('job_id')
+    assert (jobs['final_state'] == 'COMPLETED_SUCCESSFULLY').all()
+    runtime = jobs['execution_time']
+
+    # Computations and communications use different resources: they overlap when merged
+    assert runtime['seq'] == pytest.approx(runtime['compute'] + runtime['network'], rel=1e-5)
+    assert runtime['merge'] == pytest.approx(max(runtime['compute'], runtime['network']), rel=1e-5)
+    assert runtime['merge'] < runtime['seq']
+
+    # Computations on the same hosts are summed when merged, which lasts as long as executing them in sequence
+    assert runtime['merge-compute'] == pytest.approx(runtime['seq-compute'], rel=1e-5)
+    assert runtime['merge-compute'] == pytest.approx(2 * runtime['compute'], rel=1e-5)
+
+    # Merged parts use the resources of the job, as the parts executed in sequence
+    assert jobs.loc['merge', 'allocated_resources'] == jobs.loc['seq', 'allocated_resources']
+
+@pytest.mark.parametrize('fast_forward', [False, True])
+def test_sequential_composition_pstate_change(test_root_dir, fast_forward):
+    # Repetitions last 3 s at pstate 0 and 6 s at pstate 1. The switch happens in the middle of the first
+    # sub-profile of the 4th repetition: 9 + 1 + (1 + 2) + 6*6 = 50 s.
+    platform = 'small_platform_dvfs'
+    workload = 'test_compo_sequence_pstate_change'
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}-{"ff" if fast_forward else "noff"}'
+    edc_init_args = {
+        "switch_time": 10,
+        "pstate": 1,
+        "hosts": "0",
+    }
+    extra_args = ['--fast-forward-sequences'] if fast_forward else []
+
+    batcmd, outdir, workload_file, _ = prepare_instance(instance_name, test_root_dir, platform, 'exec1by1-pstate-later', workload, edc_init_content=edc_init_args, batsim_extra_args=extra_args)
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode == 0
+
+    check_job_duration_from_profile_expected_duration(workload_file, outdir)
+
+@pytest.mark.parametrize('energy', [False, True])
+def test_sequential_composition_fast_forward_concurrent(test_root_dir, energy):
+    # Fast-forwarding must not change the simulation when another job runs concurrently or when energy is measured
+    platform = 'cluster_energy_128'
+    workload = 'test_compo_sequence_fast_forward_concurrent'
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+
+    outputs = dict()
+    for fast_forward in [False, True]:
+        instance_name = f'{MOD_NAME}-{func_name}-{"energy" if energy else "noenergy"}-{"ff" if fast_forward else "noff"}'
+        extra_args = (['--energy-host'] if energy else []) + (['--fast-forward-sequences'] if fast_forward else [])
+
+        batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, platform, 'fcfs', workload, batsim_extra_args=extra_args)
+        p = run_batsim(batcmd, outdir)
+        assert p.returncode == 0
+        outputs[fast_forward] = (pd.read_csv(f'{outdir}/batout/jobs.csv').sort_values('job_id').reset_index(drop=True),
+                                 pd.read_csv(f'{outdir}/batout/schedule.csv'))
+
+    jobs_noff, schedule_noff = outputs[False]
+    jobs_ff, schedule_ff = outputs[True]
+    assert list(jobs_ff['job_id']) == list(jobs_noff['job_id'])
+    assert list(jobs_ff['finish_time']) == pytest.approx(list(jobs_noff['finish_time']))
+    if energy:
+        assert list(jobs_ff['consumed_energy']) == pytest.approx(list(jobs_noff['consumed_energy']))
+    if energy:
+        assert schedule_ff['consumed_joules'][0] == pytest.approx(schedule_noff['consumed_joules'][0])
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+'''Streamed workload tests.
+
+These tests check that traces in the Standard Workload Format are simulated without conversion,
+and that synthetic workloads are generated during the simulation.
+'''
+import inspect
+import pandas as pd
+import pytest
+
+from helper import prepare_instance, run_batsim, WORKLOAD_DIR
+
+MOD_NAME = __name__.replace('test_', '', 1)
+
+# (submission time, runtime) of the valid jobs of workloads/test_swf.swf
+EXPECTED_JOBS = [(0, 100), (0, 60), (10, 100), (30, 30), (30, 45), (100, 200), (100, 60), (200, 5)]
+
+def run_swf_instance(instance_name, test_root_dir, swf_parameters, batsim_extra_args=[]):
+    workload_arg = f'{WORKLOAD_DIR}/test_swf.swf'
+    if swf_parameters:
+        workload_arg += '?' + swf_parameters
+
+    batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, 'cluster512', 'fcfs', batsim_extra_args=['--workload', workload_arg] + batsim_extra_args)
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode == 0
+
+    jobs = pd.read_csv(f'{outdir}/batout/jobs.csv').sort_values(by=['submission_time', 'execution_time'])
+    expected = sorted(EXPECTED_JOBS)
+    assert len(jobs) == len(expected)
+    assert list(jobs['submission_time']) == [subtime for subtime, _ in expected]
+    return jobs, expected
+
+def test_swf_delay(test_root_dir):
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    jobs, expected = run_swf_instance(instance_name, test_root_dir, None)
+    assert (jobs['final_state'] == 'COMPLETED_SUCCESSFULLY').all()
+    for execution_time, (_, runtime) in zip(jobs['execution_time'], expected):
+        assert abs(execution_time - runtime) < 1e-6
+
+def test_swf_ptask(test_root_dir):
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    # cluster512 hosts compute 1 Gflop/s, and jobs do not communicate: jobs last their SWF runtime
+    jobs, expected = run_swf_instance(instance_name, test_root_dir, 'profile=ptask&speed=1e9&walltime_factor=3')
+    assert (jobs['final_state'] == 'COMPLETED_SUCCESSFULLY').all()
+    for execution_time, (_, runtime) in zip(jobs['execution_time'], expected):
+        assert abs(execution_time - runtime) < 1e-3
+
+def test_generated_lublin(test_root_dir):
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, 'cluster512', 'fcfs', batsim_extra_args=['--workload', 'gen:lublin?seed=3&jobs=200&load=0.5&nb_res=64'])
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode == 0
+
+    jobs = pd.read_csv(f'{outdir}/batout/jobs.csv')
+    assert len(jobs) == 200
+    assert (jobs['requested_number_of_resources'] <= 64).all()
+    assert (jobs['final_state'] == 'COMPLETED_SUCCESSFULLY').all()
+
+@pytest.fixture(scope="module", params=[1, 4])
+def nthreads(request):
+    return request.param
+
+def test_swf_recurring_runtime_after_gc(test_root_dir, nthreads):
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}-{nthreads}'
+
+    # Jobs 2 and 9 share their runtime (60 s). Job 2 completes before job 9 is submitted,
+    # so their profile is garbage collected in between and must be registered again by the server for job 9,
+    # also when actors run on several threads.
+    jobs, _ = run_swf_instance(instance_name, test_root_dir, None, ['--sg-cfg', f'contexts/nthreads:{nthreads}'])
+    recurring = jobs[jobs['job_id'].astype(str).str.split('!').str[-1].isin(['2', '9'])]
+    assert len(recurring) == 2
+    assert (recurring['final_state'] == 'COMPLETED_SUCCESSFULLY').all()
+    assert recurring['profile'].nunique() == 1
+    assert float(recurring['starting_time'].min()) + 60 <= float(recurring['submission_time'].max())
@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+'''Time window tests.
+
+These tests check that only the jobs of the simulated time window are written in the outputs,
+and that the simulation stops at the end of the window.
+'''
+import inspect
+import json
+import pandas as pd
+
+from helper import prepare_instance, run_batsim, WORKLOAD_DIR
+
+MOD_NAME = __name__.replace('test_', '', 1)
+
+def test_time_window_warm_up(test_root_dir):
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    # Jobs of workloads/test_swf.swf are submitted at 0, 10, 30, 100 and 200:
+    # those at 0 are skipped, the one at 10 is a warm-up job and the one at 200 is after the window
+    batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, 'cluster512', 'fcfs', batsim_extra_args=[
+        '--workload', f'{WORKLOAD_DIR}/test_swf.swf', '--time-window', '20:150', '--warm-up', '15'])
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode == 0
+
+    jobs = pd.read_csv(f'{outdir}/batout/jobs.csv')
+    assert set(jobs['submission_time']) <= {30, 100}
+    assert (jobs[jobs['submission_time'] == 30]['final_state'] == 'COMPLETED_SUCCESSFULLY').all()
+    assert len(jobs[jobs['submission_time'] == 30]) == 2
+    assert (jobs['finish_time'] <= 150).all()
+
+    with open(f'{outdir}/batout/schedule.json') as f:
+        schedule = json.load(f)
+    assert schedule['nb_warm_up_jobs'] == 1
+
+def test_time_window_invalid(test_root_dir):
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, 'cluster512', 'fcfs', batsim_extra_args=[
+        '--workload', f'{WORKLOAD_DIR}/test_swf.swf', '--time-window', '150:20'])
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode != 0
@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+'''Workflow tests.
+
+These tests check that Batsim submits the jobs of a workflow once the jobs they depend on have completed successfully,
+and that jobs that depend on unsuccessful jobs are never submitted.
+'''
+import inspect
+import xml.etree.ElementTree as ET
+import pandas as pd
+
+from helper import prepare_instance, run_batsim, WORKLOAD_DIR
+
+MOD_NAME = __name__.replace('test_', '', 1)
+
+def test_workflow_json(test_root_dir):
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, 'cluster512', 'fcfs', batsim_extra_args=[
+        '--workload', f'{WORKLOAD_DIR}/test_workflow.json'])
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode == 0
+
+    jobs = pd.read_csv(f'{outdir}/batout/jobs.csv').set_index('job_id')
+    # Job 4 reaches its walltime: jobs 5 and 6 are never submitted
+    assert sorted(jobs.index) == [1, 2, 3, 4, 7]
+    assert jobs.loc[4, 'final_state'] == 'COMPLETED_WALLTIME_REACHED'
+    assert (jobs.drop(index=4)['final_state'] == 'COMPLETED_SUCCESSFULLY').all()
+
+    # Job 3 is submitted when job 2 completes, job 7 is submitted at its subtime
+    assert abs(jobs.loc[3, 'submission_time'] - jobs.loc[2, 'finish_time']) < 1e-6
+    assert abs(jobs.loc[7, 'submission_time'] - 100) < 1e-6
+
+def test_workflow_dax(test_root_dir):
+    func_name = inspect.currentframe().f_code.co_name.replace('test_', '', 1)
+    instance_name = f'{MOD_NAME}-{func_name}'
+
+    dax_file = f'{WORKLOAD_DIR}/GENOME.d.351024866.5.dax'
+    batcmd, outdir, _, _ = prepare_instance(instance_name, test_root_dir, 'cluster512', 'fcfs', batsim_extra_args=[
+        '--workload', dax_file])
+    p = run_batsim(batcmd, outdir)
+    assert p.returncode == 0
+
+    ns = {'dax': 'http://pegasus.isi.edu/schema/DAX'}
+    root = ET.parse(dax_file).getroot()
+    job_ids = [job.get('id') for job in root.findall('dax:job', ns)]
+    parents = {child.get('ref'): [parent.get('ref') for parent in child.findall('dax:parent', ns)] for child in root.findall('dax:child', ns)}
+
+    jobs = pd.read_csv(f'{outdir}/batout/jobs.csv', dtype={'job_id': str}).set_index('job_id')
+    assert sorted(jobs.index) == sorted(job_ids)
+    assert (jobs['final_state'] == 'COMPLETED_SUCCESSFULLY').all()
+
+    # Every job is submitted (hence started) after all its parents have finished
+    for child, child_parents in parents.items():
+        for parent in child_parents:
+            assert jobs.loc[child, 'submission_time'] >= jobs.loc[parent, 'finish_time'] - 1e-6
+            assert jobs.loc[child, 'starting_time'] >= jobs.loc[parent, 'finish_time'] - 1e-6
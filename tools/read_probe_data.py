@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Reads a probe data file written by Batsim (--trace-probe-data)."""
+
+# Everything is in the standard library. Files compressed with
+# --output-compression gzip (.gz suffix) are read transparently.
+
+import argparse
+import csv
+import gzip
+import struct
+import sys
+
+MAGIC = b'BATPROBE'
+VALUE_TYPES = {1: 'd'}
+
+
+def read_varint(data, pos):
+    """Decode a LEB128 varint of data at pos. Return (value, new pos)."""
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7f) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+
+
+def read_probe_data(filename):
+    """Read a probe data file.
+
+    Return (header, dates, values): header is a dict that describes the
+    probe, dates the emission dates (in seconds) and values a list with one
+    tuple of values per emission.
+    """
+    opener = gzip.open if filename.endswith('.gz') else open
+    with opener(filename, 'rb') as f:
+        data = f.read()
+
+    if data[:8] != MAGIC:
+        raise ValueError(f"'{filename}' is not a Batsim probe data file")
+    version, value_type, is_vectorial, metrics, resource_type, nb_values = \
+        struct.unpack_from('<BBBBBI', data, 8)
+    if version != 1:
+        raise ValueError(f"'{filename}': unsupported format version {version}")
+    pos = 8 + 9
+    (id_size,) = struct.unpack_from('<I', data, pos)
+    probe_id = data[pos+4:pos+4+id_size].decode()
+    pos += 4 + id_size
+    (resources_size,) = struct.unpack_from('<I', data, pos)
+    resources = data[pos+4:pos+4+resources_size].decode()
+    pos += 4 + resources_size
+
+    header = {
+        'probe_id': probe_id,
+        'vectorial': bool(is_vectorial),
+        'metrics': metrics,
+        'resource_type': resource_type,
+        'resources': resources,
+        'nb_values': nb_values,
+    }
+
+    values_format = f'<{nb_values}{VALUE_TYPES[value_type]}'
+    values_size = struct.calcsize(values_format)
+    dates = []
+    values = []
+    date_us = 0
+    while pos < len(data):
+        delta_us, pos = read_varint(data, pos)
+        date_us += delta_us
+        dates.append(date_us * 1e-6)
+        values.append(struct.unpack_from(values_format, data, pos))
+        pos += values_size
+
+    return header, dates, values
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Reads a Batsim probe data '
+                                     'file and writes it as CSV (one row per '
+                                     'emission, one column per value)')
+    parser.add_argument('input_file', help='The probe data file')
+    parser.add_argument('-o', '--output', type=argparse.FileType('w'),
+                        default=sys.stdout, help='The output CSV file')
+    args = parser.parse_args()
+
+    header, dates, values = read_probe_data(args.input_file)
+    writer = csv.writer(args.output)
+    if header['vectorial']:
+        writer.writerow(['time'] + [f'value_{i}' for i in range(header['nb_values'])])
+    else:
+        writer.writerow(['time', 'value'])
+    for date, row in zip(dates, values):
+        writer.writerow([date] + list(row))
+
+
+if __name__ == '__main__':
+    main()